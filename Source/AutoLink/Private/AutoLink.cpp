@@ -1,5 +1,6 @@
 #include "AutoLink.h"
 
+#include "AutoLinkAllocationCounter.h"
 #include "AutoLinkLogMacros.h"
 
 // The mod template does this but we have no text to localize
@@ -8,6 +9,7 @@
 void FAutoLinkModule::StartupModule()
 {
     AL_LOG("StartupModule Called");
+    AutoLinkAllocationCounter::InstallIfRequested();
 }
 
 #undef LOCTEXT_NAMESPACE
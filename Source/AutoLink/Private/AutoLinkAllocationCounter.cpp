@@ -0,0 +1,105 @@
+#include "AutoLinkAllocationCounter.h"
+
+#include "AutoLinkLogCategory.h"
+
+#include "HAL/MemoryBase.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+static thread_local uint64 NumThreadAllocations = 0;
+static thread_local int32 UncountedDepth = 0;
+
+static void CountAllocation()
+{
+    if (UncountedDepth == 0)
+    {
+        ++NumThreadAllocations;
+    }
+}
+
+// Forwards everything to the allocator it wraps. Only the calls that allocate are counted.
+class AutoLinkCountingMalloc final : public FMalloc
+{
+public:
+    explicit AutoLinkCountingMalloc(FMalloc* inner)
+        : Inner(inner)
+    {
+    }
+
+    virtual void* Malloc(SIZE_T count, uint32 alignment) override
+    {
+        CountAllocation();
+        return Inner->Malloc(count, alignment);
+    }
+
+    virtual void* TryMalloc(SIZE_T count, uint32 alignment) override
+    {
+        CountAllocation();
+        return Inner->TryMalloc(count, alignment);
+    }
+
+    virtual void* Realloc(void* original, SIZE_T count, uint32 alignment) override
+    {
+        if (count > 0)
+        {
+            CountAllocation();
+        }
+
+        return Inner->Realloc(original, count, alignment);
+    }
+
+    virtual void* TryRealloc(void* original, SIZE_T count, uint32 alignment) override
+    {
+        if (count > 0)
+        {
+            CountAllocation();
+        }
+
+        return Inner->TryRealloc(original, count, alignment);
+    }
+
+    virtual void Free(void* original) override { Inner->Free(original); }
+    virtual SIZE_T QuantizeSize(SIZE_T count, uint32 alignment) override { return Inner->QuantizeSize(count, alignment); }
+    virtual bool GetAllocationSize(void* original, SIZE_T& sizeOut) override { return Inner->GetAllocationSize(original, sizeOut); }
+    virtual void Trim(bool trimThreadCaches) override { Inner->Trim(trimThreadCaches); }
+    virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+    virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+    virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+    virtual void UpdateStats() override { Inner->UpdateStats(); }
+    virtual void GetAllocatorStats(FGenericMemoryStats& outStats) override { Inner->GetAllocatorStats(outStats); }
+    virtual void DumpAllocatorStats(FOutputDevice& ar) override { Inner->DumpAllocatorStats(ar); }
+    virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+    virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+    virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+private:
+    FMalloc* Inner;
+};
+
+void AutoLinkAllocationCounter::InstallIfRequested()
+{
+    if (bIsInstalled || !FParse::Param(FCommandLine::Get(), TEXT("AutoLinkCountAllocations")))
+    {
+        return;
+    }
+
+    // Allocations made before this go back through the proxy to the allocator that made them
+    GMalloc = new AutoLinkCountingMalloc(GMalloc);
+    bIsInstalled = true;
+    UE_LOG(LogAutoLink, Display, TEXT("AutoLinkAllocationCounter: Counting allocations through %s"), GMalloc->GetDescriptiveName());
+}
+
+uint64 AutoLinkAllocationCounter::GetNumAllocations()
+{
+    return NumThreadAllocations;
+}
+
+AutoLinkUncountedAllocationsScope::AutoLinkUncountedAllocationsScope()
+{
+    ++UncountedDepth;
+}
+
+AutoLinkUncountedAllocationsScope::~AutoLinkUncountedAllocationsScope()
+{
+    --UncountedDepth;
+}
@@ -0,0 +1,268 @@
+#include "AutoLinkBlueprintManifest.h"
+
+#include "AutoLinkClassDispatch.h"
+#include "AutoLinkConsoleVariables.h"
+#include "AutoLinkCoreBridge.h"
+#include "AutoLinkLogCategory.h"
+#include "AutoLinkLogMacros.h"
+#include "AutoLinkScratch.h"
+
+#include "Dom/JsonObject.h"
+#include "FGBuildable.h"
+#include "FGBuildableConveyorBase.h"
+#include "FGBuildablePipeBase.h"
+#include "FGBuildableRailroadTrack.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+// Past this many blueprints the cache starts over, so a session of one-off pastes can't grow it without bound
+static constexpr int32 MaxCachedManifests = 256;
+
+TSharedRef<const AutoLinkBlueprintManifest> AutoLinkBlueprintManifest::Get(const TArray<AActor*>& children)
+{
+    const auto frame = GetFrame(children);
+    const int32 cacheMode = CVarAutoLinkBlueprintManifestCache.GetValueOnGameThread();
+    if (cacheMode <= 0)
+    {
+        return Build(children, frame, 0);
+    }
+
+    const auto signature = MakeSignature(children, frame);
+    if (auto manifest = Manifests.Find(signature))
+    {
+        AL_LOG("AutoLinkBlueprintManifest::Get: Reusing manifest %016llx with %d entries", signature, (*manifest)->Entries.Num());
+        return *manifest;
+    }
+
+    TSharedPtr<AutoLinkBlueprintManifest> manifest;
+    if (cacheMode >= 2)
+    {
+        manifest = Load(GetFilePath(signature), signature, children.Num());
+    }
+
+    if (!manifest.IsValid())
+    {
+        manifest = Build(children, frame, signature);
+        if (cacheMode >= 2 && !manifest->Save(GetFilePath(signature)))
+        {
+            UE_LOG(LogAutoLink, Warning, TEXT("AutoLinkBlueprintManifest: Could not write %s"), *GetFilePath(signature));
+        }
+    }
+
+    if (Manifests.Num() >= MaxCachedManifests)
+    {
+        Manifests.Reset();
+    }
+
+    return Manifests.Add(signature, manifest.ToSharedRef());
+}
+
+FTransform AutoLinkBlueprintManifest::GetFrame(const TArray<AActor*>& children)
+{
+    for (auto child : children)
+    {
+        if (IsValid(child))
+        {
+            return child->GetActorTransform();
+        }
+    }
+
+    return FTransform::Identity;
+}
+
+TSharedRef<AutoLinkBlueprintManifest> AutoLinkBlueprintManifest::Build(const TArray<AActor*>& children, const FTransform& frame, uint64 signature)
+{
+    auto manifest = MakeShared<AutoLinkBlueprintManifest>();
+    manifest->Signature = signature;
+    manifest->ChildrenWithConnectors.Init(false, children.Num());
+    for (int32 i = 0; i < children.Num(); ++i)
+    {
+        auto buildable = Cast<AFGBuildable>(children[i]);
+        if (!IsValid(buildable) || !AutoLinkClassDispatch::GetConnectorKinds(buildable))
+        {
+            continue;
+        }
+
+        AutoLinkScratchArray<UActorComponent*> components;
+        buildable->GetComponents(components);
+        for (auto component : components)
+        {
+            AutoLinkCore::Connector connector;
+            if (AutoLinkCoreBridge::TryMakeConnector(component, connector) && connector.IsOpen())
+            {
+                manifest->Entries.Add({ i, connector.Kind, frame.InverseTransformPosition(AutoLinkCoreBridge::ToUnreal(connector.Location)) });
+                manifest->ChildrenWithConnectors[i] = true;
+            }
+        }
+    }
+
+    AL_LOG("AutoLinkBlueprintManifest::Build: Built manifest %016llx with %d entries for %d children", signature, manifest->Entries.Num(), children.Num());
+    return manifest;
+}
+
+static void AddRounded(AutoLinkScratchArray<int64>& values, const FVector& vector)
+{
+    values.Add(FMath::RoundToInt64(vector.X));
+    values.Add(FMath::RoundToInt64(vector.Y));
+    values.Add(FMath::RoundToInt64(vector.Z));
+}
+
+// Belts, lifts, pipes, hypertubes and tracks are placed at their start, so two blueprints can only be told apart by where
+// one of them ends
+static bool TryGetFarEnd(AActor* child, FVector& outLocation)
+{
+    USceneComponent* farEnd = nullptr;
+    if (auto conveyor = Cast<AFGBuildableConveyorBase>(child))
+    {
+        farEnd = conveyor->GetConnection1();
+    }
+    else if (auto pipe = Cast<AFGBuildablePipeBase>(child))
+    {
+        farEnd = pipe->GetConnection1();
+    }
+    else if (auto track = Cast<AFGBuildableRailroadTrack>(child))
+    {
+        farEnd = track->GetConnection(1);
+    }
+
+    if (!farEnd)
+    {
+        return false;
+    }
+
+    outLocation = farEnd->GetComponentLocation();
+    return true;
+}
+
+uint64 AutoLinkBlueprintManifest::MakeSignature(const TArray<AActor*>& children, const FTransform& frame)
+{
+    AutoLinkScratchArray<int64> values;
+    values.Reserve(children.Num() * 12);
+    for (auto child : children)
+    {
+        if (!IsValid(child))
+        {
+            values.Add(0);
+            continue;
+        }
+
+        values.Add((int64)GetClassHash(child->GetClass()));
+        AddRounded(values, frame.InverseTransformPosition(child->GetActorLocation()));
+
+        // Axes rather than angles, which can wrap around to a different but equal value
+        const auto rotation = frame.InverseTransformRotation(child->GetActorQuat());
+        AddRounded(values, rotation.GetForwardVector() * 100);
+        AddRounded(values, rotation.GetUpVector() * 100);
+
+        FVector farEnd;
+        if (TryGetFarEnd(child, farEnd))
+        {
+            AddRounded(values, frame.InverseTransformPosition(farEnd));
+        }
+    }
+
+    return CityHash64(reinterpret_cast<const char*>(values.GetData()), values.Num() * sizeof(int64));
+}
+
+uint64 AutoLinkBlueprintManifest::GetClassHash(const UClass* buildableClass)
+{
+    if (auto hash = ClassHashes.Find(buildableClass))
+    {
+        return *hash;
+    }
+
+    // The path rather than the FName, whose hash isn't the same from one session to the next
+    const FTCHARToUTF8 pathName(*buildableClass->GetPathName());
+    return ClassHashes.Add(buildableClass, CityHash64(pathName.Get(), pathName.Length()));
+}
+
+FString AutoLinkBlueprintManifest::GetFilePath(uint64 signature)
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("AutoLink"), TEXT("BlueprintManifests"), FString::Printf(TEXT("%016llx.json"), signature));
+}
+
+bool AutoLinkBlueprintManifest::Save(const FString& filePath) const
+{
+    TArray<TSharedPtr<FJsonValue>> entryValues;
+    for (auto& entry : Entries)
+    {
+        auto entryObject = MakeShared<FJsonObject>();
+        entryObject->SetNumberField(TEXT("Child"), entry.ChildIndex);
+        entryObject->SetNumberField(TEXT("Kind"), (int32)entry.Kind);
+        entryObject->SetNumberField(TEXT("X"), entry.LocalLocation.X);
+        entryObject->SetNumberField(TEXT("Y"), entry.LocalLocation.Y);
+        entryObject->SetNumberField(TEXT("Z"), entry.LocalLocation.Z);
+        entryValues.Add(MakeShared<FJsonValueObject>(entryObject));
+    }
+
+    auto rootObject = MakeShared<FJsonObject>();
+    rootObject->SetNumberField(TEXT("Children"), ChildrenWithConnectors.Num());
+    rootObject->SetArrayField(TEXT("Entries"), entryValues);
+
+    FString json;
+    auto writer = TJsonWriterFactory<>::Create(&json);
+    if (!FJsonSerializer::Serialize(rootObject, writer))
+    {
+        return false;
+    }
+
+    FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(filePath));
+    return FFileHelper::SaveStringToFile(json, *filePath);
+}
+
+TSharedPtr<AutoLinkBlueprintManifest> AutoLinkBlueprintManifest::Load(const FString& filePath, uint64 signature, int32 numChildren)
+{
+    FString json;
+    if (!FFileHelper::LoadFileToString(json, *filePath))
+    {
+        return nullptr;
+    }
+
+    TSharedPtr<FJsonObject> rootObject;
+    const TArray<TSharedPtr<FJsonValue>>* entryValues;
+    int32 numSavedChildren = 0;
+    if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(json), rootObject)
+        || !rootObject.IsValid()
+        || !rootObject->TryGetNumberField(TEXT("Children"), numSavedChildren)
+        || numSavedChildren != numChildren
+        || !rootObject->TryGetArrayField(TEXT("Entries"), entryValues))
+    {
+        UE_LOG(LogAutoLink, Warning, TEXT("AutoLinkBlueprintManifest: Ignoring unreadable %s"), *filePath);
+        return nullptr;
+    }
+
+    auto manifest = MakeShared<AutoLinkBlueprintManifest>();
+    manifest->Signature = signature;
+    manifest->ChildrenWithConnectors.Init(false, numChildren);
+    for (auto& entryValue : *entryValues)
+    {
+        const TSharedPtr<FJsonObject>* entryObject;
+        Entry entry;
+        int32 kind = 0;
+        if (!entryValue->TryGetObject(entryObject)
+            || !(*entryObject)->TryGetNumberField(TEXT("Child"), entry.ChildIndex)
+            || !(*entryObject)->TryGetNumberField(TEXT("Kind"), kind)
+            || !(*entryObject)->TryGetNumberField(TEXT("X"), entry.LocalLocation.X)
+            || !(*entryObject)->TryGetNumberField(TEXT("Y"), entry.LocalLocation.Y)
+            || !(*entryObject)->TryGetNumberField(TEXT("Z"), entry.LocalLocation.Z)
+            || !manifest->ChildrenWithConnectors.IsValidIndex(entry.ChildIndex)
+            || kind < 0
+            || kind >= (int32)AutoLinkCore::ConnectorKind::Num)
+        {
+            UE_LOG(LogAutoLink, Warning, TEXT("AutoLinkBlueprintManifest: Ignoring unreadable %s"), *filePath);
+            return nullptr;
+        }
+
+        entry.Kind = (AutoLinkCore::ConnectorKind)kind;
+        manifest->Entries.Add(entry);
+        manifest->ChildrenWithConnectors[entry.ChildIndex] = true;
+    }
+
+    AL_LOG("AutoLinkBlueprintManifest::Load: Loaded manifest %016llx with %d entries from %s", signature, manifest->Entries.Num(), *filePath);
+    return manifest;
+}
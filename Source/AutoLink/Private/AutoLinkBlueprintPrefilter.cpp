@@ -0,0 +1,89 @@
+#include "AutoLinkBlueprintPrefilter.h"
+
+#include "AutoLinkBlueprintManifest.h"
+#include "AutoLinkConnectorIndex.h"
+#include "AutoLinkConsoleVariables.h"
+#include "AutoLinkCoreBridge.h"
+#include "AutoLinkLogMacros.h"
+
+AutoLinkBlueprintPrefilterScope::AutoLinkBlueprintPrefilterScope(const TArray<AActor*>& children, const AutoLinkBlueprintManifest& manifest)
+{
+    check(!Active);
+    Active = this;
+
+    UWorld* world = nullptr;
+    for (auto child : children)
+    {
+        if (IsValid(child))
+        {
+            world = child->GetWorld();
+            Children.Add(child);
+        }
+    }
+
+    if (!world)
+    {
+        return;
+    }
+
+    // A full connector can't take a link, so the open ones in the manifest are all that matter
+    const auto frame = AutoLinkBlueprintManifest::GetFrame(children);
+    FBox bounds(ForceInit);
+    for (auto& entry : manifest.Entries)
+    {
+        const auto location = frame.TransformPosition(entry.LocalLocation);
+        bounds += location;
+        ChildCells.FindOrAdd(AutoLinkConnectorIndex::GetCell(AutoLinkCoreBridge::ToCore(location))).AddUnique(children[entry.ChildIndex]);
+    }
+
+    if (!bounds.IsValid)
+    {
+        AL_LOG("AutoLinkBlueprintPrefilterScope: None of the %d children have open connectors", children.Num());
+        bIsInternalOnly = CVarAutoLinkBlueprintPrefilter.GetValueOnGameThread();
+        return;
+    }
+
+    // The children near each connector are kept either way, for the speculative plan
+    if (!CVarAutoLinkBlueprintPrefilter.GetValueOnGameThread())
+    {
+        return;
+    }
+
+    AutoLinkConnectorIndex::EnsureBuilt(world);
+    bIsInternalOnly = !AutoLinkConnectorIndex::HasOpenConnectorInBox(bounds.ExpandBy(AutoLinkCore::Tolerances::MaxBeltSearchDistance), Children);
+    AL_LOG("AutoLinkBlueprintPrefilterScope: Blueprint connectors are within %s. Internal only: %d", *bounds.ToString(), bIsInternalOnly);
+}
+
+AutoLinkBlueprintPrefilterScope::~AutoLinkBlueprintPrefilterScope()
+{
+    Active = nullptr;
+}
+
+void AutoLinkBlueprintPrefilterScope::FindNearbyChildren(const FVector& location, AActor* ignoreActor, AutoLinkScratchArray<AActor*>& outActors)
+{
+    check(Active);
+
+    const auto center = AutoLinkConnectorIndex::GetCell(AutoLinkCoreBridge::ToCore(location));
+    for (int32 x = -1; x <= 1; ++x)
+    {
+        for (int32 y = -1; y <= 1; ++y)
+        {
+            for (int32 z = -1; z <= 1; ++z)
+            {
+                auto cell = Active->ChildCells.Find(center + FIntVector(x, y, z));
+                if (!cell)
+                {
+                    continue;
+                }
+
+                for (auto child : *cell)
+                {
+                    if (child != ignoreActor)
+                    {
+                        outActors.AddUnique(child);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#include "AutoLinkClassDispatch.h"
+
+#include "AutoLinkCoreBridge.h"
+#include "AutoLinkLogMacros.h"
+#include "AutoLinkRootInstanceModule.h"
+
+#include "FGConveyorAttachmentHologram.h"
+#include "FGPipeHyperAttachmentHologram.h"
+#include "FGPipelineAttachmentHologram.h"
+
+bool AutoLinkClassDispatch::IsForBaseHook(const UClass* hologramClass)
+{
+    if (auto isForBaseHook = BaseHookClasses.Find(hologramClass))
+    {
+        return *isForBaseHook;
+    }
+
+    // These have their ConfigureComponents hooked on their own
+    const bool isForBaseHook = !hologramClass->IsChildOf<AFGConveyorAttachmentHologram>()
+        && !hologramClass->IsChildOf<AFGPipeHyperAttachmentHologram>()
+        && !hologramClass->IsChildOf<AFGPipelineAttachmentHologram>();
+
+    AL_LOG("AutoLinkClassDispatch::IsForBaseHook: %s: %d", *hologramClass->GetName(), isForBaseHook);
+    return BaseHookClasses.Add(hologramClass, isForBaseHook);
+}
+
+uint8 AutoLinkClassDispatch::GetConnectorKinds(AFGBuildable* buildable)
+{
+    const auto buildableClass = buildable->GetClass();
+    if (auto connectorKinds = ConnectorKinds.Find(buildableClass))
+    {
+        return *connectorKinds;
+    }
+
+    uint8 connectorKinds = 0;
+    if (UAutoLinkRootInstanceModule::ShouldTryToAutoLink(buildable))
+    {
+        TInlineComponentArray<UActorComponent*> components;
+        buildable->GetComponents(components);
+        for (auto component : components)
+        {
+            AutoLinkCore::Connector connector;
+            if (AutoLinkCoreBridge::TryMakeConnector(component, connector))
+            {
+                connectorKinds |= 1 << (uint8)connector.Kind;
+            }
+        }
+    }
+
+    AL_LOG("AutoLinkClassDispatch::GetConnectorKinds: %s: %d", *buildableClass->GetName(), connectorKinds);
+    return ConnectorKinds.Add(buildableClass, connectorKinds);
+}
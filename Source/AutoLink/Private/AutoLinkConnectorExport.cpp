@@ -0,0 +1,120 @@
+#include "AutoLinkConnectorExport.h"
+
+#include "AutoLinkCore/AutoLinkSnapshot.h"
+#include "AutoLinkCoreBridge.h"
+#include "AutoLinkLogCategory.h"
+
+#include "EngineUtils.h"
+#include "FGBuildablePoleBase.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+
+uint32 AutoLinkClassTable::GetId(UClass* buildableClass)
+{
+    if (auto id = Ids.Find(buildableClass))
+    {
+        return *id;
+    }
+
+    auto id = (uint32)Names.size();
+    Names.push_back(buildableClass ? TCHAR_TO_UTF8(*buildableClass->GetPathName()) : "None");
+    Ids.Add(buildableClass, id);
+    return id;
+}
+
+void AutoLinkConnectorExport::AppendConnectors(
+    AFGBuildable* buildable,
+    std::vector<AutoLinkCore::Connector>& outConnectors,
+    AutoLinkClassTable& classTable,
+    TArray<UActorComponent*>* outComponents)
+{
+    // Poles are cosmetic and AutoLink never links them
+    if (buildable->IsA<AFGBuildablePoleBase>())
+    {
+        return;
+    }
+
+    TInlineComponentArray<UActorComponent*> components;
+    buildable->GetComponents(components);
+
+    TArray<TPair<AutoLinkCore::Connector, UActorComponent*>, TInlineAllocator<16>> connectors;
+    for (auto component : components)
+    {
+        AutoLinkCore::Connector connector;
+        if (AutoLinkCoreBridge::TryMakeConnector(component, connector))
+        {
+            connectors.Emplace(connector, component);
+        }
+    }
+
+    // Same order as FindAndLinkForBuildable links them in, which decides who wins when two connectors want the same candidate
+    connectors.StableSort([](const auto& a, const auto& b) { return a.Key.Kind < b.Key.Kind; });
+
+    const auto classId = classTable.GetId(buildable->GetClass());
+    for (auto& connectorAndComponent : connectors)
+    {
+        connectorAndComponent.Key.ClassId = classId;
+        outConnectors.push_back(connectorAndComponent.Key);
+        if (outComponents)
+        {
+            outComponents->Add(connectorAndComponent.Value);
+        }
+    }
+}
+
+int32 AutoLinkConnectorExport::ExportWorld(UWorld* world, const FString& filePath)
+{
+    std::vector<AutoLinkCore::Connector> connectors;
+    AutoLinkClassTable classTable;
+    int32 numBuildables = 0;
+    for (TActorIterator<AFGBuildable> it(world); it; ++it)
+    {
+        if (IsValid(*it))
+        {
+            AppendConnectors(*it, connectors, classTable);
+            ++numBuildables;
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+    AutoLinkCore::WriteSnapshot(connectors.data(), connectors.size(), classTable.Names, bytes);
+
+    auto& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+    platformFile.CreateDirectoryTree(*FPaths::GetPath(filePath));
+    TUniquePtr<IFileHandle> file(platformFile.OpenWrite(*filePath));
+    if (!file || !file->Write(bytes.data(), bytes.size()))
+    {
+        UE_LOG(LogAutoLink, Error, TEXT("AutoLinkConnectorExport: Could not write %s"), *filePath);
+        return INDEX_NONE;
+    }
+
+    UE_LOG(LogAutoLink, Display, TEXT("AutoLinkConnectorExport: Wrote %d connectors of %d buildables (%d classes, %.1f MB) to %s"),
+        (int32)connectors.size(),
+        numBuildables,
+        (int32)classTable.Names.size(),
+        bytes.size() / (1024.0 * 1024.0),
+        *filePath);
+
+    return (int32)connectors.size();
+}
+
+FString AutoLinkConnectorExport::GetDefaultFilePath()
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("AutoLink"), TEXT("Snapshots"), FString::Printf(TEXT("Connectors_%s.alsnap"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S"))));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ExportConnectorsCommand(
+    TEXT("AutoLink.ExportConnectors"),
+    TEXT("Writes every connector in the current world to a snapshot file for AutoLink's offline tools. ")
+    TEXT("Usage: AutoLink.ExportConnectors [FilePath]. Defaults to Saved/AutoLink/Snapshots/Connectors_<time>.alsnap."),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& args, UWorld* world)
+    {
+        if (!world)
+        {
+            UE_LOG(LogAutoLink, Error, TEXT("AutoLink.ExportConnectors needs a world"));
+            return;
+        }
+
+        AutoLinkConnectorExport::ExportWorld(world, args.Num() > 0 ? args[0] : AutoLinkConnectorExport::GetDefaultFilePath());
+    }));
@@ -0,0 +1,487 @@
+#include "AutoLinkConnectorIndex.h"
+
+#include "AutoLinkCore/AutoLinkMatcher.h"
+#include "AutoLinkCoreBridge.h"
+#include "AutoLinkLogCategory.h"
+
+#include "EngineUtils.h"
+
+void AutoLinkConnectorIndex::EnsureBuilt(UWorld* world)
+{
+    if (!world || IsBuiltFor(world))
+    {
+        return;
+    }
+
+    Reset();
+    World = world;
+    for (auto& occupancy : Occupancy)
+    {
+        occupancy.Init(false, NumOccupancyBits);
+    }
+
+    const auto startCycles = FPlatformTime::Cycles64();
+    int32 numBuildables = 0;
+    for (TActorIterator<AFGBuildable> it(world); it; ++it)
+    {
+        if (IsValid(*it))
+        {
+            AddBuildable(*it);
+            ++numBuildables;
+        }
+    }
+
+    UE_LOG(LogAutoLink, Display, TEXT("AutoLinkConnectorIndex: Indexed %d connectors of %d buildables in %d cells in %.3f ms"),
+        NumComponents,
+        numBuildables,
+        Cells.Num(),
+        FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - startCycles));
+}
+
+void AutoLinkConnectorIndex::Reset()
+{
+    World.Reset();
+    Cells.Reset();
+    for (auto& occupancy : Occupancy)
+    {
+        occupancy.Empty();
+    }
+
+    IndexedBuildables.Reset();
+    ClassTable = AutoLinkClassTable();
+    NumComponents = 0;
+    NumFreedComponents = 0;
+    ++Epoch;
+    ChangedCells.Reset();
+    Generations.Reset();
+    Snapshot.Reset();
+}
+
+void AutoLinkConnectorIndex::AddBuildable(AFGBuildable* buildable)
+{
+    if (!IsValid(buildable) || !IsBuiltFor(buildable->GetWorld()))
+    {
+        return;
+    }
+
+    bool isAlreadyIndexed = false;
+    IndexedBuildables.Add(FObjectKey(buildable), &isAlreadyIndexed);
+    if (isAlreadyIndexed)
+    {
+        return;
+    }
+
+    std::vector<AutoLinkCore::Connector> connectors;
+    TArray<UActorComponent*> components;
+    AutoLinkConnectorExport::AppendConnectors(buildable, connectors, ClassTable, &components);
+    for (int32 i = 0; i < components.Num(); ++i)
+    {
+        const auto cellCoordinates = GetCell(connectors[i].Location);
+        auto& cell = Cells.FindOrAdd(cellCoordinates);
+        cell.Components.Add(components[i]);
+        cell.bIsDirty = true;
+        Occupancy[(int32)connectors[i].Kind][GetOccupancyBit(cellCoordinates)] = true;
+
+        // The game may have connected its neighbours to it as it was built
+        MarkChangedAround(connectors[i].Location);
+    }
+
+    NumComponents += components.Num();
+    ++Epoch;
+}
+
+void AutoLinkConnectorIndex::RemoveBuildable(AFGBuildable* buildable)
+{
+    // Not IsValid, since the buildable may already be on its way out
+    if (!buildable || !IsBuiltFor(buildable->GetWorld()))
+    {
+        return;
+    }
+
+    TInlineComponentArray<UActorComponent*> components;
+    TArray<UActorComponent*> connectedComponents;
+    buildable->GetComponents(components);
+    for (auto component : components)
+    {
+        AutoLinkCore::Connector connector;
+        if (!AutoLinkCoreBridge::TryMakeConnector(component, connector))
+        {
+            continue;
+        }
+
+        MarkChangedAround(connector.Location);
+        Generations.Remove(FObjectKey(component));
+        ForgetFreed(component, connector.Location);
+
+        // Still linked at this point, though not for long
+        connectedComponents.Reset();
+        AutoLinkCoreBridge::AppendConnectedComponents(component, connectedComponents);
+        for (auto connectedComponent : connectedComponents)
+        {
+            AutoLinkCore::Connector connectedConnector;
+            if (connectedComponent->GetOwner() == buildable || !AutoLinkCoreBridge::TryMakeConnector(connectedComponent, connectedConnector))
+            {
+                continue;
+            }
+
+            auto cell = Cells.Find(GetCell(connectedConnector.Location));
+            if (cell && !cell->FreedComponents.Contains(connectedComponent))
+            {
+                cell->FreedComponents.Add(connectedComponent);
+                ++NumFreedComponents;
+            }
+        }
+    }
+
+    ++Epoch;
+}
+
+bool AutoLinkConnectorIndex::FindFreedNear(const UActorComponent* connectionComponent, const FVector& location, AActor* ignoreActor, AutoLinkScratchArray<AActor*>& outActors)
+{
+    AutoLinkCore::Connector scanningConnector;
+    if (NumFreedComponents == 0 || !World.IsValid() || !AutoLinkCoreBridge::TryMakeConnector(connectionComponent, scanningConnector))
+    {
+        return false;
+    }
+
+    bool bIsTouching = false;
+    const auto center = GetCell(AutoLinkCoreBridge::ToCore(location));
+    for (int32 x = -1; x <= 1; ++x)
+    {
+        for (int32 y = -1; y <= 1; ++y)
+        {
+            for (int32 z = -1; z <= 1; ++z)
+            {
+                auto cell = Cells.Find(center + FIntVector(x, y, z));
+                if (!cell)
+                {
+                    continue;
+                }
+
+                for (int32 i = cell->FreedComponents.Num() - 1; i >= 0; --i)
+                {
+                    auto component = cell->FreedComponents[i].Get();
+                    AutoLinkCore::Connector connector;
+                    if (!component || !AutoLinkCoreBridge::TryMakeConnector(component, connector) || !connector.IsOpen())
+                    {
+                        cell->FreedComponents.RemoveAtSwap(i, 1, false);
+                        --NumFreedComponents;
+                        continue;
+                    }
+
+                    auto owner = component->GetOwner();
+                    if (owner == ignoreActor
+                        || connector.Kind != scanningConnector.Kind
+                        || (connector.Kind == AutoLinkCore::ConnectorKind::Belt
+                            && !AutoLinkCore::AreBeltDirectionsCompatible(scanningConnector.Direction, connector.Direction)))
+                    {
+                        continue;
+                    }
+
+                    outActors.AddUnique(owner);
+                    bIsTouching |= connector.MaxConnections == 1
+                        && FVector::DistSquared(AutoLinkCoreBridge::ToUnreal(connector.Location), location) <= 1;
+                }
+            }
+        }
+    }
+
+    return bIsTouching;
+}
+
+void AutoLinkConnectorIndex::NoteLinked(const UActorComponent* connection, const UActorComponent* candidate)
+{
+    if (!World.IsValid())
+    {
+        return;
+    }
+
+    for (auto component : { connection, candidate })
+    {
+        if (auto sceneComponent = Cast<USceneComponent>(component))
+        {
+            const auto location = AutoLinkCoreBridge::ToCore(sceneComponent->GetComponentLocation());
+            ++Generations.FindOrAdd(FObjectKey(component));
+            MarkChangedAround(location);
+            ForgetFreed(component, location);
+        }
+    }
+
+    ++Epoch;
+}
+
+AutoLinkWorldSnapshot::Ptr AutoLinkConnectorIndex::GetSnapshot()
+{
+    if (!World.IsValid())
+    {
+        return nullptr;
+    }
+
+    if (Snapshot.IsValid() && Snapshot->Epoch == Epoch)
+    {
+        return Snapshot;
+    }
+
+    // Starts with the last one's chunks, which only copies pointers, and replaces each chunk with a changed cell by a copy
+    // with that cell redone. The copy shares its unchanged cells with the old chunk.
+    auto snapshot = MakeShared<AutoLinkWorldSnapshot, ESPMode::ThreadSafe>();
+    snapshot->Epoch = Epoch;
+    if (Snapshot.IsValid())
+    {
+        snapshot->Chunks = Snapshot->Chunks;
+        snapshot->NumConnectors = Snapshot->NumConnectors;
+    }
+    else
+    {
+        const TSharedRef<const AutoLinkSnapshotChunk, ESPMode::ThreadSafe> emptyChunk = MakeShared<AutoLinkSnapshotChunk, ESPMode::ThreadSafe>();
+        snapshot->Chunks.Init(emptyChunk, AutoLinkWorldSnapshot::NumChunks);
+    }
+
+    TMap<int32, TSharedRef<AutoLinkSnapshotChunk, ESPMode::ThreadSafe>> changedChunks;
+    for (const auto& cellCoordinates : ChangedCells)
+    {
+        const auto chunkIndex = AutoLinkWorldSnapshot::GetChunkIndex(cellCoordinates);
+        auto changedChunk = changedChunks.Find(chunkIndex);
+        if (!changedChunk)
+        {
+            changedChunk = &changedChunks.Add(chunkIndex, MakeShared<AutoLinkSnapshotChunk, ESPMode::ThreadSafe>(*snapshot->Chunks[chunkIndex]));
+        }
+
+        auto& chunkCells = (*changedChunk)->Cells;
+        if (auto oldCell = chunkCells.Find(cellCoordinates))
+        {
+            snapshot->NumConnectors -= (int32)(*oldCell)->Connectors.size();
+            chunkCells.Remove(cellCoordinates);
+        }
+
+        auto cell = Cells.Find(cellCoordinates);
+        if (!cell)
+        {
+            continue;
+        }
+
+        auto snapshotCell = MakeShared<AutoLinkSnapshotCell, ESPMode::ThreadSafe>();
+        for (auto& weakComponent : cell->Components)
+        {
+            auto component = weakComponent.Get();
+            AutoLinkCore::Connector connector;
+            if (component && AutoLinkCoreBridge::TryMakeConnector(component, connector))
+            {
+                snapshotCell->Connectors.push_back(connector);
+                snapshotCell->Components.Add(component);
+                snapshotCell->Generations.Add(GetGeneration(component));
+            }
+        }
+
+        if (!snapshotCell->Connectors.empty())
+        {
+            snapshot->NumConnectors += (int32)snapshotCell->Connectors.size();
+            chunkCells.Add(cellCoordinates, snapshotCell);
+        }
+    }
+
+    for (auto& changedChunk : changedChunks)
+    {
+        snapshot->Chunks[changedChunk.Key] = changedChunk.Value;
+    }
+
+    ChangedCells.Reset();
+    Snapshot = snapshot;
+    return Snapshot;
+}
+
+uint32 AutoLinkConnectorIndex::GetGeneration(const UActorComponent* component)
+{
+    auto generation = Generations.Find(FObjectKey(component));
+    return generation ? *generation : 0;
+}
+
+void AutoLinkConnectorIndex::ForgetFreed(const UActorComponent* component, const AutoLinkCore::Vector& location)
+{
+    if (NumFreedComponents == 0)
+    {
+        return;
+    }
+
+    auto cell = Cells.Find(GetCell(location));
+    if (cell && cell->FreedComponents.RemoveSwap(component, false) > 0)
+    {
+        --NumFreedComponents;
+    }
+}
+
+void AutoLinkConnectorIndex::MarkChangedAround(const AutoLinkCore::Vector& location)
+{
+    const auto center = GetCell(location);
+    for (int32 x = -1; x <= 1; ++x)
+    {
+        for (int32 y = -1; y <= 1; ++y)
+        {
+            for (int32 z = -1; z <= 1; ++z)
+            {
+                const auto cellCoordinates = center + FIntVector(x, y, z);
+                if (auto cell = Cells.Find(cellCoordinates))
+                {
+                    cell->bIsDirty = true;
+                    ChangedCells.Add(cellCoordinates);
+                }
+            }
+        }
+    }
+}
+
+bool AutoLinkConnectorIndex::MayHaveOpenConnectorNear(const AutoLinkCore::Vector& location, AutoLinkCore::ConnectorKind kind, const AActor* ignoredOwner)
+{
+    if (!World.IsValid())
+    {
+        return true;
+    }
+
+    const auto& occupancy = Occupancy[(int32)kind];
+    const uint8 kindBit = 1 << (uint8)kind;
+    const auto center = GetCell(location);
+    for (int32 x = -1; x <= 1; ++x)
+    {
+        for (int32 y = -1; y <= 1; ++y)
+        {
+            for (int32 z = -1; z <= 1; ++z)
+            {
+                const auto cellCoordinates = center + FIntVector(x, y, z);
+                if (!occupancy[GetOccupancyBit(cellCoordinates)])
+                {
+                    continue;
+                }
+
+                auto cell = Cells.Find(cellCoordinates);
+                if (!cell)
+                {
+                    continue;
+                }
+
+                if (cell->bIsDirty)
+                {
+                    RefreshCell(*cell);
+                }
+
+                if ((cell->OpenKinds & kindBit) && HasOpenConnector(*cell, kind, ignoredOwner))
+                {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+void AutoLinkConnectorIndex::RefreshCell(AutoLinkIndexCell& cell)
+{
+    cell.OpenKinds = 0;
+    for (int32 i = cell.Components.Num() - 1; i >= 0; --i)
+    {
+        auto component = cell.Components[i].Get();
+        if (!component)
+        {
+            cell.Components.RemoveAtSwap(i, 1, false);
+            --NumComponents;
+            continue;
+        }
+
+        AutoLinkCore::Connector connector;
+        if (AutoLinkCoreBridge::TryMakeConnector(component, connector) && connector.IsOpen())
+        {
+            cell.OpenKinds |= 1 << (uint8)connector.Kind;
+        }
+    }
+
+    // Freed connectors the game linked again, or that are gone, don't need to wait for a lookup to find out
+    for (int32 i = cell.FreedComponents.Num() - 1; i >= 0; --i)
+    {
+        auto component = cell.FreedComponents[i].Get();
+        AutoLinkCore::Connector connector;
+        if (!component || !AutoLinkCoreBridge::TryMakeConnector(component, connector) || !connector.IsOpen())
+        {
+            cell.FreedComponents.RemoveAtSwap(i, 1, false);
+            --NumFreedComponents;
+        }
+    }
+
+    cell.bIsDirty = false;
+}
+
+bool AutoLinkConnectorIndex::HasOpenConnectorInBox(const FBox& box, const AutoLinkScratchSet<const AActor*>& ignoredOwners)
+{
+    const auto minCell = GetCell(AutoLinkCoreBridge::ToCore(box.Min));
+    const auto maxCell = GetCell(AutoLinkCoreBridge::ToCore(box.Max));
+    for (int32 x = minCell.X; x <= maxCell.X; ++x)
+    {
+        for (int32 y = minCell.Y; y <= maxCell.Y; ++y)
+        {
+            for (int32 z = minCell.Z; z <= maxCell.Z; ++z)
+            {
+                auto cell = Cells.Find(FIntVector(x, y, z));
+                if (!cell)
+                {
+                    continue;
+                }
+
+                for (auto& weakComponent : cell->Components)
+                {
+                    auto component = weakComponent.Get();
+                    if (!component || ignoredOwners.Contains(component->GetOwner()))
+                    {
+                        continue;
+                    }
+
+                    AutoLinkCore::Connector connector;
+                    if (AutoLinkCoreBridge::TryMakeConnector(component, connector)
+                        && connector.IsOpen()
+                        && box.IsInsideOrOn(AutoLinkCoreBridge::ToUnreal(connector.Location)))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+bool AutoLinkConnectorIndex::HasOpenConnector(const AutoLinkIndexCell& cell, AutoLinkCore::ConnectorKind kind, const AActor* ignoredOwner)
+{
+    if (!ignoredOwner)
+    {
+        return true;
+    }
+
+    for (auto& weakComponent : cell.Components)
+    {
+        auto component = weakComponent.Get();
+        if (!component || component->GetOwner() == ignoredOwner)
+        {
+            continue;
+        }
+
+        AutoLinkCore::Connector connector;
+        if (AutoLinkCoreBridge::TryMakeConnector(component, connector) && connector.Kind == kind && connector.IsOpen())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int32 AutoLinkConnectorIndex::GetOccupancyBit(const FIntVector& cell)
+{
+    return (int32)(GetTypeHash(cell) & (NumOccupancyBits - 1));
+}
+
+FIntVector AutoLinkConnectorIndex::GetCell(const AutoLinkCore::Vector& location)
+{
+    return FIntVector(
+        FMath::FloorToInt32(location.X / AutoLinkCore::MatchCellSize),
+        FMath::FloorToInt32(location.Y / AutoLinkCore::MatchCellSize),
+        FMath::FloorToInt32(location.Z / AutoLinkCore::MatchCellSize));
+}
@@ -0,0 +1,86 @@
+#include "AutoLinkConnectorTable.h"
+
+#include "AutoLinkCoreBridge.h"
+
+AutoLinkConnectorTable::AutoLinkConnectorTable()
+{
+    check(!Active);
+    Active = this;
+}
+
+AutoLinkConnectorTable::~AutoLinkConnectorTable()
+{
+    Active = nullptr;
+}
+
+int32 AutoLinkConnectorTable::Capture(UFGFactoryConnectionComponent* connection)
+{
+    if (auto row = Rows.Find(connection))
+    {
+        return *row;
+    }
+
+    return AddRow(connection, AutoLinkCoreBridge::MakeConnector(connection));
+}
+
+int32 AutoLinkConnectorTable::Capture(UFGPipeConnectionComponentBase* connection, AutoLinkCore::ConnectorKind kind)
+{
+    if (auto row = Rows.Find(connection))
+    {
+        return *row;
+    }
+
+    return AddRow(connection, AutoLinkCoreBridge::MakeConnector(connection, kind));
+}
+
+int32 AutoLinkConnectorTable::Capture(UFGRailroadTrackConnectionComponent* connection)
+{
+    if (auto row = Rows.Find(connection))
+    {
+        return *row;
+    }
+
+    return AddRow(connection, AutoLinkCoreBridge::MakeConnector(connection, AutoLinkCoreBridge::GetMaxRailConnections(connection->GetOwner())));
+}
+
+AutoLinkCore::Connector AutoLinkConnectorTable::GetConnector(int32 row) const
+{
+    AutoLinkCore::Connector connector{};
+    connector.Location = Locations[row];
+    connector.Normal = Normals[row];
+    connector.OwnerId = OwnerIds[row];
+    connector.Kind = Kinds[row];
+    connector.Direction = Directions[row];
+    connector.OwnerFlags = OwnerFlags[row];
+    connector.NumConnections = NumConnections[row];
+    connector.MaxConnections = MaxConnections[row];
+    return connector;
+}
+
+void AutoLinkConnectorTable::NoteLinked(int32 row, int32 otherRow)
+{
+    ++NumConnections[row];
+    ++NumConnections[otherRow];
+
+    if (Kinds[row] == AutoLinkCore::ConnectorKind::Railroad
+        && (HasOwnerFlags(row, AutoLinkCore::OwnerFlags::RailroadAttachment) || HasOwnerFlags(otherRow, AutoLinkCore::OwnerFlags::RailroadAttachment)))
+    {
+        MaxConnections[row] = NumConnections[row];
+        MaxConnections[otherRow] = NumConnections[otherRow];
+    }
+}
+
+int32 AutoLinkConnectorTable::AddRow(UActorComponent* component, const AutoLinkCore::Connector& connector)
+{
+    const int32 row = Components.Add(component);
+    Locations.Add(connector.Location);
+    Normals.Add(connector.Normal);
+    Kinds.Add(connector.Kind);
+    Directions.Add(connector.Direction);
+    OwnerFlags.Add(connector.OwnerFlags);
+    OwnerIds.Add(connector.OwnerId);
+    NumConnections.Add(connector.NumConnections);
+    MaxConnections.Add(connector.MaxConnections);
+    Rows.Add(component, row);
+    return row;
+}
@@ -0,0 +1,67 @@
+#include "AutoLinkConsoleVariables.h"
+
+TAutoConsoleVariable<float> CVarAutoLinkHitchThresholdMs(
+    TEXT("AutoLink.HitchThresholdMs"),
+    50.0f,
+    TEXT("Link passes (a single buildable or a whole blueprint) that take longer than this many milliseconds write a detailed record to Saved/AutoLink/Hitches. 0 or less disables hitch capture."),
+    ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarAutoLinkShadowMode(
+    TEXT("AutoLink.ShadowMode"),
+    false,
+    TEXT("Also works out what the index-based link engine would link for every placement, without committing it, and logs any difference from what was actually linked and the speedup."),
+    ECVF_Default);
+
+TAutoConsoleVariable<float> CVarAutoLinkBaselineMaxSlowdownPercent(
+    TEXT("AutoLink.BaselineMaxSlowdownPercent"),
+    10.0f,
+    TEXT("With checkbaseline, AutoLink.RunScenarios, AutoLink.RunStress and AutoLink.Bench fail any scenario whose link or track rebuild time is more than this many percent slower than its baseline."),
+    ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarAutoLinkBlueprintPrefilter(
+    TEXT("AutoLink.BlueprintPrefilter"),
+    true,
+    TEXT("When no open connector outside a blueprint is within reach of it, the blueprint's children link to each other without scene queries. 0 always uses scene queries."),
+    ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarAutoLinkOccupancyFilter(
+    TEXT("AutoLink.OccupancyFilter"),
+    true,
+    TEXT("Indexes every connector as the world loads and skips the scene queries for connectors with no open connector of their kind nearby. 0 scans for every connector."),
+    ECVF_Default);
+
+TAutoConsoleVariable<int32> CVarAutoLinkBlueprintManifestCache(
+    TEXT("AutoLink.BlueprintManifestCache"),
+    1,
+    TEXT("Where the list of each blueprint's open connectors is kept between pastes. 0 rebuilds it for every paste, 1 keeps it for the session and 2 also keeps it in Saved/AutoLink/BlueprintManifests."),
+    ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarAutoLinkBatchPlacements(
+    TEXT("AutoLink.BatchPlacements"),
+    true,
+    TEXT("Links everything placed in a frame in one pass at the end of the frame. 0 links every placement as it happens."),
+    ECVF_Default);
+
+TAutoConsoleVariable<float> CVarAutoLinkSpeculativePlanDelayMs(
+    TEXT("AutoLink.SpeculativePlanDelayMs"),
+    150.0f,
+    TEXT("Once a blueprint hologram that was pasted before has held still this long, the scene queries for pasting it there are sent ahead in the background. Less than 0 never sends them ahead."),
+    ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarAutoLinkAttachmentLinks(
+    TEXT("AutoLink.AttachmentLinks"),
+    false,
+    TEXT("1 links attachments and buildings whose belt connectors touch, at the end of the tick where the factory tick can't be running. Experimental, and AutoLink.Record and AutoLink.ShadowMode don't run while it's on. 0 (the default) only links belt connectors when a belt or lift is on one side."),
+    ECVF_Default);
+
+TAutoConsoleVariable<bool> CVarAutoLinkLoadAudit(
+    TEXT("AutoLink.LoadAudit"),
+    false,
+    TEXT("After a world loads, finds every pair of touching connectors that should be linked and isn't, and links them over the first few seconds. AutoLink.AuditWorld does the same on demand."),
+    ECVF_Default);
+
+TAutoConsoleVariable<int32> CVarAutoLinkLoadAuditLinksPerFrame(
+    TEXT("AutoLink.LoadAuditLinksPerFrame"),
+    32,
+    TEXT("How many seams an audit links each frame."),
+    ECVF_Default);
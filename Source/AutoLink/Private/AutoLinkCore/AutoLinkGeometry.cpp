@@ -0,0 +1,339 @@
+#include "AutoLinkCore/AutoLinkGeometry.h"
+
+#include <cmath>
+
+namespace AutoLinkCore
+{
+    // Same value as UE_SMALL_NUMBER
+    static constexpr double AutoLinkSmallNumber = 1.e-8f;
+
+    double Vector::Length() const
+    {
+        return std::sqrt(SquaredLength());
+    }
+
+    Vector Vector::CrossProduct(const Vector& a, const Vector& b)
+    {
+        return
+        {
+            a.Y * b.Z - a.Z * b.Y,
+            a.Z * b.X - a.X * b.Z,
+            a.X * b.Y - a.Y * b.X
+        };
+    }
+
+    bool Vector::IsNearlyZero(double tolerance) const
+    {
+        return std::abs(X) <= tolerance
+            && std::abs(Y) <= tolerance
+            && std::abs(Z) <= tolerance;
+    }
+
+    bool Vector::PointsAreNear(const Vector& a, const Vector& b, double distance)
+    {
+        return std::abs(a.X - b.X) < distance
+            && std::abs(a.Y - b.Y) < distance
+            && std::abs(a.Z - b.Z) < distance;
+    }
+
+    void Vector::ToDirectionAndLength(Vector& outDirection, double& outLength) const
+    {
+        outLength = Length();
+        if (outLength > AutoLinkSmallNumber)
+        {
+            double oneOverLength = 1.0 / outLength;
+            outDirection = { X * oneOverLength, Y * oneOverLength, Z * oneOverLength };
+        }
+        else
+        {
+            outDirection = { 0, 0, 0 };
+        }
+    }
+
+    const char* ToString(BeltCandidateResult result)
+    {
+        switch (result)
+        {
+        case BeltCandidateResult::Compatible: return "Compatible";
+        case BeltCandidateResult::InvalidOffsetWindow: return "InvalidOffsetWindow";
+        case BeltCandidateResult::TouchingOutsideOffsetWindow: return "TouchingOutsideOffsetWindow";
+        case BeltCandidateResult::TouchingNotOpposed: return "TouchingNotOpposed";
+        case BeltCandidateResult::NotTouchingWithZeroOffsetWindow: return "NotTouchingWithZeroOffsetWindow";
+        case BeltCandidateResult::BeyondMaxOffset: return "BeyondMaxOffset";
+        case BeltCandidateResult::BelowMinOffset: return "BelowMinOffset";
+        case BeltCandidateResult::NotCollinear: return "NotCollinear";
+        default: return "Unknown";
+        }
+    }
+
+    const char* ToString(PipeCandidateResult result)
+    {
+        switch (result)
+        {
+        case PipeCandidateResult::Compatible: return "Compatible";
+        case PipeCandidateResult::NotCollinear: return "NotCollinear";
+        case PipeCandidateResult::TooFar: return "TooFar";
+        default: return "Unknown";
+        }
+    }
+
+    const char* ToString(RailCandidateResult result)
+    {
+        switch (result)
+        {
+        case RailCandidateResult::Compatible: return "Compatible";
+        case RailCandidateResult::TooFar: return "TooFar";
+        case RailCandidateResult::NotCollinear: return "NotCollinear";
+        case RailCandidateResult::NotOpposed: return "NotOpposed";
+        default: return "Unknown";
+        }
+    }
+
+    bool UnitVectorsArePointingInOppositeDirections(const Vector& firstUnitVector, const Vector& secondUnitVector, double cosineTolerance)
+    {
+        // Because they are unit vectors, the dot product is exactly the cosine of the angle between the vectors. For them to be in opposite directions,
+        // that should be -1, but we have a tolerance for floating point error and to allow slight angles when needed
+        return firstUnitVector.Dot(secondUnitVector) <= (cosineTolerance - 1);
+    }
+
+    float GetBeltSearchDistance(uint8_t ownerFlags)
+    {
+        if (ownerFlags & OwnerFlags::ConveyorBelt)
+        {
+            // If this is a belt then it in needs to be against the connector, but search
+            // a little bit outward to be sure we hit any buildable containing a connector
+            return Tolerances::BeltSearchDistance;
+        }
+
+        if (ownerFlags & OwnerFlags::ConveyorLift)
+        {
+            // If this is a conveyor lift, then there could be another conveyor lift facing it.
+            // Conveyor lifts can directly connect with their connectors at 400 units away,
+            // so we have that distance plus a bit to ensure we hit the buildable
+            return Tolerances::LiftSearchDistance;
+        }
+
+        // If this is a normal factory/buildable, it could still be aligned with a fully-extended
+        // conveyor lift and we still pad a bit to ensure an appropriate hit
+        return Tolerances::BuildingBeltSearchDistance;
+    }
+
+    bool IsBeltPairAllowed(const Connector& connector, const Connector& candidate)
+    {
+        return connector.IsOnConveyor() || candidate.IsOnConveyor();
+    }
+
+    bool AreBeltDirectionsCompatible(ConnectorDirection first, ConnectorDirection second)
+    {
+        return (first == ConnectorDirection::Input && second == ConnectorDirection::Output)
+            || (first == ConnectorDirection::Output && second == ConnectorDirection::Input);
+    }
+
+    BeltOffsetWindow ComputeBeltOffsetWindow(const Connector& connector, const Connector& candidate)
+    {
+        // These are offsets where negative is behind the connector (against the normal) and positive is in front (with the normal).
+        BeltOffsetWindow window{ 0.0f, 0.0f };
+
+        const bool connectionConveyorBelt = (connector.OwnerFlags & OwnerFlags::ConveyorBelt) != 0;
+        const bool connectionConveyorLift = (connector.OwnerFlags & OwnerFlags::ConveyorLift) != 0;
+        const bool candidateConveyorBelt = (candidate.OwnerFlags & OwnerFlags::ConveyorBelt) != 0;
+        const bool candidateConveyorLift = (candidate.OwnerFlags & OwnerFlags::ConveyorLift) != 0;
+
+        if (connectionConveyorBelt || candidateConveyorBelt)
+        {
+            if (connectionConveyorLift || candidateConveyorLift)
+            {
+                // If it's a belt to conveyor lift, we allow the same distance that the lifts can extend to connect when building them normally
+                window.MaxOffset = Tolerances::BeltToLiftMaxOffset;
+            }
+
+            // If a belt to a non-lift, leave the offsets at 0, since belts have to be up against the connector
+            // (unless a storage container or dimensional depot are involved, but we handle those later).
+        }
+        else if (connectionConveyorLift || candidateConveyorLift)
+        {
+            if (candidate.OwnerFlags & OwnerFlags::ConveyorAttachment)
+            {
+                window.MinOffset = 0; // Lifts are allowed to clip all the way into splitters/mergers
+            }
+            else
+            {
+                window.MinOffset = Tolerances::LiftMinOffsetIntoBuilding; // But they cannot clip all the way into other factory buildings
+            }
+
+            // Two conveyor lifts can directly connect 400 units away. There are ways to make it look like two
+            // fully-extended lifts are attached at 300 units each (600 total) but the game will shrink the
+            // bellows to 200 units each on reload, even if we AutoLink them - the bellows only seem to extend
+            // into buildings. If it's just one conveyor lift, then we're either scanning to/from a building and
+            // those connectors can be at-most 300 units away as the bellows will fully extend for them.
+            window.MaxOffset = connectionConveyorLift && candidateConveyorLift ? Tolerances::LiftToLiftMaxOffset : Tolerances::LiftToBuildingMaxOffset;
+        }
+
+        // Dimensional depot input connectors are 10 units deeper than storage container input connectors. This misalignment
+        // means replacing a storage container with a dimensional depot (or vice versa) doesn't naturally autolink, which is
+        // confusing since it's intuitive to swap one for the other at different points. Since there's a glow around the depot
+        // connector that hides any small gap, we can compensate with offset tolerances and it won't look weird, whether the
+        // belt ends in a dim depot glow or extends into the storage container an extra 10 units.
+        if (connector.Direction == ConnectorDirection::Input && (candidateConveyorBelt || candidateConveyorLift))
+        {
+            if (connector.OwnerFlags & OwnerFlags::CentralStorage)
+            {
+                window.MaxOffset += Tolerances::StorageDepotAlignmentOffset;
+            }
+            else if (connector.OwnerFlags & OwnerFlags::Storage)
+            {
+                window.MinOffset -= Tolerances::StorageDepotAlignmentOffset;
+            }
+        }
+        else if (connector.Direction == ConnectorDirection::Output && (connectionConveyorBelt || connectionConveyorLift))
+        {
+            if (candidate.OwnerFlags & OwnerFlags::CentralStorage)
+            {
+                window.MaxOffset += Tolerances::StorageDepotAlignmentOffset;
+            }
+            else if (candidate.OwnerFlags & OwnerFlags::Storage)
+            {
+                window.MinOffset -= Tolerances::StorageDepotAlignmentOffset;
+            }
+        }
+
+        return window;
+    }
+
+    BeltCandidateResult EvaluateBeltCandidate(const Connector& connector, const Connector& candidate, double& outDistance)
+    {
+        const BeltOffsetWindow window = ComputeBeltOffsetWindow(connector, candidate);
+        const float minConnectorOffset = window.MinOffset;
+        const float maxConnectorOffset = window.MaxOffset;
+
+        if (minConnectorOffset > maxConnectorOffset)
+        {
+            return BeltCandidateResult::InvalidOffsetWindow;
+        }
+
+        // This gives the vector from the candidate connection to the main connector, which is useful to know where the connectors are in space relative to each other.
+        // With simple vector operations on just the connector normals, they could theoretically point "against" each other but be on opposite sides of the map. Using
+        // the vector between the connector and the candidate lets us determine their distance and whether the connectors are overlapping.
+        const Vector fromCandidateToConnectorVector = connector.Location - candidate.Location;
+        const Vector& connectorNormal = connector.Normal;
+        const Vector& candidateConnectorNormal = candidate.Normal;
+
+        if (fromCandidateToConnectorVector.IsNearlyZero(Tolerances::BeltTouchingDistance)) // Treat a distance within 1 cm as touching
+        {
+            if (minConnectorOffset > 0 || maxConnectorOffset < 0)
+            {
+                return BeltCandidateResult::TouchingOutsideOffsetWindow;
+            }
+
+            // If the connectors are touching and 0 is an allowed distance, then check whether they are facing each other.
+            if (!Vector::PointsAreNear(connectorNormal, -candidateConnectorNormal, Tolerances::BeltTouchingNormalDistance)) // Allow a little floating point precision error
+            {
+                return BeltCandidateResult::TouchingNotOpposed;
+            }
+
+            outDistance = 0;
+            return BeltCandidateResult::Compatible;
+        }
+
+        if (minConnectorOffset == 0 && maxConnectorOffset == 0)
+        {
+            return BeltCandidateResult::NotTouchingWithZeroOffsetWindow;
+        }
+
+        // Connectors are some distance from each other and min/max offsets allow some distance - now we figure out if they match
+        Vector fromCandidateToConnectorNormal;
+        double fromCandidateToConnectorDistance;
+        fromCandidateToConnectorVector.ToDirectionAndLength(fromCandidateToConnectorNormal, fromCandidateToConnectorDistance);
+
+        const int ConnectorOffsetPadding = Tolerances::BeltConnectorOffsetPadding;
+        const double CosineTolerance = Tolerances::BeltCosineTolerance;
+
+        if (UnitVectorsArePointingInOppositeDirections(connectorNormal, fromCandidateToConnectorNormal, CosineTolerance) // Connector normal points at candidate
+            &&
+            UnitVectorsArePointingInOppositeDirections(candidateConnectorNormal, -fromCandidateToConnectorNormal, CosineTolerance)) // Candidate normal points at connector
+        {
+            // They are aligned, pointing at each other, and the candidate is at a positive offset, so check against allowed positive offsets
+            if (maxConnectorOffset <= 0 || fromCandidateToConnectorDistance > maxConnectorOffset + ConnectorOffsetPadding)
+            {
+                return BeltCandidateResult::BeyondMaxOffset;
+            }
+            else if (minConnectorOffset >= 0 && fromCandidateToConnectorDistance < minConnectorOffset - ConnectorOffsetPadding)
+            {
+                return BeltCandidateResult::BelowMinOffset;
+            }
+        }
+        else if (
+            UnitVectorsArePointingInOppositeDirections(connectorNormal, -fromCandidateToConnectorNormal, CosineTolerance) // Connector normal points away from candidate
+            &&
+            UnitVectorsArePointingInOppositeDirections(candidateConnectorNormal, fromCandidateToConnectorNormal, CosineTolerance)) // Candidate normal points away from connector
+        {
+            auto negativeCandidateDistance = -fromCandidateToConnectorDistance;
+
+            // They are aligned, pointing away from each other, and the candidate is at a negative offset, so check against allowed negative offsets
+            if (minConnectorOffset >= 0 || negativeCandidateDistance < minConnectorOffset - ConnectorOffsetPadding)
+            {
+                return BeltCandidateResult::BelowMinOffset;
+            }
+            else if (maxConnectorOffset <= 0 && negativeCandidateDistance > maxConnectorOffset + ConnectorOffsetPadding)
+            {
+                return BeltCandidateResult::BeyondMaxOffset;
+            }
+        }
+        else
+        {
+            return BeltCandidateResult::NotCollinear;
+        }
+
+        outDistance = fromCandidateToConnectorDistance;
+        return BeltCandidateResult::Compatible;
+    }
+
+    PipeCandidateResult EvaluatePipeCandidate(const Connector& connector, const Connector& candidate)
+    {
+        // Determine if the connections components are aligned
+        const Vector crossProduct = Vector::CrossProduct(connector.Normal, candidate.Normal);
+        if (!crossProduct.IsNearlyZero(Tolerances::PipeCrossProductTolerance))
+        {
+            return PipeCandidateResult::NotCollinear;
+        }
+
+        // Pipes have to be virtually touching for us to link them so we just make double sure of that here.
+        const float distanceSq = (float)(candidate.Location - connector.Location).SquaredLength();
+        if (distanceSq > Tolerances::PipeMaxDistanceSquared) // Anything more than a 1 cm away is too far
+        {
+            return PipeCandidateResult::TooFar;
+        }
+
+        return PipeCandidateResult::Compatible;
+    }
+
+    RailCandidateResult EvaluateRailCandidate(const Connector& connector, const Connector& candidate)
+    {
+        const Vector fromCandidateToConnectorVector = connector.Location - candidate.Location;
+        const float distanceSq = (float)fromCandidateToConnectorVector.SquaredLength();
+        if (distanceSq > Tolerances::RailMaxDistanceSquared) // Anything more than a 1 cm away is too far
+        {
+            return RailCandidateResult::TooFar;
+        }
+
+        // Determine if the connections components are aligned. We allow slightly unaligned normal vectors to account for curved rails.
+        const Vector crossProduct = Vector::CrossProduct(connector.Normal, candidate.Normal);
+        const bool isCollinear = std::abs(crossProduct.X) <= Tolerances::RailCrossProductXYTolerance
+            && std::abs(crossProduct.Y) <= Tolerances::RailCrossProductXYTolerance
+            && std::abs(crossProduct.Z) <= Tolerances::RailCrossProductZTolerance;
+        if (!isCollinear)
+        {
+            return RailCandidateResult::NotCollinear;
+        }
+
+        // Determine if both connectors are facing in opposite directions. Rail junctions are an example where overlap might mean they're facing the same direction.
+        // If a dot product is positive, then the vectors are less than 90 degrees apart.
+        // So this dot product should be negative, meaning the connector normal is pointing AGAINST the candidate normal vector
+        if (connector.Normal.Dot(candidate.Normal) >= 0)
+        {
+            return RailCandidateResult::NotOpposed;
+        }
+
+        return RailCandidateResult::Compatible;
+    }
+}
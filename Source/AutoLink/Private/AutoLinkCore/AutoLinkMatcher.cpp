@@ -0,0 +1,390 @@
+#include "AutoLinkCore/AutoLinkMatcher.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <unordered_set>
+#include <utility>
+
+namespace AutoLinkCore
+{
+    // Per-connector state that changes as links are made. Kept apart from the (possibly memory-mapped) connectors themselves.
+    struct AutoLinkMatchState
+    {
+        const Connector* Connectors;
+        size_t NumConnectors;
+        size_t NumToLink; // Only connectors before this index are linked; the rest are only candidates
+        uint32_t KindMask;
+        std::vector<uint8_t> NumConnections;
+        // Usually MaxConnections, but a rail track connector linked to a rail attachment can't take any more connections
+        std::vector<uint8_t> Capacity;
+        std::unordered_set<uint64_t> LinkedRailPairs;
+        std::vector<LinkDecision>& Decisions;
+        MatchStats Stats;
+
+        AutoLinkMatchState(const Connector* connectors, size_t numConnectors, size_t numToLink, uint32_t kindMask, std::vector<LinkDecision>& decisions)
+            : Connectors(connectors)
+            , NumConnectors(numConnectors)
+            , NumToLink(std::min(numToLink, numConnectors))
+            , KindMask(kindMask)
+            , NumConnections(numConnectors)
+            , Capacity(numConnectors)
+            , Decisions(decisions)
+        {
+            for (size_t i = 0; i < numConnectors; ++i)
+            {
+                NumConnections[i] = connectors[i].NumConnections;
+                Capacity[i] = connectors[i].MaxConnections;
+            }
+        }
+
+        bool IsOpen(uint32_t index) const
+        {
+            return NumConnections[index] < Capacity[index];
+        }
+
+        bool IsKindEnabled(ConnectorKind kind) const
+        {
+            return (KindMask & (1u << (uint32_t)kind)) != 0;
+        }
+
+        // Whether the connector at candidateIndex could be linked to the connector at index at all, before any geometry
+        bool IsCandidateFor(uint32_t index, uint32_t candidateIndex) const
+        {
+            const Connector& connector = Connectors[index];
+            const Connector& candidate = Connectors[candidateIndex];
+            return candidateIndex != index
+                && candidate.Kind == connector.Kind
+                && candidate.OwnerId != connector.OwnerId
+                && IsOpen(candidateIndex);
+        }
+
+        static uint64_t GetPairKey(uint32_t first, uint32_t second)
+        {
+            return first < second
+                ? ((uint64_t)first << 32) | second
+                : ((uint64_t)second << 32) | first;
+        }
+
+        void AddDecision(uint32_t index, uint32_t candidateIndex, double distance)
+        {
+            Decisions.push_back({ index, candidateIndex, distance });
+            ++NumConnections[index];
+            ++NumConnections[candidateIndex];
+            ++Stats.LinksMade;
+        }
+    };
+
+    static void AutoLinkMatchBelt(AutoLinkMatchState& state, uint32_t index, const std::vector<uint32_t>& candidates)
+    {
+        const Connector& connector = state.Connectors[index];
+
+        float closestDistance = FLT_MAX;
+        double bestDistance = 0;
+        int64_t bestCandidate = -1;
+        for (auto candidateIndex : candidates)
+        {
+            const Connector& candidate = state.Connectors[candidateIndex];
+            if (!IsBeltPairAllowed(connector, candidate) || !AreBeltDirectionsCompatible(connector.Direction, candidate.Direction))
+            {
+                continue;
+            }
+
+            ++state.Stats.CandidatesEvaluated;
+            double distance;
+            if (EvaluateBeltCandidate(connector, candidate, distance) != BeltCandidateResult::Compatible)
+            {
+                continue;
+            }
+
+            if (distance < closestDistance)
+            {
+                closestDistance = (float)distance;
+                bestDistance = distance;
+                bestCandidate = candidateIndex;
+
+                if (closestDistance < Tolerances::BeltCloseEnoughDistance)
+                {
+                    break;
+                }
+            }
+        }
+
+        if (bestCandidate >= 0)
+        {
+            state.AddDecision(index, (uint32_t)bestCandidate, bestDistance);
+        }
+    }
+
+    static void AutoLinkMatchPipe(AutoLinkMatchState& state, uint32_t index, const std::vector<uint32_t>& candidates)
+    {
+        const Connector& connector = state.Connectors[index];
+        for (auto candidateIndex : candidates)
+        {
+            const Connector& candidate = state.Connectors[candidateIndex];
+
+            // The base game has no way to directly link pipe junctions to pipe junctions, so we don't either
+            if (connector.Kind == ConnectorKind::Fluid
+                && (connector.OwnerFlags & OwnerFlags::PipelineJunction)
+                && (candidate.OwnerFlags & OwnerFlags::PipelineJunction))
+            {
+                continue;
+            }
+
+            ++state.Stats.CandidatesEvaluated;
+            if (EvaluatePipeCandidate(connector, candidate) == PipeCandidateResult::Compatible)
+            {
+                state.AddDecision(index, candidateIndex, std::sqrt((connector.Location - candidate.Location).SquaredLength()));
+                return;
+            }
+        }
+    }
+
+    // Mirrors the candidate loop in FindAndLinkCompatibleRailroadConnection. The switch control checks that can abort a link
+    // in game need the rail graph, which we don't have here, so batches containing overfull switches can link more than the game would.
+    static void AutoLinkMatchRail(AutoLinkMatchState& state, uint32_t index, const std::vector<uint32_t>& candidates)
+    {
+        const Connector& connector = state.Connectors[index];
+        const int numStartingConnections = state.NumConnections[index];
+        const int maxConnections = state.Capacity[index];
+
+        bool involvesRailAttachment = (connector.OwnerFlags & OwnerFlags::RailroadAttachment) != 0;
+        int numCompatibleConnections = 0;
+        uint32_t compatibleConnections[Tolerances::MaxConnectionsPerRailConnector];
+
+        for (auto candidateIndex : candidates)
+        {
+            const Connector& candidate = state.Connectors[candidateIndex];
+
+            // We can only link the connection to a rail attachment candidate if the connection does not already have any connections
+            // or has not already been slated to autolink with another connection
+            const bool candidateIsRailAttachment = (candidate.OwnerFlags & OwnerFlags::RailroadAttachment) != 0;
+            if (candidateIsRailAttachment && state.NumConnections[candidateIndex] + numCompatibleConnections > 0)
+            {
+                continue;
+            }
+
+            if (state.LinkedRailPairs.count(AutoLinkMatchState::GetPairKey(index, candidateIndex)) > 0)
+            {
+                continue;
+            }
+
+            ++state.Stats.CandidatesEvaluated;
+            if (EvaluateRailCandidate(connector, candidate) != RailCandidateResult::Compatible)
+            {
+                continue;
+            }
+
+            compatibleConnections[numCompatibleConnections++] = candidateIndex;
+            involvesRailAttachment = involvesRailAttachment || candidateIsRailAttachment;
+
+            if (involvesRailAttachment || numStartingConnections + numCompatibleConnections >= maxConnections)
+            {
+                break;
+            }
+        }
+
+        if (numCompatibleConnections == 0 || numStartingConnections + numCompatibleConnections > maxConnections)
+        {
+            return;
+        }
+
+        for (int i = 0; i < numCompatibleConnections; ++i)
+        {
+            auto candidateIndex = compatibleConnections[i];
+            state.AddDecision(index, candidateIndex, std::sqrt((connector.Location - state.Connectors[candidateIndex].Location).SquaredLength()));
+            state.LinkedRailPairs.insert(AutoLinkMatchState::GetPairKey(index, candidateIndex));
+
+            if (involvesRailAttachment)
+            {
+                // Whichever side is the track is now connected to an attachment and can't take any more connections
+                state.Capacity[index] = state.NumConnections[index];
+                state.Capacity[candidateIndex] = state.NumConnections[candidateIndex];
+            }
+        }
+    }
+
+    static void AutoLinkMatchConnector(AutoLinkMatchState& state, uint32_t index, const std::vector<uint32_t>& candidates)
+    {
+        switch (state.Connectors[index].Kind)
+        {
+        case ConnectorKind::Belt:
+            AutoLinkMatchBelt(state, index, candidates);
+            break;
+        case ConnectorKind::Fluid:
+        case ConnectorKind::Hyper:
+            AutoLinkMatchPipe(state, index, candidates);
+            break;
+        case ConnectorKind::Railroad:
+            AutoLinkMatchRail(state, index, candidates);
+            break;
+        default:
+            break;
+        }
+    }
+
+    static bool AutoLinkShouldMatch(const AutoLinkMatchState& state, uint32_t index)
+    {
+        const Connector& connector = state.Connectors[index];
+        if (connector.Kind >= ConnectorKind::Num || !state.IsKindEnabled(connector.Kind) || !state.IsOpen(index))
+        {
+            return false;
+        }
+
+        // We only support specific input and output belt connections because it's really not clear what the others mean
+        return connector.Kind != ConnectorKind::Belt
+            || connector.Direction == ConnectorDirection::Input
+            || connector.Direction == ConnectorDirection::Output;
+    }
+
+    static void AutoLinkFindLinksBruteForce(AutoLinkMatchState& state)
+    {
+        std::vector<uint32_t> candidates;
+        for (uint32_t index = 0; index < state.NumToLink; ++index)
+        {
+            if (!AutoLinkShouldMatch(state, index))
+            {
+                continue;
+            }
+
+            candidates.clear();
+            for (uint32_t candidateIndex = 0; candidateIndex < state.NumConnectors; ++candidateIndex)
+            {
+                if (state.IsCandidateFor(index, candidateIndex))
+                {
+                    candidates.push_back(candidateIndex);
+                }
+            }
+
+            AutoLinkMatchConnector(state, index, candidates);
+        }
+    }
+
+    // Cells are keyed by kind and cell coordinates so one sorted array holds every kind's grid
+    static uint64_t AutoLinkGetCellKey(ConnectorKind kind, int64_t cellX, int64_t cellY, int64_t cellZ)
+    {
+        const int64_t CellBias = 1 << 19;
+        const uint64_t CellMask = (1 << 20) - 1;
+        return ((uint64_t)kind << 60)
+            | ((uint64_t)(cellX + CellBias) & CellMask) << 40
+            | ((uint64_t)(cellY + CellBias) & CellMask) << 20
+            | ((uint64_t)(cellZ + CellBias) & CellMask);
+    }
+
+    static int64_t AutoLinkGetCellCoordinate(double value)
+    {
+        return (int64_t)std::floor(value / MatchCellSize);
+    }
+
+    static void AutoLinkFindLinksSpatialGrid(AutoLinkMatchState& state)
+    {
+        std::vector<std::pair<uint64_t, uint32_t>> cells;
+        cells.reserve(state.NumConnectors);
+        for (uint32_t index = 0; index < state.NumConnectors; ++index)
+        {
+            const Connector& connector = state.Connectors[index];
+            if (connector.Kind >= ConnectorKind::Num || !state.IsKindEnabled(connector.Kind))
+            {
+                continue;
+            }
+
+            cells.emplace_back(
+                AutoLinkGetCellKey(
+                    connector.Kind,
+                    AutoLinkGetCellCoordinate(connector.Location.X),
+                    AutoLinkGetCellCoordinate(connector.Location.Y),
+                    AutoLinkGetCellCoordinate(connector.Location.Z)),
+                index);
+        }
+
+        std::sort(cells.begin(), cells.end());
+
+        std::vector<uint32_t> candidates;
+        for (uint32_t index = 0; index < state.NumToLink; ++index)
+        {
+            if (!AutoLinkShouldMatch(state, index))
+            {
+                continue;
+            }
+
+            const Connector& connector = state.Connectors[index];
+            const int64_t cellX = AutoLinkGetCellCoordinate(connector.Location.X);
+            const int64_t cellY = AutoLinkGetCellCoordinate(connector.Location.Y);
+            const int64_t cellZ = AutoLinkGetCellCoordinate(connector.Location.Z);
+
+            candidates.clear();
+            for (int64_t offsetX = -1; offsetX <= 1; ++offsetX)
+            {
+                for (int64_t offsetY = -1; offsetY <= 1; ++offsetY)
+                {
+                    for (int64_t offsetZ = -1; offsetZ <= 1; ++offsetZ)
+                    {
+                        const uint64_t key = AutoLinkGetCellKey(connector.Kind, cellX + offsetX, cellY + offsetY, cellZ + offsetZ);
+                        auto first = std::lower_bound(cells.begin(), cells.end(), std::make_pair(key, (uint32_t)0));
+                        for (auto it = first; it != cells.end() && it->first == key; ++it)
+                        {
+                            if (state.IsCandidateFor(index, it->second))
+                            {
+                                candidates.push_back(it->second);
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Examine candidates in the same order as the reference so ties resolve identically
+            std::sort(candidates.begin(), candidates.end());
+            AutoLinkMatchConnector(state, index, candidates);
+        }
+    }
+
+    const char* ToString(MatchStrategy strategy)
+    {
+        switch (strategy)
+        {
+        case MatchStrategy::BruteForce: return "BruteForce";
+        case MatchStrategy::SpatialGrid: return "SpatialGrid";
+        default: return "Unknown";
+        }
+    }
+
+    void FindLinks(
+        const Connector* connectors,
+        size_t numConnectors,
+        MatchStrategy strategy,
+        std::vector<LinkDecision>& outDecisions,
+        MatchStats* outStats,
+        uint32_t kindMask)
+    {
+        FindLinksFor(connectors, numConnectors, numConnectors, strategy, outDecisions, outStats, kindMask);
+    }
+
+    void FindLinksFor(
+        const Connector* connectors,
+        size_t numConnectors,
+        size_t numToLink,
+        MatchStrategy strategy,
+        std::vector<LinkDecision>& outDecisions,
+        MatchStats* outStats,
+        uint32_t kindMask)
+    {
+        AutoLinkMatchState state(connectors, numConnectors, numToLink, kindMask, outDecisions);
+
+        switch (strategy)
+        {
+        case MatchStrategy::SpatialGrid:
+            AutoLinkFindLinksSpatialGrid(state);
+            break;
+        case MatchStrategy::BruteForce:
+        default:
+            AutoLinkFindLinksBruteForce(state);
+            break;
+        }
+
+        if (outStats)
+        {
+            outStats->CandidatesEvaluated += state.Stats.CandidatesEvaluated;
+            outStats->LinksMade += state.Stats.LinksMade;
+        }
+    }
+}
@@ -0,0 +1,217 @@
+#include "AutoLinkCore/AutoLinkRecording.h"
+
+#include <cstring>
+#include <utility>
+
+namespace AutoLinkCore
+{
+    // Far more classes than the game has, so a corrupt class id can't make us allocate the world
+    static constexpr uint32_t AutoLinkMaxRecordedClasses = 1 << 20;
+
+    void RecordingWriter::Append(const void* data, size_t size)
+    {
+        if (size == 0)
+        {
+            return;
+        }
+
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        Bytes.insert(Bytes.end(), bytes, bytes + size);
+    }
+
+    void RecordingWriter::WriteRecord(RecordType type, const void* payload, size_t payloadSize)
+    {
+        const RecordHeader header{ type, (uint32_t)payloadSize };
+        Append(&header, sizeof(header));
+        Append(payload, payloadSize);
+    }
+
+    void RecordingWriter::WriteHeader()
+    {
+        RecordingHeader header{};
+        std::memcpy(header.Magic, RecordingMagic, sizeof(header.Magic));
+        header.Version = RecordingVersion;
+        header.ConnectorSize = sizeof(Connector);
+        Append(&header, sizeof(header));
+    }
+
+    void RecordingWriter::WriteClassName(uint32_t classId, const std::string& className)
+    {
+        const RecordHeader header{ RecordType::ClassName, (uint32_t)(sizeof(classId) + className.size()) };
+        Append(&header, sizeof(header));
+        Append(&classId, sizeof(classId));
+        Append(className.data(), className.size());
+    }
+
+    void RecordingWriter::WritePassBegin(const std::string& source)
+    {
+        WriteRecord(RecordType::PassBegin, source.data(), source.size());
+    }
+
+    void RecordingWriter::WriteBuildable(uint32_t classId, uint64_t durationNs, const std::vector<Connector>& ownConnectors, const std::vector<Connector>& candidates, const std::vector<RecordedLink>& links)
+    {
+        RecordedBuildableHeader buildable{};
+        buildable.ClassId = classId;
+        buildable.NumOwnConnectors = (uint32_t)ownConnectors.size();
+        buildable.NumCandidates = (uint32_t)candidates.size();
+        buildable.NumLinks = (uint32_t)links.size();
+        buildable.DurationNs = durationNs;
+
+        const size_t payloadSize = sizeof(buildable) + (ownConnectors.size() + candidates.size()) * sizeof(Connector) + links.size() * sizeof(RecordedLink);
+        const RecordHeader header{ RecordType::Buildable, (uint32_t)payloadSize };
+        Append(&header, sizeof(header));
+        Append(&buildable, sizeof(buildable));
+        Append(ownConnectors.data(), ownConnectors.size() * sizeof(Connector));
+        Append(candidates.data(), candidates.size() * sizeof(Connector));
+        Append(links.data(), links.size() * sizeof(RecordedLink));
+    }
+
+    void RecordingWriter::WritePassEnd(uint64_t durationNs, uint32_t numBuildables)
+    {
+        const RecordedPassEnd passEnd{ durationNs, numBuildables, 0 };
+        WriteRecord(RecordType::PassEnd, &passEnd, sizeof(passEnd));
+    }
+
+    bool ReadRecording(const void* data, size_t size, Recording& outRecording, const char** outError)
+    {
+        auto fail = [outError](const char* error)
+        {
+            if (outError)
+            {
+                *outError = error;
+            }
+
+            return false;
+        };
+
+        if (size < sizeof(RecordingHeader))
+        {
+            return fail("File is smaller than the recording header");
+        }
+
+        RecordingHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.Magic, RecordingMagic, sizeof(header.Magic)) != 0)
+        {
+            return fail("Not an AutoLink hook recording");
+        }
+
+        if (header.Version != RecordingVersion || header.ConnectorSize != sizeof(Connector))
+        {
+            return fail("Recording was written by an incompatible version");
+        }
+
+        Recording recording;
+        RecordedPass pass;
+        bool inPass = false;
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        size_t offset = sizeof(RecordingHeader);
+        while (size - offset >= sizeof(RecordHeader))
+        {
+            RecordHeader record;
+            std::memcpy(&record, bytes + offset, sizeof(record));
+            offset += sizeof(record);
+            if (record.PayloadSize > size - offset)
+            {
+                break;
+            }
+
+            // Records are packed, so copy everything out rather than pointing into the buffer
+            const uint8_t* payload = bytes + offset;
+            offset += record.PayloadSize;
+            switch (record.Type)
+            {
+            case RecordType::ClassName:
+            {
+                uint32_t classId;
+                if (record.PayloadSize < sizeof(classId))
+                {
+                    return fail("Class name record is too small");
+                }
+
+                std::memcpy(&classId, payload, sizeof(classId));
+                if (classId >= AutoLinkMaxRecordedClasses)
+                {
+                    return fail("Class id is out of range");
+                }
+
+                if (classId >= recording.ClassNames.size())
+                {
+                    recording.ClassNames.resize(classId + 1);
+                }
+
+                recording.ClassNames[classId].assign(reinterpret_cast<const char*>(payload + sizeof(classId)), record.PayloadSize - sizeof(classId));
+                break;
+            }
+            case RecordType::PassBegin:
+                pass = RecordedPass();
+                pass.Source.assign(reinterpret_cast<const char*>(payload), record.PayloadSize);
+                inPass = true;
+                break;
+            case RecordType::Buildable:
+            {
+                RecordedBuildableHeader buildableHeader;
+                if (!inPass || record.PayloadSize < sizeof(buildableHeader))
+                {
+                    return fail("Buildable record is outside a pass or too small");
+                }
+
+                std::memcpy(&buildableHeader, payload, sizeof(buildableHeader));
+                const size_t numConnectors = (size_t)buildableHeader.NumOwnConnectors + buildableHeader.NumCandidates;
+                if (record.PayloadSize != sizeof(buildableHeader) + numConnectors * sizeof(Connector) + buildableHeader.NumLinks * sizeof(RecordedLink))
+                {
+                    return fail("Buildable record size doesn't match its contents");
+                }
+
+                RecordedBuildable buildable;
+                buildable.ClassId = buildableHeader.ClassId;
+                buildable.NumOwnConnectors = buildableHeader.NumOwnConnectors;
+                buildable.DurationNs = buildableHeader.DurationNs;
+                buildable.Connectors.resize(numConnectors);
+                buildable.Links.resize(buildableHeader.NumLinks);
+                if (numConnectors > 0)
+                {
+                    std::memcpy(buildable.Connectors.data(), payload + sizeof(buildableHeader), numConnectors * sizeof(Connector));
+                }
+
+                if (buildableHeader.NumLinks > 0)
+                {
+                    std::memcpy(buildable.Links.data(), payload + sizeof(buildableHeader) + numConnectors * sizeof(Connector), buildableHeader.NumLinks * sizeof(RecordedLink));
+                }
+
+                for (const auto& link : buildable.Links)
+                {
+                    if (link.Connector >= numConnectors || link.Candidate >= numConnectors)
+                    {
+                        return fail("Recorded link refers to a connector that isn't in the record");
+                    }
+                }
+
+                pass.Buildables.push_back(std::move(buildable));
+                break;
+            }
+            case RecordType::PassEnd:
+            {
+                RecordedPassEnd passEnd;
+                if (!inPass || record.PayloadSize != sizeof(passEnd))
+                {
+                    return fail("Pass end record is outside a pass or the wrong size");
+                }
+
+                std::memcpy(&passEnd, payload, sizeof(passEnd));
+                pass.DurationNs = passEnd.DurationNs;
+                recording.Passes.push_back(std::move(pass));
+                pass = RecordedPass();
+                inPass = false;
+                break;
+            }
+            default:
+                // Unknown records are skipped so newer recorders can add record types
+                break;
+            }
+        }
+
+        outRecording = std::move(recording);
+        return true;
+    }
+}
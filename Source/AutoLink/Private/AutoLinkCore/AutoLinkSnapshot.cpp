@@ -0,0 +1,111 @@
+#include "AutoLinkCore/AutoLinkSnapshot.h"
+
+#include <cstring>
+#include <utility>
+
+namespace AutoLinkCore
+{
+    static constexpr uint64_t AutoLinkSnapshotAlignment = 64;
+
+    static uint64_t AutoLinkAlignSnapshotOffset(uint64_t offset)
+    {
+        return (offset + AutoLinkSnapshotAlignment - 1) & ~(AutoLinkSnapshotAlignment - 1);
+    }
+
+    void WriteSnapshot(const Connector* connectors, size_t numConnectors, const std::vector<std::string>& classNames, std::vector<uint8_t>& outBytes)
+    {
+        SnapshotHeader header{};
+        std::memcpy(header.Magic, SnapshotMagic, sizeof(header.Magic));
+        header.Version = SnapshotVersion;
+        header.ConnectorSize = sizeof(Connector);
+        header.NumConnectors = numConnectors;
+        header.ConnectorsOffset = AutoLinkAlignSnapshotOffset(sizeof(SnapshotHeader));
+        header.NumClasses = classNames.size();
+        header.ClassNamesOffset = header.ConnectorsOffset + numConnectors * sizeof(Connector);
+        for (const auto& className : classNames)
+        {
+            header.ClassNamesSize += className.size() + 1;
+        }
+
+        outBytes.assign(header.ClassNamesOffset + header.ClassNamesSize, 0);
+        std::memcpy(outBytes.data(), &header, sizeof(header));
+        if (numConnectors > 0)
+        {
+            std::memcpy(outBytes.data() + header.ConnectorsOffset, connectors, numConnectors * sizeof(Connector));
+        }
+
+        // The buffer is zeroed, so skipping past each name leaves its terminator in place
+        uint8_t* name = outBytes.data() + header.ClassNamesOffset;
+        for (const auto& className : classNames)
+        {
+            std::memcpy(name, className.data(), className.size());
+            name += className.size() + 1;
+        }
+    }
+
+    bool ReadSnapshot(const void* data, size_t size, SnapshotView& outView, const char** outError)
+    {
+        auto fail = [outError](const char* error)
+        {
+            if (outError)
+            {
+                *outError = error;
+            }
+
+            return false;
+        };
+
+        if (size < sizeof(SnapshotHeader))
+        {
+            return fail("File is smaller than the snapshot header");
+        }
+
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        const auto* header = static_cast<const SnapshotHeader*>(data);
+        if (std::memcmp(header->Magic, SnapshotMagic, sizeof(header->Magic)) != 0)
+        {
+            return fail("Not an AutoLink connector snapshot");
+        }
+
+        if (header->Version != SnapshotVersion || header->ConnectorSize != sizeof(Connector))
+        {
+            return fail("Snapshot was written by an incompatible version");
+        }
+
+        if (header->ConnectorsOffset % alignof(Connector) != 0
+            || header->ConnectorsOffset > size
+            || header->NumConnectors > (size - header->ConnectorsOffset) / sizeof(Connector))
+        {
+            return fail("Connector table is out of bounds");
+        }
+
+        if (header->ClassNamesOffset > size
+            || header->ClassNamesSize > size - header->ClassNamesOffset
+            || header->NumClasses > header->ClassNamesSize)
+        {
+            return fail("Class name table is out of bounds");
+        }
+
+        SnapshotView view;
+        view.Connectors = reinterpret_cast<const Connector*>(bytes + header->ConnectorsOffset);
+        view.NumConnectors = header->NumConnectors;
+        view.ClassNames.reserve(header->NumClasses);
+
+        const char* name = reinterpret_cast<const char*>(bytes + header->ClassNamesOffset);
+        const char* namesEnd = name + header->ClassNamesSize;
+        for (uint64_t i = 0; i < header->NumClasses; ++i)
+        {
+            const void* terminator = std::memchr(name, '\0', namesEnd - name);
+            if (!terminator)
+            {
+                return fail("Class name table is truncated");
+            }
+
+            view.ClassNames.push_back(name);
+            name = static_cast<const char*>(terminator) + 1;
+        }
+
+        outView = std::move(view);
+        return true;
+    }
+}
@@ -0,0 +1,352 @@
+#include "AutoLinkCore/AutoLinkStressLayout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AutoLinkCore
+{
+    // splitmix64. Unlike the std distributions, it gives the same numbers on every compiler and platform.
+    class AutoLinkStressRandom
+    {
+    public:
+        explicit AutoLinkStressRandom(uint64_t seed)
+            : State(seed)
+        {
+        }
+
+        uint64_t Next()
+        {
+            uint64_t z = (State += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        // In [0, 1)
+        double NextDouble()
+        {
+            return (double)(Next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        double Range(double min, double max)
+        {
+            return min + (max - min) * NextDouble();
+        }
+
+        // A multiple of step from min to max inclusive, which keeps layouts on round numbers like the build gun's snapping does
+        double Steps(double min, double max, double step)
+        {
+            const auto numSteps = (uint64_t)((max - min) / step) + 1;
+            return min + (double)(Next() % numSteps) * step;
+        }
+
+        Vector UnitVector()
+        {
+            // Rejection sampling keeps the directions uniform
+            for (;;)
+            {
+                const Vector vector{ Range(-1, 1), Range(-1, 1), Range(-1, 1) };
+                const double squaredLength = vector.SquaredLength();
+                if (squaredLength > .01 && squaredLength <= 1)
+                {
+                    return vector * (1 / std::sqrt(squaredLength));
+                }
+            }
+        }
+
+    private:
+        uint64_t State;
+    };
+
+    static Vector AutoLinkNormalize(const Vector& vector)
+    {
+        return vector * (1 / vector.Length());
+    }
+
+    static void AutoLinkAddPiece(StressLayout& layout, StressPieceType type, const Vector& start, const Vector& end, const Vector& startDirection)
+    {
+        layout.Pieces.push_back({ type, start, end, startDirection });
+    }
+
+    static void AutoLinkGenerateBeltManifold(StressLayout& layout, AutoLinkStressRandom& random)
+    {
+        const uint32_t beltsPerRow = 100;
+        const double rowSpacing = 300;
+        for (uint32_t row = 0; layout.Pieces.size() < layout.Size; ++row)
+        {
+            // Alternate rows flow in opposite directions, so inputs and outputs of neighbouring rows sit side by side
+            const double direction = row % 2 == 0 ? 1 : -1;
+            const uint32_t numBelts = std::min<uint32_t>(beltsPerRow, layout.Size - (uint32_t)layout.Pieces.size());
+            Vector start{ 0, row * rowSpacing, 0 };
+            for (uint32_t belt = 0; belt < numBelts; ++belt)
+            {
+                const Vector end = start + Vector{ direction * random.Steps(200, 2000, 50), 0, 0 };
+                AutoLinkAddPiece(layout, StressPieceType::Belt, start, end, { direction, 0, 0 });
+                start = end;
+            }
+
+            layout.ExpectedLinks += numBelts - 1;
+        }
+    }
+
+    static void AutoLinkGenerateLiftStacks(StressLayout& layout, AutoLinkStressRandom& random)
+    {
+        const uint32_t liftsPerStack = 50;
+        const double stackSpacing = 400;
+        const auto stacksPerRow = (uint32_t)std::ceil(std::sqrt((double)layout.Size));
+        for (uint32_t stack = 0; stack < layout.Size; ++stack)
+        {
+            Vector bottom{ (stack % stacksPerRow) * stackSpacing, (stack / stacksPerRow) * stackSpacing, 0 };
+            for (uint32_t lift = 0; lift < liftsPerStack; ++lift)
+            {
+                const Vector top = bottom + Vector{ 0, 0, random.Steps(200, 1200, 100) };
+                AutoLinkAddPiece(layout, StressPieceType::Lift, bottom, top, { 0, 0, 1 });
+
+                // Lifts only link to lifts across a gap of 100 to 400 units
+                bottom = top + Vector{ 0, 0, random.Steps(Tolerances::LiftMinOffsetIntoBuilding, Tolerances::LiftToLiftMaxOffset, 100) };
+            }
+
+            layout.ExpectedLinks += liftsPerStack - 1;
+        }
+    }
+
+    static void AutoLinkGeneratePipeManifold(StressLayout& layout, const StressGeometry& geometry, AutoLinkStressRandom& random)
+    {
+        const uint32_t junctionsPerRow = 20;
+        const double maxStubLength = 900;
+        const double rowSpacing = (maxStubLength + geometry.JunctionHalfSize) * 2 + 500;
+        uint32_t numJunctions = 0;
+        for (uint32_t row = 0; numJunctions < layout.Size; ++row)
+        {
+            const uint32_t rowJunctions = std::min(junctionsPerRow, layout.Size - numJunctions);
+            const double y = row * rowSpacing;
+
+            // An inlet into the first junction, a pipe between each pair and an outlet out of the last
+            Vector inletStart{ 0, y, 0 };
+            Vector center = inletStart + Vector{ random.Steps(200, 1200, 100) + geometry.JunctionHalfSize, 0, 0 };
+            AutoLinkAddPiece(layout, StressPieceType::Pipe, inletStart, center - Vector{ geometry.JunctionHalfSize, 0, 0 }, { 1, 0, 0 });
+            for (uint32_t junction = 0; junction < rowJunctions; ++junction)
+            {
+                AutoLinkAddPiece(layout, StressPieceType::PipeJunction, center, center, { 1, 0, 0 });
+                for (double side : { 1.0, -1.0 })
+                {
+                    const Vector stubStart = center + Vector{ 0, side * geometry.JunctionHalfSize, 0 };
+                    AutoLinkAddPiece(layout, StressPieceType::Pipe, stubStart, stubStart + Vector{ 0, side * random.Steps(300, maxStubLength, 100), 0 }, { 0, side, 0 });
+                }
+
+                const Vector pipeStart = center + Vector{ geometry.JunctionHalfSize, 0, 0 };
+                const Vector pipeEnd = pipeStart + Vector{ random.Steps(200, 1200, 100), 0, 0 };
+                AutoLinkAddPiece(layout, StressPieceType::Pipe, pipeStart, pipeEnd, { 1, 0, 0 });
+                center = pipeEnd + Vector{ geometry.JunctionHalfSize, 0, 0 };
+            }
+
+            numJunctions += rowJunctions;
+            layout.ExpectedLinks += rowJunctions * 4;
+        }
+    }
+
+    static void AutoLinkGenerateHyperSpaghetti(StressLayout& layout, AutoLinkStressRandom& random)
+    {
+        const uint32_t tubesPerStrand = 50;
+
+        // Small enough that strands keep crossing each other, which is what makes spaghetti expensive to scan
+        const double boxHalfSize = 2000 + std::cbrt((double)layout.Size) * 500;
+        for (uint32_t strand = 0; layout.Pieces.size() < layout.Size; ++strand)
+        {
+            const uint32_t numTubes = std::min<uint32_t>(tubesPerStrand, layout.Size - (uint32_t)layout.Pieces.size());
+            Vector start{ random.Range(-boxHalfSize, boxHalfSize), random.Range(-boxHalfSize, boxHalfSize), random.Range(-boxHalfSize, boxHalfSize) };
+            Vector direction = random.UnitVector();
+            for (uint32_t tube = 0; tube < numTubes; ++tube)
+            {
+                // Wander up to about 30 degrees off the current direction, turning back towards the middle once outside the box
+                Vector chord = direction + random.UnitVector() * .5;
+                if (std::abs(start.X) > boxHalfSize || std::abs(start.Y) > boxHalfSize || std::abs(start.Z) > boxHalfSize)
+                {
+                    chord = chord + AutoLinkNormalize(-start);
+                }
+
+                chord = AutoLinkNormalize(chord);
+                const StressPiece piece{ StressPieceType::Hyper, start, start + chord * random.Steps(400, 1600, 100), direction };
+                layout.Pieces.push_back(piece);
+                start = piece.End;
+                direction = GetStressEndDirection(piece);
+            }
+
+            layout.ExpectedLinks += numTubes - 1;
+        }
+    }
+
+    static void AutoLinkGenerateRailYard(StressLayout& layout, AutoLinkStressRandom& random)
+    {
+        const uint32_t switchesPerLine = 10;
+        const double lineSpacing = 4000;
+        uint32_t numSwitches = 0;
+        for (uint32_t line = 0; numSwitches < layout.Size; ++line)
+        {
+            const uint32_t lineSwitches = std::min(switchesPerLine, layout.Size - numSwitches);
+            const double y = line * lineSpacing;
+            Vector joint{ 0, y, 0 };
+            AutoLinkAddPiece(layout, StressPieceType::Track, joint - Vector{ 3000, 0, 0 }, joint, { 1, 0, 0 });
+            for (uint32_t switchIndex = 0; switchIndex < lineSwitches; ++switchIndex)
+            {
+                // The straight track carries on to the next switch, the curved ones are sidings
+                const double length = random.Steps(2000, 4000, 500);
+                const double spread = random.Steps(400, 800, 100);
+                for (double side : { 0.0, 1.0, -1.0 })
+                {
+                    AutoLinkAddPiece(layout, StressPieceType::Track, joint, joint + Vector{ length, side * spread, 0 }, { 1, 0, 0 });
+                }
+
+                joint = joint + Vector{ length, 0, 0 };
+            }
+
+            numSwitches += lineSwitches;
+            layout.ExpectedLinks += lineSwitches * 3;
+        }
+    }
+
+    const char* ToString(StressLayoutType type)
+    {
+        switch (type)
+        {
+        case StressLayoutType::BeltManifold: return "BeltManifold";
+        case StressLayoutType::LiftStacks: return "LiftStacks";
+        case StressLayoutType::PipeManifold: return "PipeManifold";
+        case StressLayoutType::HyperSpaghetti: return "HyperSpaghetti";
+        case StressLayoutType::RailYard: return "RailYard";
+        default: return "Unknown";
+        }
+    }
+
+    bool ParseStressLayoutType(const char* name, StressLayoutType& outType)
+    {
+        for (int type = 0; type < (int)StressLayoutType::Num; ++type)
+        {
+            if (std::strcmp(name, ToString((StressLayoutType)type)) == 0)
+            {
+                outType = (StressLayoutType)type;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    uint32_t GetDefaultStressSize(StressLayoutType type)
+    {
+        switch (type)
+        {
+        case StressLayoutType::BeltManifold: return 10000;
+        case StressLayoutType::LiftStacks: return 64;
+        case StressLayoutType::PipeManifold: return 200;
+        case StressLayoutType::HyperSpaghetti: return 2000;
+        case StressLayoutType::RailYard: return 200;
+        default: return 0;
+        }
+    }
+
+    const char* ToString(StressPieceType type)
+    {
+        switch (type)
+        {
+        case StressPieceType::Belt: return "Belt";
+        case StressPieceType::Lift: return "Lift";
+        case StressPieceType::Pipe: return "Pipe";
+        case StressPieceType::PipeJunction: return "PipeJunction";
+        case StressPieceType::Hyper: return "Hyper";
+        case StressPieceType::Track: return "Track";
+        default: return "Unknown";
+        }
+    }
+
+    void GenerateStressLayout(StressLayoutType type, uint32_t size, uint64_t seed, const StressGeometry& geometry, StressLayout& outLayout)
+    {
+        outLayout = StressLayout();
+        outLayout.Type = type;
+        outLayout.Size = size;
+        outLayout.Seed = seed;
+
+        AutoLinkStressRandom random(seed);
+        switch (type)
+        {
+        case StressLayoutType::BeltManifold:
+            AutoLinkGenerateBeltManifold(outLayout, random);
+            break;
+        case StressLayoutType::LiftStacks:
+            AutoLinkGenerateLiftStacks(outLayout, random);
+            break;
+        case StressLayoutType::PipeManifold:
+            AutoLinkGeneratePipeManifold(outLayout, geometry, random);
+            break;
+        case StressLayoutType::HyperSpaghetti:
+            AutoLinkGenerateHyperSpaghetti(outLayout, random);
+            break;
+        case StressLayoutType::RailYard:
+            AutoLinkGenerateRailYard(outLayout, random);
+            break;
+        default:
+            break;
+        }
+    }
+
+    Vector GetStressEndDirection(const StressPiece& piece)
+    {
+        Vector chord;
+        double length;
+        (piece.End - piece.Start).ToDirectionAndLength(chord, length);
+        return chord * (2 * piece.StartDirection.Dot(chord)) - piece.StartDirection;
+    }
+
+    void AppendStressConnectors(const StressLayout& layout, const StressGeometry& geometry, std::vector<Connector>& outConnectors)
+    {
+        for (size_t i = 0; i < layout.Pieces.size(); ++i)
+        {
+            const StressPiece& piece = layout.Pieces[i];
+            auto append = [&](const Vector& location, const Vector& normal, ConnectorKind kind, ConnectorDirection direction, uint8_t ownerFlags)
+            {
+                Connector connector{};
+                connector.Location = location;
+                connector.Normal = normal;
+                connector.ClassId = (uint32_t)piece.Type;
+                connector.OwnerId = (uint32_t)i + 1;
+                connector.Kind = kind;
+                connector.Direction = direction;
+                connector.OwnerFlags = ownerFlags;
+                connector.MaxConnections = kind == ConnectorKind::Railroad ? Tolerances::MaxConnectionsPerRailConnector : 1;
+                outConnectors.push_back(connector);
+            };
+
+            switch (piece.Type)
+            {
+            case StressPieceType::Belt:
+                append(piece.Start, -piece.StartDirection, ConnectorKind::Belt, ConnectorDirection::Input, OwnerFlags::ConveyorBelt);
+                append(piece.End, GetStressEndDirection(piece), ConnectorKind::Belt, ConnectorDirection::Output, OwnerFlags::ConveyorBelt);
+                break;
+            case StressPieceType::Lift:
+                append(piece.Start, { 0, 0, -1 }, ConnectorKind::Belt, ConnectorDirection::Input, OwnerFlags::ConveyorLift);
+                append(piece.End, { 0, 0, 1 }, ConnectorKind::Belt, ConnectorDirection::Output, OwnerFlags::ConveyorLift);
+                break;
+            case StressPieceType::Pipe:
+            case StressPieceType::Hyper:
+            case StressPieceType::Track:
+            {
+                const ConnectorKind kind = piece.Type == StressPieceType::Pipe ? ConnectorKind::Fluid
+                    : piece.Type == StressPieceType::Hyper ? ConnectorKind::Hyper
+                    : ConnectorKind::Railroad;
+                append(piece.Start, -piece.StartDirection, kind, ConnectorDirection::Any, OwnerFlags::None);
+                append(piece.End, GetStressEndDirection(piece), kind, ConnectorDirection::Any, OwnerFlags::None);
+                break;
+            }
+            case StressPieceType::PipeJunction:
+                for (const Vector& normal : { Vector{ 1, 0, 0 }, Vector{ -1, 0, 0 }, Vector{ 0, 1, 0 }, Vector{ 0, -1, 0 } })
+                {
+                    append(piece.Start + normal * geometry.JunctionHalfSize, normal, ConnectorKind::Fluid, ConnectorDirection::Any, OwnerFlags::PipelineJunction);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
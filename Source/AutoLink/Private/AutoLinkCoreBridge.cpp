@@ -0,0 +1,176 @@
+#include "AutoLinkCoreBridge.h"
+
+#include "AutoLinkPassStats.h"
+
+#include "FGBuildableConveyorAttachment.h"
+#include "FGBuildableConveyorBelt.h"
+#include "FGBuildableConveyorLift.h"
+#include "FGBuildablePipelineJunction.h"
+#include "FGBuildableRailroadAttachment.h"
+#include "FGBuildableStorage.h"
+#include "FGCentralStorageContainer.h"
+#include "FGPipeConnectionComponentHyper.h"
+
+static_assert((int32)AutoLinkCore::ConnectorKind::Num == (int32)EAutoLinkConnectorKind::Num, "Connector kinds must line up between the mod and the core library");
+
+uint8 AutoLinkCoreBridge::GetOwnerFlags(const AActor* owner)
+{
+    using namespace AutoLinkCore;
+
+    if (!owner)
+    {
+        return OwnerFlags::None;
+    }
+
+    uint8 flags = OwnerFlags::None;
+    if (owner->IsA<AFGBuildableConveyorBelt>()) flags |= OwnerFlags::ConveyorBelt;
+    if (owner->IsA<AFGBuildableConveyorLift>()) flags |= OwnerFlags::ConveyorLift;
+    if (owner->IsA<AFGBuildableConveyorAttachment>()) flags |= OwnerFlags::ConveyorAttachment;
+    if (owner->IsA<AFGBuildableStorage>()) flags |= OwnerFlags::Storage;
+    if (owner->IsA<AFGCentralStorageContainer>()) flags |= OwnerFlags::CentralStorage;
+    if (owner->IsA<AFGBuildableRailroadAttachment>()) flags |= OwnerFlags::RailroadAttachment;
+    if (owner->IsA<AFGBuildablePipelineJunction>()) flags |= OwnerFlags::PipelineJunction;
+    return flags;
+}
+
+int AutoLinkCoreBridge::GetMaxRailConnections(const AActor* owner)
+{
+    return owner && owner->IsA<AFGBuildableRailroadAttachment>() ? 1 : AutoLinkCore::Tolerances::MaxConnectionsPerRailConnector;
+}
+
+AutoLinkCore::Connector AutoLinkCoreBridge::MakeConnector(UFGFactoryConnectionComponent* connection)
+{
+    AutoLinkCore::Connector connector{};
+    connector.Location = ToCore(connection->GetConnectorLocation());
+    connector.Normal = ToCore(connection->GetConnectorNormal());
+    connector.Kind = AutoLinkCore::ConnectorKind::Belt;
+
+    switch (connection->GetDirection())
+    {
+    case EFactoryConnectionDirection::FCD_INPUT:
+        connector.Direction = AutoLinkCore::ConnectorDirection::Input;
+        break;
+    case EFactoryConnectionDirection::FCD_OUTPUT:
+        connector.Direction = AutoLinkCore::ConnectorDirection::Output;
+        break;
+    default:
+        connector.Direction = AutoLinkCore::ConnectorDirection::Any;
+        break;
+    }
+
+    auto outerBuildable = connection->GetOuterBuildable();
+    connector.OwnerId = outerBuildable ? outerBuildable->GetUniqueID() : 0;
+    connector.OwnerFlags = GetOwnerFlags(outerBuildable);
+    connector.NumConnections = connection->IsConnected() ? 1 : 0;
+    connector.MaxConnections = 1;
+    return connector;
+}
+
+AutoLinkCore::Connector AutoLinkCoreBridge::MakeConnector(UFGPipeConnectionComponentBase* connection, AutoLinkCore::ConnectorKind kind)
+{
+    AutoLinkCore::Connector connector{};
+    connector.Location = ToCore(connection->GetConnectorLocation());
+    connector.Normal = ToCore(connection->GetConnectorNormal());
+    connector.Kind = kind;
+    connector.Direction = AutoLinkCore::ConnectorDirection::Any;
+
+    auto owner = connection->GetOwner();
+    connector.OwnerId = owner ? owner->GetUniqueID() : 0;
+    connector.OwnerFlags = GetOwnerFlags(owner);
+    connector.NumConnections = connection->IsConnected() ? 1 : 0;
+    connector.MaxConnections = 1;
+    return connector;
+}
+
+AutoLinkCore::Connector AutoLinkCoreBridge::MakeConnector(UFGRailroadTrackConnectionComponent* connection, int maxConnections)
+{
+    AutoLinkCore::Connector connector{};
+    connector.Location = ToCore(connection->GetConnectorLocation());
+    connector.Normal = ToCore(connection->GetConnectorNormal());
+    connector.Kind = AutoLinkCore::ConnectorKind::Railroad;
+    connector.Direction = AutoLinkCore::ConnectorDirection::Any;
+
+    auto owner = connection->GetOwner();
+    connector.OwnerId = owner ? owner->GetUniqueID() : 0;
+    connector.OwnerFlags = GetOwnerFlags(owner);
+    connector.NumConnections = (uint8)FMath::Min(connection->GetConnections().Num(), 255);
+    connector.MaxConnections = (uint8)maxConnections;
+
+    // A track connector that is linked to a rail attachment can't take any more connections, so report it as full
+    if (connector.NumConnections == 1)
+    {
+        auto connectedTo = connection->GetConnection();
+        if (connectedTo && connectedTo->GetOwner() && connectedTo->GetOwner()->IsA<AFGBuildableRailroadAttachment>())
+        {
+            connector.MaxConnections = connector.NumConnections;
+        }
+    }
+
+    return connector;
+}
+
+bool AutoLinkCoreBridge::TryMakeConnector(UActorComponent* component, AutoLinkCore::Connector& outConnector)
+{
+    if (auto factoryConnection = Cast<UFGFactoryConnectionComponent>(component))
+    {
+        outConnector = MakeConnector(factoryConnection);
+        return true;
+    }
+
+    if (auto hyperConnection = Cast<UFGPipeConnectionComponentHyper>(component))
+    {
+        outConnector = MakeConnector(hyperConnection, AutoLinkCore::ConnectorKind::Hyper);
+        return true;
+    }
+
+    if (auto fluidConnection = Cast<UFGPipeConnectionComponent>(component))
+    {
+        // Same filter as UAutoLinkRootInstanceModule::IsCandidate, minus the connected check
+        switch (fluidConnection->GetPipeConnectionType())
+        {
+        case EPipeConnectionType::PCT_CONSUMER:
+        case EPipeConnectionType::PCT_PRODUCER:
+        case EPipeConnectionType::PCT_ANY:
+            outConnector = MakeConnector(fluidConnection, AutoLinkCore::ConnectorKind::Fluid);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    if (auto railConnection = Cast<UFGRailroadTrackConnectionComponent>(component))
+    {
+        outConnector = MakeConnector(railConnection, GetMaxRailConnections(railConnection->GetOwner()));
+        return true;
+    }
+
+    return false;
+}
+
+void AutoLinkCoreBridge::AppendConnectedComponents(UActorComponent* component, TArray<UActorComponent*>& outComponents)
+{
+    if (auto factoryConnection = Cast<UFGFactoryConnectionComponent>(component))
+    {
+        if (factoryConnection->IsConnected())
+        {
+            outComponents.Add(factoryConnection->GetConnection());
+        }
+    }
+    else if (auto pipeConnection = Cast<UFGPipeConnectionComponentBase>(component))
+    {
+        if (pipeConnection->IsConnected())
+        {
+            outComponents.Add(pipeConnection->GetConnection());
+        }
+    }
+    else if (auto railConnection = Cast<UFGRailroadTrackConnectionComponent>(component))
+    {
+        for (auto otherConnection : railConnection->GetConnections())
+        {
+            if (otherConnection)
+            {
+                outComponents.Add(otherConnection);
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#include "AutoLinkDeferredLinks.h"
+
+#include "AutoLinkConnectorIndex.h"
+#include "AutoLinkLogMacros.h"
+#include "AutoLinkPassStats.h"
+
+#include "FGFactoryConnectionComponent.h"
+
+void AutoLinkDeferredLinks::Add(UFGFactoryConnectionComponent* connection, UFGFactoryConnectionComponent* candidate)
+{
+    AL_LOG("AutoLinkDeferredLinks::Add: Deferring the link from %s on %s to %s on %s",
+        *connection->GetName(),
+        *GetNameSafe(connection->GetOwner()),
+        *candidate->GetName(),
+        *GetNameSafe(candidate->GetOwner()));
+
+    AL_PASS_STAT_ADD(NumDeferredLinks, 1);
+    Pending.Add({ connection->GetWorld(), connection, candidate });
+}
+
+void AutoLinkDeferredLinks::Commit(UWorld* world)
+{
+    if (Pending.IsEmpty())
+    {
+        return;
+    }
+
+    TArray<DeferredLink> links;
+    TArray<DeferredLink> otherWorldLinks;
+    for (auto& link : Pending)
+    {
+        if (link.World == world)
+        {
+            links.Add(MoveTemp(link));
+        }
+        else if (link.World.IsValid())
+        {
+            otherWorldLinks.Add(MoveTemp(link));
+        }
+    }
+
+    Pending = MoveTemp(otherWorldLinks);
+
+    if (links.IsEmpty())
+    {
+        return;
+    }
+
+    AutoLinkPassScope passScope(TEXT("AutoLinkDeferredLinks::Commit"), world);
+    for (auto& link : links)
+    {
+        auto connection = link.Connection.Get();
+        auto candidate = link.Candidate.Get();
+        if (!IsValid(connection)
+            || !IsValid(candidate)
+            || connection->IsConnected()
+            || candidate->IsConnected()
+            || !candidate->CanConnectTo(connection))
+        {
+            AL_LOG("AutoLinkDeferredLinks::Commit: Dropping a link whose ends are gone or taken");
+            continue;
+        }
+
+        AL_LOG("AutoLinkDeferredLinks::Commit: Connecting %s on %s to %s on %s",
+            *connection->GetName(),
+            *GetNameSafe(connection->GetOwner()),
+            *candidate->GetName(),
+            *GetNameSafe(candidate->GetOwner()));
+
+        connection->SetConnection(candidate);
+        AutoLinkConnectorIndex::NoteLinked(connection, candidate);
+        AL_PASS_STAT_ADD(NumLinks, 1);
+    }
+}
@@ -0,0 +1,246 @@
+#include "AutoLinkHookRecorder.h"
+
+#include "AutoLinkConsoleVariables.h"
+#include "AutoLinkCoreBridge.h"
+#include "AutoLinkLogCategory.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+static uint64 GetElapsedNs(uint64 startCycles)
+{
+    return (uint64)(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - startCycles) * 1e9);
+}
+
+bool AutoLinkHookRecorder::Start(const FString& filePath)
+{
+    Stop();
+
+    // The offline rules never link two belt connectors without a conveyor between them, so a recording with those links would
+    // never replay the same
+    if (CVarAutoLinkAttachmentLinks.GetValueOnGameThread())
+    {
+        UE_LOG(LogAutoLink, Error, TEXT("AutoLinkHookRecorder: Not recording while AutoLink.AttachmentLinks is on"));
+        return false;
+    }
+
+    auto& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+    platformFile.CreateDirectoryTree(*FPaths::GetPath(filePath));
+    File.Reset(platformFile.OpenWrite(*filePath));
+    if (!File)
+    {
+        UE_LOG(LogAutoLink, Error, TEXT("AutoLinkHookRecorder: Could not open %s"), *filePath);
+        return false;
+    }
+
+    Writer.Bytes.clear();
+    Writer.WriteHeader();
+    ClassTable = AutoLinkClassTable();
+    NumClassNamesWritten = 0;
+    bIsInPass = false;
+    bIsInBuildable = false;
+    Flush();
+
+    UE_LOG(LogAutoLink, Display, TEXT("AutoLinkHookRecorder: Recording to %s"), *filePath);
+    return true;
+}
+
+void AutoLinkHookRecorder::Stop()
+{
+    if (!File)
+    {
+        return;
+    }
+
+    Flush();
+    File.Reset();
+    UE_LOG(LogAutoLink, Display, TEXT("AutoLinkHookRecorder: Stopped recording"));
+}
+
+void AutoLinkHookRecorder::Flush()
+{
+    if (File && !Writer.Bytes.empty())
+    {
+        File->Write(Writer.Bytes.data(), Writer.Bytes.size());
+        File->Flush();
+        Writer.Bytes.clear();
+    }
+}
+
+void AutoLinkHookRecorder::BeginPass(const TCHAR* source)
+{
+    if (CVarAutoLinkAttachmentLinks.GetValueOnGameThread())
+    {
+        UE_LOG(LogAutoLink, Error, TEXT("AutoLinkHookRecorder: AutoLink.AttachmentLinks was turned on, so recording stops here"));
+        Stop();
+        return;
+    }
+
+    bIsInPass = true;
+    NumPassBuildables = 0;
+    Writer.WritePassBegin(TCHAR_TO_UTF8(source ? source : TEXT("Unknown")));
+    PassStartCycles = FPlatformTime::Cycles64();
+}
+
+void AutoLinkHookRecorder::EndPass()
+{
+    if (!bIsInPass)
+    {
+        return;
+    }
+
+    bIsInPass = false;
+    Writer.WritePassEnd(GetElapsedNs(PassStartCycles), NumPassBuildables);
+
+    // Placements are human-paced, so writing every pass out straight away costs nothing noticeable and means a crash loses at
+    // most the pass that caused it
+    Flush();
+}
+
+void AutoLinkHookRecorder::BeginBuildable(AFGBuildable* buildable)
+{
+    if (!bIsInPass)
+    {
+        return;
+    }
+
+    bIsInBuildable = true;
+    BuildableClassId = ClassTable.GetId(buildable->GetClass());
+    OwnConnectors.clear();
+    Candidates.clear();
+    OwnIndices.Reset();
+    CandidateIndices.Reset();
+    Links.Reset();
+    BuildableStartCycles = FPlatformTime::Cycles64();
+}
+
+void AutoLinkHookRecorder::EndBuildable()
+{
+    if (!bIsInBuildable)
+    {
+        return;
+    }
+
+    bIsInBuildable = false;
+    const auto durationNs = GetElapsedNs(BuildableStartCycles);
+
+    std::vector<AutoLinkCore::RecordedLink> links;
+    links.reserve(Links.Num());
+    for (auto& link : Links)
+    {
+        auto connectorIndex = OwnIndices.Find(link.Key);
+        auto candidateIndex = CandidateIndices.Find(link.Value);
+        if (connectorIndex && candidateIndex)
+        {
+            links.push_back({ *connectorIndex, (uint32)OwnConnectors.size() + *candidateIndex });
+        }
+    }
+
+    // Names go out before the first record that uses them
+    for (; NumClassNamesWritten < ClassTable.Names.size(); ++NumClassNamesWritten)
+    {
+        Writer.WriteClassName((uint32)NumClassNamesWritten, ClassTable.Names[NumClassNamesWritten]);
+    }
+
+    Writer.WriteBuildable(BuildableClassId, durationNs, OwnConnectors, Candidates, links);
+    ++NumPassBuildables;
+}
+
+void AutoLinkHookRecorder::RecordConnector(const UActorComponent* component, AutoLinkCore::Connector connector, bool isOwn)
+{
+    if (OwnIndices.Contains(component) || CandidateIndices.Contains(component))
+    {
+        return;
+    }
+
+    auto owner = component->GetOwner();
+    connector.ClassId = ClassTable.GetId(owner ? owner->GetClass() : nullptr);
+
+    auto& connectors = isOwn ? OwnConnectors : Candidates;
+    (isOwn ? OwnIndices : CandidateIndices).Add(component, (uint32)connectors.size());
+    connectors.push_back(connector);
+}
+
+void AutoLinkHookRecorder::RecordCandidates(UFGFactoryConnectionComponent* connection, const AutoLinkCore::Connector& coreConnector, TArrayView<UFGFactoryConnectionComponent* const> candidates)
+{
+    if (!bIsInBuildable)
+    {
+        return;
+    }
+
+    RecordConnector(connection, coreConnector, true);
+    for (auto candidate : candidates)
+    {
+        if (IsValid(candidate))
+        {
+            RecordConnector(candidate, AutoLinkCoreBridge::MakeConnector(candidate), false);
+        }
+    }
+}
+
+void AutoLinkHookRecorder::RecordCandidates(UFGRailroadTrackConnectionComponent* connection, const AutoLinkCore::Connector& coreConnector, TArrayView<UFGRailroadTrackConnectionComponent* const> candidates)
+{
+    if (!bIsInBuildable)
+    {
+        return;
+    }
+
+    RecordConnector(connection, coreConnector, true);
+    for (auto candidate : candidates)
+    {
+        if (IsValid(candidate))
+        {
+            RecordConnector(candidate, AutoLinkCoreBridge::MakeConnector(candidate, AutoLinkCoreBridge::GetMaxRailConnections(candidate->GetOwner())), false);
+        }
+    }
+}
+
+void AutoLinkHookRecorder::RecordCandidates(UFGPipeConnectionComponentBase* connection, const AutoLinkCore::Connector& coreConnector, TArrayView<UFGPipeConnectionComponentBase* const> candidates)
+{
+    if (!bIsInBuildable)
+    {
+        return;
+    }
+
+    RecordConnector(connection, coreConnector, true);
+    for (auto candidate : candidates)
+    {
+        if (IsValid(candidate))
+        {
+            RecordConnector(candidate, AutoLinkCoreBridge::MakeConnector(candidate, coreConnector.Kind), false);
+        }
+    }
+}
+
+void AutoLinkHookRecorder::RecordLink(const UActorComponent* connection, const UActorComponent* candidate)
+{
+    if (bIsInBuildable)
+    {
+        Links.Emplace(connection, candidate);
+    }
+}
+
+FString AutoLinkHookRecorder::GetDefaultFilePath()
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("AutoLink"), TEXT("Recordings"), FString::Printf(TEXT("Hooks_%s.alrec"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S"))));
+}
+
+static FAutoConsoleCommand RecordCommand(
+    TEXT("AutoLink.Record"),
+    TEXT("Records what AutoLink's hooks do so it can be replayed offline with AutoLinkReplay. ")
+    TEXT("Usage: AutoLink.Record start [FilePath] | stop. Defaults to Saved/AutoLink/Recordings/Hooks_<time>.alrec."),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& args)
+    {
+        if (args.Num() > 0 && args[0].Equals(TEXT("start"), ESearchCase::IgnoreCase))
+        {
+            AutoLinkHookRecorder::Start(args.Num() > 1 ? args[1] : AutoLinkHookRecorder::GetDefaultFilePath());
+        }
+        else if (args.Num() > 0 && args[0].Equals(TEXT("stop"), ESearchCase::IgnoreCase))
+        {
+            AutoLinkHookRecorder::Stop();
+        }
+        else
+        {
+            UE_LOG(LogAutoLink, Display, TEXT("Usage: AutoLink.Record start [FilePath] | stop. Currently %s."), AutoLinkHookRecorder::IsRecording() ? TEXT("recording") : TEXT("not recording"));
+        }
+    }));
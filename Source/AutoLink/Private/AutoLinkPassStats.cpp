@@ -0,0 +1,202 @@
+#include "AutoLinkPassStats.h"
+
+#include "AutoLinkAllocationCounter.h"
+#include "AutoLinkConsoleVariables.h"
+#include "AutoLinkHookRecorder.h"
+#include "AutoLinkLogCategory.h"
+#include "AutoLinkShadow.h"
+
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+AutoLinkPassStats AutoLinkPassScope::Stats;
+
+void AutoLinkPassStats::Reset(const TCHAR* source, const UObject* context)
+{
+    Source = source;
+    Context = context;
+    StartCycles = FPlatformTime::Cycles64();
+    TotalCycles = 0;
+    NumBuildables = 0;
+    FMemory::Memzero(NumOpenConnectors);
+    FMemory::Memzero(PhaseCycles);
+    NumHitScans = 0;
+    NumOverlapScans = 0;
+    NumHitActors = 0;
+    NumCandidates = 0;
+    NumLinks = 0;
+    NumDeferredLinks = 0;
+    NumPrefilteredScans = 0;
+    NumSkippedScans = 0;
+    NumPlannedScans = 0;
+    NumUpgradeScans = 0;
+    NumFreedScans = 0;
+    NumSkippedChildren = 0;
+    NumPlacements = 0;
+    NumDuplicatePlacements = 0;
+    NumTrackRebuilds = 0;
+    TrackRebuildCycles = 0;
+    StartAllocations = AutoLinkAllocationCounter::GetNumAllocations();
+    NumAllocations = 0;
+    Classes.Reset();
+}
+
+void AutoLinkPassStats::AddClass(UClass* buildableClass)
+{
+    for (auto& classAndCount : Classes)
+    {
+        if (classAndCount.Key == buildableClass)
+        {
+            ++classAndCount.Value;
+            return;
+        }
+    }
+
+    Classes.Emplace(buildableClass, 1);
+}
+
+const TCHAR* AutoLinkPassStats::GetKindName(EAutoLinkConnectorKind kind)
+{
+    switch (kind)
+    {
+    case EAutoLinkConnectorKind::Belt: return TEXT("Belt");
+    case EAutoLinkConnectorKind::Railroad: return TEXT("Railroad");
+    case EAutoLinkConnectorKind::Fluid: return TEXT("Fluid");
+    case EAutoLinkConnectorKind::Hyper: return TEXT("Hyper");
+    default: return TEXT("Unknown");
+    }
+}
+
+FString AutoLinkPassStats::ToRecordString(double totalMs, float thresholdMs) const
+{
+    FString record;
+    record.Appendf(TEXT("AutoLink hitch record\n"));
+    record.Appendf(TEXT("Source: %s\n"), Source ? Source : TEXT("Unknown"));
+    record.Appendf(TEXT("Context: %s\n"), IsValid(Context) ? *Context->GetFullName() : TEXT("None"));
+    record.Appendf(TEXT("Time: %s\n"), *FDateTime::Now().ToString());
+    record.Appendf(TEXT("TotalMs: %.3f (threshold %.3f)\n"), totalMs, thresholdMs);
+    record.Appendf(TEXT("Buildables: %d SkippedChildren=%d Placements=%d DuplicatePlacements=%d\n"), NumBuildables, NumSkippedChildren, NumPlacements, NumDuplicatePlacements);
+
+    record.Appendf(TEXT("OpenConnectors:"));
+    for (int32 i = 0; i < NumKinds; ++i)
+    {
+        record.Appendf(TEXT(" %s=%d"), GetKindName((EAutoLinkConnectorKind)i), NumOpenConnectors[i]);
+    }
+    record.Appendf(TEXT("\n"));
+
+    record.Appendf(TEXT("PhaseMs:"));
+    for (int32 i = 0; i < NumKinds; ++i)
+    {
+        record.Appendf(TEXT(" %s=%.3f"), GetKindName((EAutoLinkConnectorKind)i), FPlatformTime::ToMilliseconds64(PhaseCycles[i]));
+    }
+    record.Appendf(TEXT("\n"));
+
+    record.Appendf(TEXT("Queries: HitScans=%d OverlapScans=%d PrefilteredScans=%d SkippedScans=%d PlannedScans=%d UpgradeScans=%d FreedScans=%d HitActors=%d Candidates=%d\n"), NumHitScans, NumOverlapScans, NumPrefilteredScans, NumSkippedScans, NumPlannedScans, NumUpgradeScans, NumFreedScans, NumHitActors, NumCandidates);
+    record.Appendf(TEXT("Links: %d Deferred=%d\n"), NumLinks, NumDeferredLinks);
+    record.Appendf(TEXT("TrackRebuilds: %d (%.3f ms)\n"), NumTrackRebuilds, FPlatformTime::ToMilliseconds64(TrackRebuildCycles));
+    if (AutoLinkAllocationCounter::IsInstalled())
+    {
+        record.Appendf(TEXT("Allocations: %d\n"), NumAllocations);
+    }
+
+    record.Appendf(TEXT("Classes (%d):\n"), Classes.Num());
+    for (auto& classAndCount : Classes)
+    {
+        record.Appendf(TEXT("    %s x%d\n"), classAndCount.Key ? *classAndCount.Key->GetPathName() : TEXT("null"), classAndCount.Value);
+    }
+
+    return record;
+}
+
+AutoLinkPassScope::AutoLinkPassScope(const TCHAR* source, const UObject* context, bool captureForCaller)
+    : bIsOutermost(Depth++ == 0)
+    , bCaptureForCaller(captureForCaller)
+{
+    if (!bIsOutermost)
+    {
+        return;
+    }
+
+    ScratchMark.Emplace(FMemStack::Get());
+    ConnectorTable.Emplace();
+
+    if (AutoLinkHookRecorder::IsRecording())
+    {
+        AutoLinkHookRecorder::BeginPass(source);
+    }
+
+    AutoLinkShadow::BeginPass(source);
+
+    // Reading the cvar once per pass keeps the disabled case down to this check and the null checks in AL_PASS_STAT_ADD
+    if (!bCaptureForCaller && CVarAutoLinkHitchThresholdMs.GetValueOnGameThread() <= 0)
+    {
+        ActiveStats = nullptr;
+        return;
+    }
+
+    Stats.Reset(source, context);
+    ActiveStats = &Stats;
+}
+
+AutoLinkPassScope::~AutoLinkPassScope()
+{
+    --Depth;
+    if (!bIsOutermost)
+    {
+        return;
+    }
+
+    if (AutoLinkHookRecorder::IsRecording())
+    {
+        AutoLinkHookRecorder::EndPass();
+    }
+
+    AutoLinkShadow::EndPass();
+
+    if (!ActiveStats)
+    {
+        return;
+    }
+
+    ActiveStats = nullptr;
+    Stats.TotalCycles = FPlatformTime::Cycles64() - Stats.StartCycles;
+    Stats.NumAllocations = (int32)(AutoLinkAllocationCounter::GetNumAllocations() - Stats.StartAllocations);
+    if (bCaptureForCaller)
+    {
+        return;
+    }
+
+    auto totalMs = FPlatformTime::ToMilliseconds64(Stats.TotalCycles);
+    auto thresholdMs = CVarAutoLinkHitchThresholdMs.GetValueOnGameThread();
+    if (thresholdMs > 0 && totalMs > thresholdMs)
+    {
+        WriteHitchRecord(Stats, totalMs, thresholdMs);
+    }
+}
+
+void AutoLinkPassScope::WriteHitchRecord(const AutoLinkPassStats& stats, double totalMs, float thresholdMs)
+{
+    // A pathological save could hitch on every placement, so cap how many files one session can write
+    static int32 NumRecordsWritten = 0;
+    const int32 MaxRecordsPerSession = 100;
+    if (NumRecordsWritten >= MaxRecordsPerSession)
+    {
+        return;
+    }
+
+    auto directory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("AutoLink"), TEXT("Hitches"));
+    FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*directory);
+
+    auto fileName = FString::Printf(TEXT("Hitch_%s_%03d.txt"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")), NumRecordsWritten);
+    auto filePath = FPaths::Combine(directory, fileName);
+    if (FFileHelper::SaveStringToFile(stats.ToRecordString(totalMs, thresholdMs), *filePath))
+    {
+        ++NumRecordsWritten;
+        UE_LOG(LogAutoLink, Warning, TEXT("Link pass from %s took %.3f ms (threshold %.3f ms). Wrote details to %s"), stats.Source, totalMs, thresholdMs, *filePath);
+    }
+    else
+    {
+        UE_LOG(LogAutoLink, Warning, TEXT("Link pass from %s took %.3f ms (threshold %.3f ms) but the record could not be written to %s"), stats.Source, totalMs, thresholdMs, *filePath);
+    }
+}
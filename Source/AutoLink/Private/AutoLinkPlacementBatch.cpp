@@ -0,0 +1,281 @@
+#include "AutoLinkPlacementBatch.h"
+
+#include "AutoLinkConnectorIndex.h"
+#include "AutoLinkConsoleVariables.h"
+#include "AutoLinkDeferredLinks.h"
+#include "AutoLinkLogMacros.h"
+#include "AutoLinkPassStats.h"
+#include "AutoLinkRootInstanceModule.h"
+#include "AutoLinkShadow.h"
+#include "AutoLinkUpgradeMap.h"
+
+#include "Engine/World.h"
+#include "FGBuildable.h"
+#include "UObject/UObjectArray.h"
+
+void AutoLinkPlacementBatch::Initialize()
+{
+    FWorldDelegates::OnWorldPostActorTick.AddLambda(
+        [](UWorld* world, ELevelTick tickType, float deltaSeconds)
+        {
+            Flush(world);
+            AutoLinkDeferredLinks::Commit(world);
+            AutoLinkUpgradeMap::EndFrame(world);
+            EndFrame();
+        });
+}
+
+void AutoLinkPlacementBatch::AddBuildable(const AActor* hologram, AFGBuildable* buildable)
+{
+    if (!MarkSeen(buildable))
+    {
+        return;
+    }
+
+    if (!CVarAutoLinkBatchPlacements.GetValueOnGameThread())
+    {
+        UAutoLinkRootInstanceModule::FindAndLinkForBuildable(buildable);
+        return;
+    }
+
+    AL_LOG("AutoLinkPlacementBatch::AddBuildable: Queueing %s from %s", *buildable->GetName(), *GetNameSafe(hologram));
+    LinkRequest request;
+    request.World = buildable->GetWorld();
+    request.Actors.Add(buildable);
+    request.Instigator = hologram;
+    request.bIsSeen = true;
+    Enqueue(MoveTemp(request));
+}
+
+void AutoLinkPlacementBatch::AddBlueprint(const AActor* hologram, const TArray<AActor*>& children)
+{
+    TArray<AActor*> unseenChildren;
+    unseenChildren.Reserve(children.Num());
+    for (auto child : children)
+    {
+        unseenChildren.Add(MarkSeen(child) ? child : nullptr);
+    }
+
+    if (!CVarAutoLinkBatchPlacements.GetValueOnGameThread())
+    {
+        LinkBlueprint(TEXT("AFGBlueprintHologram::Construct"), hologram, unseenChildren);
+        return;
+    }
+
+    AL_LOG("AutoLinkPlacementBatch::AddBlueprint: Queueing %d children of %s", children.Num(), *hologram->GetName());
+    LinkRequest request;
+    request.World = hologram->GetWorld();
+    request.Actors.Append(unseenChildren);
+    request.Instigator = hologram;
+    request.bIsBlueprint = true;
+    request.bIsSeen = true;
+    Enqueue(MoveTemp(request));
+}
+
+void AutoLinkPlacementBatch::RequestLink(AFGBuildable* buildable, const UObject* instigator, EAutoLinkRequestPriority priority)
+{
+    if (!buildable)
+    {
+        return;
+    }
+
+    // Nothing here may touch the buildable beyond its address, since this can be any thread
+    LinkRequest request;
+    request.RequestedBuildable = RequestedObject::Make(buildable);
+    request.RequestedInstigator = RequestedObject::Make(instigator);
+    request.Priority = priority;
+    Enqueue(MoveTemp(request));
+}
+
+AutoLinkPlacementBatch::RequestedObject AutoLinkPlacementBatch::RequestedObject::Make(const UObject* object)
+{
+    RequestedObject requested;
+    if (object)
+    {
+        // AllocateSerialNumber is the same thread-safe call weak pointers use to tell a reused slot from the original object
+        requested.Object = object;
+        requested.Index = GUObjectArray.ObjectToIndex(object);
+        requested.SerialNumber = GUObjectArray.AllocateSerialNumber(requested.Index);
+    }
+
+    return requested;
+}
+
+const UObject* AutoLinkPlacementBatch::RequestedObject::Resolve() const
+{
+    check(IsInGameThread());
+    if (!Object)
+    {
+        return nullptr;
+    }
+
+    auto item = GUObjectArray.IndexToObject(Index);
+    if (!item || item->Object != Object || item->GetSerialNumber() != SerialNumber || item->IsUnreachable())
+    {
+        return nullptr;
+    }
+
+    return IsValid(Object) ? Object : nullptr;
+}
+
+void AutoLinkPlacementBatch::Flush(UWorld* world)
+{
+    Drain();
+    if (Pending.IsEmpty())
+    {
+        return;
+    }
+
+    // Taken out first, since linking can build things of its own (like switch controls) whose hooks queue more. Requests in
+    // worlds that are gone are dropped.
+    TArray<LinkRequest> requests;
+    TArray<LinkRequest> otherWorldRequests;
+    for (auto& request : Pending)
+    {
+        if (request.World == world)
+        {
+            requests.Add(MoveTemp(request));
+        }
+        else if (request.World.IsValid())
+        {
+            otherWorldRequests.Add(MoveTemp(request));
+        }
+    }
+
+    Pending = MoveTemp(otherWorldRequests);
+
+    if (requests.IsEmpty())
+    {
+        return;
+    }
+
+    // Requests from different producers can come out of the queue in any order, so the timestamps put them back in order
+    requests.StableSort([](const LinkRequest& a, const LinkRequest& b)
+        {
+            return a.Priority != b.Priority ? a.Priority > b.Priority : a.Timestamp < b.Timestamp;
+        });
+
+    AL_LOG("AutoLinkPlacementBatch::Flush: Linking %d placements", requests.Num());
+    AutoLinkPassScope passScope(TEXT("AutoLinkPlacementBatch::Flush"), world);
+    AL_PASS_STAT_ADD(NumPlacements, requests.Num());
+    AL_PASS_STAT_ADD(NumDuplicatePlacements, NumFrameDuplicates);
+    for (auto& request : requests)
+    {
+        AL_LOG("AutoLinkPlacementBatch::Flush: Request from %s with priority %d, queued %.3f ms ago",
+            *GetNameSafe(request.Instigator.Get()),
+            (int32)request.Priority,
+            (FPlatformTime::Seconds() - request.Timestamp) * 1000);
+
+        if (request.bIsBlueprint)
+        {
+            // Children that are gone stay as null so the rest keep their place in the blueprint's manifest
+            TArray<AActor*> children;
+            children.Reserve(request.Actors.Num());
+            for (auto& child : request.Actors)
+            {
+                children.Add(child.Get());
+            }
+
+            LinkBlueprint(TEXT("AFGBlueprintHologram::Construct"), nullptr, children);
+        }
+        else if (auto buildable = Cast<AFGBuildable>(request.Actors[0].Get()))
+        {
+            UAutoLinkRootInstanceModule::FindAndLinkForBuildable(buildable);
+        }
+    }
+}
+
+void AutoLinkPlacementBatch::Enqueue(LinkRequest&& request)
+{
+    request.Timestamp = FPlatformTime::Seconds();
+    Incoming.Enqueue(MoveTemp(request));
+}
+
+void AutoLinkPlacementBatch::Drain()
+{
+    LinkRequest request;
+    while (Incoming.Dequeue(request))
+    {
+        if (request.RequestedBuildable.Object)
+        {
+            auto buildable = const_cast<AFGBuildable*>(Cast<AFGBuildable>(request.RequestedBuildable.Resolve()));
+            if (!buildable)
+            {
+                AL_LOG("AutoLinkPlacementBatch::Drain: Dropping a request for a buildable that is gone");
+                continue;
+            }
+
+            request.World = buildable->GetWorld();
+            request.Actors.Add(buildable);
+            request.Instigator = request.RequestedInstigator.Resolve();
+        }
+
+        if (!request.bIsSeen)
+        {
+            for (auto& actor : request.Actors)
+            {
+                if (!MarkSeen(actor.Get(), false))
+                {
+                    actor.Reset();
+                }
+            }
+        }
+
+        Pending.Add(MoveTemp(request));
+    }
+}
+
+bool AutoLinkPlacementBatch::MarkSeen(const AActor* actor, bool bCountDuplicate)
+{
+    if (!actor)
+    {
+        return false;
+    }
+
+    bool bIsAlreadySeen = false;
+    SeenThisFrame.Add(actor, &bIsAlreadySeen);
+    if (!bIsAlreadySeen)
+    {
+        return true;
+    }
+
+    AL_LOG("AutoLinkPlacementBatch::MarkSeen: %s was already seen this frame", *actor->GetName());
+    if (bCountDuplicate)
+    {
+        ++NumFrameDuplicates;
+        ++NumSessionDuplicates;
+    }
+
+    return false;
+}
+
+void AutoLinkPlacementBatch::EndFrame()
+{
+    if (NumFrameDuplicates > 0)
+    {
+        AL_LOG("AutoLinkPlacementBatch::EndFrame: %d placements this frame were of buildables already seen. Session: %d.", NumFrameDuplicates, NumSessionDuplicates);
+    }
+
+    SeenThisFrame.Reset();
+    NumFrameDuplicates = 0;
+}
+
+void AutoLinkPlacementBatch::LinkBlueprint(const TCHAR* source, const UObject* context, const TArray<AActor*>& children)
+{
+    AutoLinkPassScope passScope(source, context);
+
+    // Children link to each other, so the shadow engine has to know about all of them before the first one links
+    if (AutoLinkShadow::IsActive())
+    {
+        for (auto child : children)
+        {
+            if (auto buildable = Cast<AFGBuildable>(child))
+            {
+                AutoLinkConnectorIndex::EnsureBuilt(buildable->GetWorld());
+                AutoLinkConnectorIndex::AddBuildable(buildable);
+            }
+        }
+    }
+
+    UAutoLinkRootInstanceModule::FindAndLinkForChildren(children);
+}
@@ -1,9 +1,25 @@
 #include "AutoLinkRootInstanceModule.h"
 
+#include "AutoLinkAllocationCounter.h"
+#include "AutoLinkBlueprintManifest.h"
+#include "AutoLinkBlueprintPrefilter.h"
+#include "AutoLinkClassDispatch.h"
+#include "AutoLinkConsoleVariables.h"
+#include "AutoLinkCoreBridge.h"
 #include "AutoLinkDebugging.h"
 #include "AutoLinkDebugSettings.h"
+#include "AutoLinkDeferredLinks.h"
+#include "AutoLinkConnectorIndex.h"
+#include "AutoLinkConnectorTable.h"
+#include "AutoLinkHookRecorder.h"
 #include "AutoLinkLogCategory.h"
 #include "AutoLinkLogMacros.h"
+#include "AutoLinkPassStats.h"
+#include "AutoLinkPlacementBatch.h"
+#include "AutoLinkShadow.h"
+#include "AutoLinkSpeculativePlan.h"
+#include "AutoLinkUpgradeMap.h"
+#include "AutoLinkWorldAudit.h"
 
 #include "AbstractInstanceManager.h"
 #include "BlueprintHookManager.h"
@@ -40,6 +56,22 @@
 #include "Patching/NativeHookManager.h"
 #include "Tests/FGTestBlueprintFunctionLibrary.h"
 
+// Tells the index and the tools watching the hooks about a link that was just made
+static void NotifyLinked(const UActorComponent* connection, const UActorComponent* candidate)
+{
+    AutoLinkConnectorIndex::NoteLinked(connection, candidate);
+
+    if (AutoLinkHookRecorder::IsRecording())
+    {
+        AutoLinkHookRecorder::RecordLink(connection, candidate);
+    }
+
+    if (AutoLinkShadow::IsActive())
+    {
+        AutoLinkShadow::RecordLink(connection, candidate);
+    }
+}
+
 UAutoLinkRootInstanceModule::UAutoLinkRootInstanceModule()
 {
 }
@@ -85,23 +117,29 @@ void UAutoLinkRootInstanceModule::DispatchLifecycleEvent(ELifecyclePhase phase)
 
     AL_LOG("UAutoLinkRootInstanceModule: Hooking Mod Functions...");
 
+    SUBSCRIBE_METHOD_VIRTUAL_AFTER(AFGHologram::SetHologramLocationAndRotation, GetMutableDefault<AFGBlueprintHologram>(),
+        [](AFGHologram* hologram, const FHitResult& hitResult)
+        {
+            // Other holograms can share this implementation
+            if (hologram->IsA<AFGBlueprintHologram>())
+            {
+                AutoLinkSpeculativePlan::OnHologramMoved(hologram);
+            }
+        });
+
+    SUBSCRIBE_METHOD_VIRTUAL(AFGBlueprintHologram::Construct, GetMutableDefault<AFGBlueprintHologram>(),
+        [](auto& scope, AFGBlueprintHologram* hologram, TArray< AActor* >& out_children, FNetConstructionID NetConstructionID)
+        {
+            AutoLinkSpeculativePlan::BeginConstruct(hologram);
+        });
+
     SUBSCRIBE_METHOD_VIRTUAL_AFTER(AFGBlueprintHologram::Construct, GetMutableDefault<AFGBlueprintHologram>(),
         [](AActor* returnValue, AFGBlueprintHologram* hologram, TArray< AActor* >& out_children, FNetConstructionID NetConstructionID)
         {
             AL_LOG("AFGBlueprintHologram::Construct AFTER: The hologram is %s", *hologram->GetName());
 
-            for (auto child : out_children)
-            {
-                AL_LOG("AFGBlueprintHologram::Construct AFTER: Child %s (%s) at %s",
-                    *child->GetName(),
-                    *child->GetClass()->GetName(),
-                    *child->GetActorLocation().ToString());
-
-                if (auto buildable = Cast<AFGBuildable>(child))
-                {
-                    FindAndLinkForBuildable(buildable);
-                }
-            }
+            AutoLinkSpeculativePlan::EndConstruct(hologram, out_children);
+            AutoLinkPlacementBatch::AddBlueprint(hologram, out_children);
 
             AL_LOG("AFGBlueprintHologram::Construct AFTER: Return value %s (%s) at %s",
                 *returnValue->GetName(),
@@ -109,21 +147,41 @@ void UAutoLinkRootInstanceModule::DispatchLifecycleEvent(ELifecyclePhase phase)
                 *returnValue->GetActorLocation().ToString());
         });
 
-#define SHORT_CIRCUIT_TYPE( T )\
-    if (hologram->IsA(T::StaticClass())){ return;}
+    SUBSCRIBE_METHOD_AFTER(AFGBuildableSubsystem::AddBuildable,
+        [](AFGBuildableSubsystem* self, AFGBuildable* buildable)
+        {
+            // The first buildable added in a world (normally while it loads) builds the index for it, and after that this just
+            // adds to it. Lookups can then rule out scans without ever having to build it during a placement.
+            if (CVarAutoLinkOccupancyFilter.GetValueOnGameThread())
+            {
+                AutoLinkConnectorIndex::EnsureBuilt(self->GetWorld());
+            }
+
+            AutoLinkConnectorIndex::AddBuildable(buildable);
+            AutoLinkSpeculativePlan::NoteWorldChanged();
+        });
+
+    SUBSCRIBE_METHOD_AFTER(AFGBuildableSubsystem::RemoveBuildable,
+        [](AFGBuildableSubsystem* self, AFGBuildable* buildable)
+        {
+            AutoLinkConnectorIndex::RemoveBuildable(buildable);
+            AutoLinkSpeculativePlan::NoteWorldChanged();
+        });
 
     SUBSCRIBE_METHOD_VIRTUAL_AFTER(AFGBuildableHologram::ConfigureComponents, GetMutableDefault<AFGBuildableHologram>(),
         [](const AFGBuildableHologram* hologram, AFGBuildable* buildable)
         {
             // Short-circuit in this (the parent) ConfigureComponents for cases that are handled in child classes
-            SHORT_CIRCUIT_TYPE(AFGConveyorAttachmentHologram);
-            SHORT_CIRCUIT_TYPE(AFGPipeHyperAttachmentHologram);
-            SHORT_CIRCUIT_TYPE(AFGPipelineAttachmentHologram);
+            if (!AutoLinkClassDispatch::IsForBaseHook(hologram->GetClass()))
+            {
+                return;
+            }
+
             AL_LOG("AFGBuildableHologram::ConfigureComponents: The hologram is %s and buildable is %s at %s", *hologram->GetName(), *buildable->GetName(), *buildable->GetActorLocation().ToString());
 
-            FindAndLinkForBuildable(buildable);
+            AutoLinkUpgradeMap::Record(hologram, buildable);
+            AutoLinkPlacementBatch::AddBuildable(hologram, buildable);
         });
-#undef SHORT_CIRCUIT_TYPE
 
 #define SUBSCRIBE_CONFIGURE_COMPONENTS_BASE( T, PRE_CALL )\
     SUBSCRIBE_METHOD_VIRTUAL_AFTER(\
@@ -133,7 +191,8 @@ void UAutoLinkRootInstanceModule::DispatchLifecycleEvent(ELifecyclePhase phase)
         {\
             AL_LOG(#T "::ConfigureComponents: The hologram is %s and buildable is %s at %s", *hologram->GetName(), *buildable->GetName(), *buildable->GetActorLocation().ToString());\
             PRE_CALL;\
-            FindAndLinkForBuildable(buildable);\
+            AutoLinkUpgradeMap::Record(hologram, buildable);\
+            AutoLinkPlacementBatch::AddBuildable(hologram, buildable);\
         });
 
 #define SUBSCRIBE_CONFIGURE_COMPONENTS( T ) SUBSCRIBE_CONFIGURE_COMPONENTS_BASE( T, {} )
@@ -162,6 +221,9 @@ void UAutoLinkRootInstanceModule::DispatchLifecycleEvent(ELifecyclePhase phase)
 
 #undef SUBSCRIBE_CONFIGURE_COMPONENTS
 
+    AutoLinkPlacementBatch::Initialize();
+    AutoLinkWorldAudit::Initialize();
+
     Super::DispatchLifecycleEvent(phase);
 }
 
@@ -212,7 +274,16 @@ bool UAutoLinkRootInstanceModule::ShouldTryToAutoLink(AFGBuildable* buildable)
 
 void UAutoLinkRootInstanceModule::FindAndLinkForBuildable(AFGBuildable* buildable)
 {
-    if (!ShouldTryToAutoLink(buildable))
+    AutoLinkPassScope passScope(TEXT("FindAndLinkForBuildable"), buildable);
+    AutoLinkRecordBuildableScope recordScope(buildable);
+    if (auto passStats = AutoLinkPassScope::GetActiveStats())
+    {
+        ++passStats->NumBuildables;
+        passStats->AddClass(buildable->GetClass());
+    }
+
+    const uint8 connectorKinds = AutoLinkClassDispatch::GetConnectorKinds(buildable);
+    if (!connectorKinds)
     {
         AL_LOG("FindAndLinkForBuildable: Buildable %s of type %s is not linkable!", *buildable->GetName(), *buildable->GetClass()->GetName());
         return;
@@ -220,11 +291,17 @@ void UAutoLinkRootInstanceModule::FindAndLinkForBuildable(AFGBuildable* buildabl
 
     AL_LOG("FindAndLinkForBuildable: Buildable is %s of type %s", *buildable->GetName(), *buildable->GetClass()->GetName());
 
+    AutoLinkShadowBuildableScope shadowScope(buildable);
+    AutoLinkUpgradeScope upgradeScope(buildable);
+
     // Belt connections
+    if (connectorKinds & (1 << (uint8)AutoLinkCore::ConnectorKind::Belt))
     {
+        AutoLinkPhaseScope phaseScope(EAutoLinkConnectorKind::Belt);
         TInlineComponentArray<UFGFactoryConnectionComponent*> openConnections;
         FindOpenBeltConnections(openConnections, buildable);
         AL_LOG("FindAndLinkForBuildable: Found %d open belt connections", openConnections.Num());
+        AL_PASS_STAT_ADD(NumOpenConnectors[(int32)EAutoLinkConnectorKind::Belt], openConnections.Num());
         for (auto connection : openConnections)
         {
             FindAndLinkCompatibleBeltConnection(connection);
@@ -232,10 +309,13 @@ void UAutoLinkRootInstanceModule::FindAndLinkForBuildable(AFGBuildable* buildabl
     }
 
     // Railroad connections
+    if (connectorKinds & (1 << (uint8)AutoLinkCore::ConnectorKind::Railroad))
     {
+        AutoLinkPhaseScope phaseScope(EAutoLinkConnectorKind::Railroad);
         TInlineComponentArray<AutoLinkRailConnectionData> openConnections;
         FindOpenRailroadConnections(openConnections, buildable);
         AL_LOG("FindAndLinkForBuildable: Found %d open railroad connections", openConnections.Num());
+        AL_PASS_STAT_ADD(NumOpenConnectors[(int32)EAutoLinkConnectorKind::Railroad], openConnections.Num());
         for (auto connection : openConnections)
         {
             FindAndLinkCompatibleRailroadConnection(connection);
@@ -243,10 +323,13 @@ void UAutoLinkRootInstanceModule::FindAndLinkForBuildable(AFGBuildable* buildabl
     }
 
     // Pipe connections
+    if (connectorKinds & (1 << (uint8)AutoLinkCore::ConnectorKind::Fluid))
     {
+        AutoLinkPhaseScope phaseScope(EAutoLinkConnectorKind::Fluid);
+
         // The base game has no way to directly link pipe junctions to pipe junctions. To preserve this,
         // we do not allow pipe junctions to autolink to pipe junctions, though they seem to work.
-        TArray<UClass*> incompatibleFluidClasses = TArray<UClass*>();
+        AutoLinkScratchArray<UClass*> incompatibleFluidClasses;
         if (buildable->IsA(AFGBuildablePipelineJunction::StaticClass()))
         {
             incompatibleFluidClasses.Add(AFGBuildablePipelineJunction::StaticClass());
@@ -255,7 +338,8 @@ void UAutoLinkRootInstanceModule::FindAndLinkForBuildable(AFGBuildable* buildabl
         TInlineComponentArray<TPair<UFGPipeConnectionComponent*, IFGFluidIntegrantInterface*>> openConnectionsAndIntegrants;
         FindOpenFluidConnections(openConnectionsAndIntegrants, buildable);
         AL_LOG("FindAndLinkForBuildable: Found %d open fluid connections", openConnectionsAndIntegrants.Num());
-        TSet< IFGFluidIntegrantInterface* > integrantsToRegister;
+        AL_PASS_STAT_ADD(NumOpenConnectors[(int32)EAutoLinkConnectorKind::Fluid], openConnectionsAndIntegrants.Num());
+        AutoLinkScratchSet<IFGFluidIntegrantInterface*> integrantsToRegister;
         for (auto& connectionAndIntegrant : openConnectionsAndIntegrants)
         {
             auto connection = connectionAndIntegrant.Key;
@@ -273,24 +357,17 @@ void UAutoLinkRootInstanceModule::FindAndLinkForBuildable(AFGBuildable* buildabl
             }
         }
 
-        // Don't register fluid integrants if we're inside a blueprint designer
-        if ( !buildable->GetBlueprintDesigner() && integrantsToRegister.Num() > 0)
-        {
-            AL_LOG("FindAndLinkForBuildable: Found connections have a total of %d integrants to register", integrantsToRegister.Num());
-            auto pipeSubsystem = AFGPipeSubsystem::GetPipeSubsystem(buildable->GetWorld());
-            for (auto integrant : integrantsToRegister)
-            {
-                AL_LOG("FindAndLinkForBuildable: Registering fluid integrant %s", *AutoLinkDebugging::GetFluidIntegrantName(integrant));
-                pipeSubsystem->RegisterFluidIntegrant(integrant);
-            }
-        }
+        RegisterFluidIntegrants(buildable, integrantsToRegister);
     }
 
     // Hypertube connections
+    if (connectorKinds & (1 << (uint8)AutoLinkCore::ConnectorKind::Hyper))
     {
+        AutoLinkPhaseScope phaseScope(EAutoLinkConnectorKind::Hyper);
         TInlineComponentArray<UFGPipeConnectionComponentHyper*> openConnections;
         FindOpenHyperConnections(openConnections, buildable);
         AL_LOG("FindAndLinkForBuildable: Found %d open hyper connections", openConnections.Num());
+        AL_PASS_STAT_ADD(NumOpenConnectors[(int32)EAutoLinkConnectorKind::Hyper], openConnections.Num());
         for (auto connection : openConnections)
         {
             FindAndLinkCompatibleHyperConnection(connection);
@@ -298,6 +375,32 @@ void UAutoLinkRootInstanceModule::FindAndLinkForBuildable(AFGBuildable* buildabl
     }
 }
 
+void UAutoLinkRootInstanceModule::FindAndLinkForChildren(const TArray<AActor*>& children)
+{
+    const auto manifest = AutoLinkBlueprintManifest::Get(children);
+    AutoLinkBlueprintPrefilterScope prefilterScope(children, *manifest);
+    AutoLinkSpeculativePlanScope planScope(children, manifest);
+    for (int32 i = 0; i < children.Num(); ++i)
+    {
+        auto child = children[i];
+        if (!manifest->HasOpenConnectors(i))
+        {
+            AL_PASS_STAT_ADD(NumSkippedChildren, 1);
+            continue;
+        }
+
+        AL_LOG("FindAndLinkForChildren: Child %s (%s) at %s",
+            *child->GetName(),
+            *child->GetClass()->GetName(),
+            *child->GetActorLocation().ToString());
+
+        if (auto buildable = Cast<AFGBuildable>(child))
+        {
+            FindAndLinkForBuildable(buildable);
+        }
+    }
+}
+
 void UAutoLinkRootInstanceModule::AddIfCandidate(TInlineComponentArray<UFGFactoryConnectionComponent*>& openConnections, UFGFactoryConnectionComponent* connection)
 {
     if (!connection)
@@ -404,6 +507,21 @@ void UAutoLinkRootInstanceModule::AddIfCandidate(
     }
 }
 
+void UAutoLinkRootInstanceModule::RegisterFluidIntegrants(AFGBuildable* buildable, const AutoLinkScratchSet<IFGFluidIntegrantInterface*>& integrants)
+{
+    // Don't register fluid integrants if we're inside a blueprint designer
+    if ( !buildable->GetBlueprintDesigner() && integrants.Num() > 0)
+    {
+        AL_LOG("RegisterFluidIntegrants: Found connections have a total of %d integrants to register", integrants.Num());
+        auto pipeSubsystem = AFGPipeSubsystem::GetPipeSubsystem(buildable->GetWorld());
+        for (auto integrant : integrants)
+        {
+            AL_LOG("RegisterFluidIntegrants: Registering fluid integrant %s", *AutoLinkDebugging::GetFluidIntegrantName(integrant));
+            pipeSubsystem->RegisterFluidIntegrant(integrant);
+        }
+    }
+}
+
 void UAutoLinkRootInstanceModule::FindOpenFluidConnections(
     TInlineComponentArray<TPair<UFGPipeConnectionComponent*,IFGFluidIntegrantInterface*>>& openConnectionsAndIntegrants,
     AFGBuildable* buildable)
@@ -554,24 +672,79 @@ void UAutoLinkRootInstanceModule::FindOpenRailroadConnections(TInlineComponentAr
     }
 }
 
-void UAutoLinkRootInstanceModule::HitScan(
-    TArray<AActor*>& actors,
+bool UAutoLinkRootInstanceModule::CanSkipScan(const FVector& location, AutoLinkCore::ConnectorKind kind, const AActor* owner)
+{
+    if (!CVarAutoLinkOccupancyFilter.GetValueOnGameThread() || AutoLinkBlueprintPrefilterScope::IsActive())
+    {
+        return false;
+    }
+
+    if (AutoLinkConnectorIndex::MayHaveOpenConnectorNear(AutoLinkCoreBridge::ToCore(location), kind, owner))
+    {
+        return false;
+    }
+
+    AL_LOG("CanSkipScan: No open connector of kind %d near %s", (int32)kind, *location.ToString());
+    AL_PASS_STAT_ADD(NumSkippedScans, 1);
+    return true;
+}
+
+bool UAutoLinkRootInstanceModule::HitScan(
+    AutoLinkScratchArray<AActor*>& actors,
     UWorld* world,
     FVector scanStart,
     FVector scanEnd,
+    const UActorComponent* connectionComponent,
     AActor* ignoreActor)
 {
     AL_LOG("HitScan: Scanning from %s to %s", *scanStart.ToString(), *scanEnd.ToString());
+    if (AutoLinkBlueprintPrefilterScope::IsInternalOnly())
+    {
+        AutoLinkBlueprintPrefilterScope::FindNearbyChildren(scanStart, ignoreActor, actors);
+        AL_PASS_STAT_ADD(NumPrefilteredScans, 1);
+        AL_PASS_STAT_ADD(NumHitActors, actors.Num());
+        return false;
+    }
 
-    TArray< FHitResult > hitResults;
-    auto collisionQueryParams = FCollisionQueryParams();
-    collisionQueryParams.AddIgnoredActor(ignoreActor);
-    world->LineTraceMultiByObjectType(
-        hitResults,
-        scanStart,
-        scanEnd,
-        FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllStaticObjects),
-        collisionQueryParams);
+    if (AutoLinkSpeculativePlan::FindPlannedActors(scanStart, ignoreActor, actors))
+    {
+        AL_PASS_STAT_ADD(NumPlannedScans, 1);
+        AL_PASS_STAT_ADD(NumHitActors, actors.Num());
+        return false;
+    }
+
+    if (bAreScanGuessesAllowed && AutoLinkUpgradeMap::FindPartnerActors(scanStart, ignoreActor, actors))
+    {
+        AL_PASS_STAT_ADD(NumUpgradeScans, 1);
+        AL_PASS_STAT_ADD(NumHitActors, actors.Num());
+        return true;
+    }
+
+    // Whatever was linked to something dismantled here goes first. The scene is only skipped when one that could link is right
+    // here, and is still asked if that one doesn't link after all.
+    if (bAreScanGuessesAllowed && AutoLinkConnectorIndex::FindFreedNear(connectionComponent, scanStart, ignoreActor, actors))
+    {
+        AL_PASS_STAT_ADD(NumFreedScans, 1);
+        AL_PASS_STAT_ADD(NumHitActors, actors.Num());
+        return true;
+    }
+
+    AL_PASS_STAT_ADD(NumHitScans, 1);
+
+    // The query API only takes heap arrays, so this one is kept and reused rather than being pass scratch. Game thread only.
+    static TArray< FHitResult > hitResults;
+    hitResults.Reset();
+    {
+        AutoLinkUncountedAllocationsScope uncountedScope;
+        auto collisionQueryParams = FCollisionQueryParams();
+        collisionQueryParams.AddIgnoredActor(ignoreActor);
+        world->LineTraceMultiByObjectType(
+            hitResults,
+            scanStart,
+            scanEnd,
+            FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllStaticObjects),
+            collisionQueryParams);
+    }
 
     for (const FHitResult& result : hitResults)
     {
@@ -596,27 +769,68 @@ void UAutoLinkRootInstanceModule::HitScan(
 
         actors.AddUnique(actor);
     }
+
+    AL_PASS_STAT_ADD(NumHitActors, actors.Num());
+    return false;
 }
 
-void UAutoLinkRootInstanceModule::OverlapScan(
-    TArray<AActor*>& actors,
+bool UAutoLinkRootInstanceModule::OverlapScan(
+    AutoLinkScratchArray<AActor*>& actors,
     UWorld* world,
     FVector scanStart,
     float radius,
+    const UActorComponent* connectionComponent,
     AActor* ignoreActor)
 {
     AL_LOG("OverlapScan: Scanning from %s with radius %f", *scanStart.ToString(), radius);
+    if (AutoLinkBlueprintPrefilterScope::IsInternalOnly())
+    {
+        AutoLinkBlueprintPrefilterScope::FindNearbyChildren(scanStart, ignoreActor, actors);
+        AL_PASS_STAT_ADD(NumPrefilteredScans, 1);
+        AL_PASS_STAT_ADD(NumHitActors, actors.Num());
+        return false;
+    }
+
+    if (AutoLinkSpeculativePlan::FindPlannedActors(scanStart, ignoreActor, actors))
+    {
+        AL_PASS_STAT_ADD(NumPlannedScans, 1);
+        AL_PASS_STAT_ADD(NumHitActors, actors.Num());
+        return false;
+    }
+
+    if (bAreScanGuessesAllowed && AutoLinkUpgradeMap::FindPartnerActors(scanStart, ignoreActor, actors))
+    {
+        AL_PASS_STAT_ADD(NumUpgradeScans, 1);
+        AL_PASS_STAT_ADD(NumHitActors, actors.Num());
+        return true;
+    }
+
+    // Whatever was linked to something dismantled here goes first. The scene is only skipped when one that could link is right
+    // here, and is still asked if that one doesn't link after all.
+    if (bAreScanGuessesAllowed && AutoLinkConnectorIndex::FindFreedNear(connectionComponent, scanStart, ignoreActor, actors))
+    {
+        AL_PASS_STAT_ADD(NumFreedScans, 1);
+        AL_PASS_STAT_ADD(NumHitActors, actors.Num());
+        return true;
+    }
 
-    TArray< FOverlapResult > overlapResults;
-    auto collisionQueryParams = FCollisionQueryParams();
-    collisionQueryParams.AddIgnoredActor(ignoreActor);
-    world->OverlapMultiByObjectType(
-        overlapResults,
-        scanStart,
-        FQuat::Identity,
-        FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllStaticObjects),
-        FCollisionShape::MakeSphere(radius),
-        collisionQueryParams);
+    AL_PASS_STAT_ADD(NumOverlapScans, 1);
+
+    // Same as in HitScan
+    static TArray< FOverlapResult > overlapResults;
+    overlapResults.Reset();
+    {
+        AutoLinkUncountedAllocationsScope uncountedScope;
+        auto collisionQueryParams = FCollisionQueryParams();
+        collisionQueryParams.AddIgnoredActor(ignoreActor);
+        world->OverlapMultiByObjectType(
+            overlapResults,
+            scanStart,
+            FQuat::Identity,
+            FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllStaticObjects),
+            FCollisionShape::MakeSphere(radius),
+            collisionQueryParams);
+    }
 
     for (const FOverlapResult& result : overlapResults)
     {
@@ -641,66 +855,58 @@ void UAutoLinkRootInstanceModule::OverlapScan(
 
         actors.AddUnique(actor);
     }
+
+    AL_PASS_STAT_ADD(NumHitActors, actors.Num());
+    return false;
 }
 
 void UAutoLinkRootInstanceModule::FindAndLinkCompatibleBeltConnection(UFGFactoryConnectionComponent* connectionComponent)
 {
-    if (connectionComponent->IsConnected())
+    auto& table = AutoLinkConnectorTable::Get();
+    const int32 connectorRow = table.Capture(connectionComponent);
+    if (!table.IsOpen(connectorRow))
     {
         AL_LOG("FindAndLinkCompatibleBeltConnection: Exiting because the connection component is already connected");
         return;
     }
 
-    // Belts need to be right up against the connectors, but conveyor lifts have some other cases that we will address
-    float searchDistance;
-    auto outerBuildable = connectionComponent->GetOuterBuildable();
-    auto connectionConveyorBelt = Cast<AFGBuildableConveyorBelt>(outerBuildable);
-    AFGBuildableConveyorLift* connectionConveyorLift = nullptr;
-    if (connectionConveyorBelt)
+    if (CanSkipScan(table.GetLocation(connectorRow), AutoLinkCore::ConnectorKind::Belt, connectionComponent->GetOwner()))
     {
-        // If this is a belt then it in needs to be against the connector, but search
-        // a little bit outward to be sure we hit any buildable containing a connector
-        searchDistance = 20.0;
-    }
-    else if ((connectionConveyorLift = Cast<AFGBuildableConveyorLift>(outerBuildable)) != nullptr)
-    {
-        // If this is a conveyor lift, then there could be another conveyor lift facing it.
-        // Conveyor lifts can directly connect with their connectors at 400 units away,
-        // so we have that distance plus a bit to ensure we hit the buildable
-        searchDistance = 420.0;
-    }
-    else
-    {
-        // If this is a normal factory/buildable, it could still be aligned with a fully-extended
-        // conveyor lift and we still pad a bit to ensure an appropriate hit
-        searchDistance = 320.0;
+        return;
     }
 
-    auto connectorLocation = connectionComponent->GetConnectorLocation();
-    auto searchEnd = connectorLocation + (connectionComponent->GetConnectorNormal() * searchDistance);
-    auto connectionDirection = connectionComponent->GetDirection();
+    // Belts need to be right up against the connectors, but conveyor lifts have some other cases that the core rules address
+    auto outerBuildable = connectionComponent->GetOuterBuildable();
+    const auto coreConnector = table.GetConnector(connectorRow);
+    const float searchDistance = AutoLinkCore::GetBeltSearchDistance(coreConnector.OwnerFlags);
+
+    auto connectorLocation = table.GetLocation(connectorRow);
+    auto searchEnd = connectorLocation + (table.GetNormal(connectorRow) * searchDistance);
+    auto connectionDirection = coreConnector.Direction;
 
     AL_LOG("FindAndLinkCompatibleBeltConnection: Connector at: %s, direction is: %d",
         *connectorLocation.ToString(),
         connectionDirection);
 
-    TArray< AActor* > hitActors;
-    HitScan(
+    AutoLinkScratchArray<AActor*> hitActors;
+    const bool bIsGuess = HitScan(
         hitActors,
         connectionComponent->GetWorld(),
         connectorLocation,
         searchEnd,
+        connectionComponent,
         outerBuildable);
 
     // 12 is a random guess of the max possible candidates we could ever really see
     TArray<UFGFactoryConnectionComponent*, TInlineAllocator<12>> candidates;
+    const bool bIsDeferringAttachmentLinks = CVarAutoLinkAttachmentLinks.GetValueOnGameThread();
     for (auto hitActor : hitActors)
     {
         if (auto hitConveyor = Cast<AFGBuildableConveyorBase>(hitActor))
         {
             // We always consider conveyors as candidates and we can get their candidate connection faster than searching all their components
             AL_LOG("FindAndLinkCompatibleBeltConnection: Hit result is conveyor %s of type %s", *hitConveyor->GetName(), *hitConveyor->GetClass()->GetName());
-            auto candidateConnection = connectionDirection == EFactoryConnectionDirection::FCD_INPUT
+            auto candidateConnection = connectionDirection == AutoLinkCore::ConnectorDirection::Input
                 ? hitConveyor->GetConnection1()
                 : hitConveyor->GetConnection0();
 
@@ -708,10 +914,10 @@ void UAutoLinkRootInstanceModule::FindAndLinkCompatibleBeltConnection(UFGFactory
             continue;
         }
 
-        // If we are NOT a conveyor (either a belt or a lift), then we shouldn't consider non-conveyors for attachment.  Autolinking between attachments
-        // or attachments and buildings causes crashes in the base game's multithreaded code.  We just checked whether this candidate is a conveyor so
+        // If we are NOT a conveyor (either a belt or a lift), then non-conveyors can only be linked to us at the end of the tick. Autolinking between
+        // attachments or attachments and buildings in the middle of it causes crashes in the base game's multithreaded code, so without deferred links
         // nothing else can be a valid candidate unless we are a conveyor.
-        if (!connectionConveyorBelt && !connectionConveyorLift)
+        if (!coreConnector.IsOnConveyor() && !bIsDeferringAttachmentLinks)
         {
             AL_LOG("FindAndLinkCompatibleBeltConnection: NOT considering hit result actor %s of type %s because Connector is not on a conveyor", *hitActor->GetName(), *hitActor->GetClass()->GetName());
             continue;
@@ -735,233 +941,101 @@ void UAutoLinkRootInstanceModule::FindAndLinkCompatibleBeltConnection(UFGFactory
         }
     }
 
-    float closestDistance = FLT_MAX;
-    UFGFactoryConnectionComponent* compatibleConnectionComponent = nullptr;
-    for (auto& candidateConnection : candidates)
+    AL_PASS_STAT_ADD(NumCandidates, candidates.Num());
+    if (AutoLinkHookRecorder::IsRecording())
     {
-        AL_LOG("FindAndLinkCompatibleBeltConnection: Examining connection: %s on %s.",
-            *candidateConnection->GetName(),
-            *candidateConnection->GetOuterBuildable()->GetName());
+        AutoLinkHookRecorder::RecordCandidates(connectionComponent, coreConnector, candidates);
+    }
 
+    float closestDistance = FLT_MAX;
+    int32 compatibleRow = INDEX_NONE;
+    for (auto candidateConnection : candidates)
+    {
         if (!IsValid(candidateConnection))
         {
-            AL_LOG("FindAndLinkCompatibleBeltConnection:\tNot valid!");
+            AL_LOG("FindAndLinkCompatibleBeltConnection: Candidate is not valid!");
             continue;
         }
 
-        if (candidateConnection->IsConnected())
+        AL_LOG("FindAndLinkCompatibleBeltConnection: Examining connection: %s on %s.",
+            *candidateConnection->GetName(),
+            *candidateConnection->GetOuterBuildable()->GetName());
+
+        const int32 candidateRow = table.Capture(candidateConnection);
+        if (!table.IsOpen(candidateRow))
         {
             AL_LOG("FindAndLinkCompatibleBeltConnection:\tAlready connected!");
             continue;
         }
 
-        if (!candidateConnection->CanConnectTo(connectionComponent))
+        if (!AutoLinkCore::AreBeltDirectionsCompatible(table.Directions[candidateRow], connectionDirection))
         {
-            AL_LOG("FindAndLinkCompatibleBeltConnection:\tCannot be connected to this!");
+            AL_LOG("FindAndLinkCompatibleBeltConnection:\tDirection %d cannot be connected to this!", table.Directions[candidateRow]);
             continue;
         }
 
-        // Now that the quickest checks are done, check distance
-        // These are offsets where negative is behind the connector (against the normal) and positive is in front (with the normal).
-        auto minConnectorOffset = 0.0f;
-        auto maxConnectorOffset = 0.0f;
+        // Now that the quickest checks are done, check the offsets and alignment
+        const auto coreCandidate = table.GetConnector(candidateRow);
 
-        auto candidateOuterBuildable = candidateConnection->GetOuterBuildable();
-        auto candidateConveyorBelt = Cast<AFGBuildableConveyorBelt>(candidateOuterBuildable);
-        auto candidateConveyorLift = Cast<AFGBuildableConveyorLift>(candidateOuterBuildable);
+        AL_LOG("FindAndLinkCompatibleBeltConnection:\tConnector at %s with normal %s, candidate at %s with normal %s. Min offset: %f. Max offset: %f",
+            *connectorLocation.ToString(),
+            *table.GetNormal(connectorRow).ToString(),
+            *table.GetLocation(candidateRow).ToString(),
+            *table.GetNormal(candidateRow).ToString(),
+            AutoLinkCore::ComputeBeltOffsetWindow(coreConnector, coreCandidate).MinOffset,
+            AutoLinkCore::ComputeBeltOffsetWindow(coreConnector, coreCandidate).MaxOffset);
 
-        if (connectionConveyorBelt || candidateConveyorBelt)
-        {
-            if (connectionConveyorLift || candidateConveyorLift)
-            {
-                // If it's a belt to conveyor lift, we allow the same distance that the lifts can extend to connect when building them normally
-                maxConnectorOffset = 200.0;
-                AL_LOG("FindAndLinkCompatibleBeltConnection:\tBelt to conveyor lift. Setting max offset to %f.", maxConnectorOffset);
-            }
-            else
-            {
-                // If a belt to a non-lift, leave the offsets at 0, since belts have to be up against the connector
-                // (unless a storage container or dimensional depot are involved, but we handle those later).
-                AL_LOG("FindAndLinkCompatibleBeltConnection:\tBelt to non-lift. Leaving offsets at 0 for now.");
-            }
-        }
-        else if (connectionConveyorLift || candidateConveyorLift)
+        double fromCandidateToConnectorDistance;
+        auto candidateResult = AutoLinkCore::EvaluateBeltCandidate(coreConnector, coreCandidate, fromCandidateToConnectorDistance);
+        if (candidateResult != AutoLinkCore::BeltCandidateResult::Compatible)
         {
-            AL_LOG("FindAndLinkCompatibleBeltConnection:\tAt least one conveyor lift is involved.");
-
-            if (candidateOuterBuildable->IsA(AFGBuildableConveyorAttachment::StaticClass()) || candidateOuterBuildable->IsA(AFGBuildableConveyorAttachment::StaticClass()))
-            {
-                minConnectorOffset = 0; // Lifts are allowed to clip all the way into splitters/mergers
-            }
-            else
-            {
-                minConnectorOffset = 100.0; // But they cannot clip all the way into other factory buildings
-            }
-
-            // Two conveyor lifts can directly connect 400 units away. There are ways to make it look like two
-            // fully-extended lifts are attached at 300 units each (600 total) but the game will shrink the
-            // bellows to 200 units each on reload, even if we AutoLink them - the bellows only seem to extend
-            // into buildings. If it's just one conveyor lift, then we're either scanning to/from a building and
-            // those connectors can be at-most 300 units away as the bellows will fully extend for them.
-            maxConnectorOffset = connectionConveyorLift && candidateConveyorLift ? 400.0 : 300.0;
+            AL_LOG("FindAndLinkCompatibleBeltConnection:\tCandidate is not compatible: %s", ANSI_TO_TCHAR(AutoLinkCore::ToString(candidateResult)));
+            continue;
         }
 
-        // Dimensional depot input connectors are 10 units deeper than storage container input connectors. This misalignment
-        // means replacing a storage container with a dimensional depot (or vice versa) doesn't naturally autolink, which is
-        // confusing since it's intuitive to swap one for the other at different points. Since there's a glow around the depot
-        // connector that hides any small gap, we can compensate with offset tolerances and it won't look weird, whether the
-        // belt ends in a dim depot glow or extends into the storage container an extra 10 units.
-        if (connectionDirection == EFactoryConnectionDirection::FCD_INPUT && (candidateConveyorBelt || candidateConveyorLift))
+        if (fromCandidateToConnectorDistance >= closestDistance)
         {
-            if (outerBuildable->IsA(AFGCentralStorageContainer::StaticClass()))
-            {
-                maxConnectorOffset += 10.0f;
-                AL_LOG("FindAndLinkCompatibleBeltConnection:\tDimensional depot to conveyor. Setting max connector offset to %f to handle alignment issues.", maxConnectorOffset);
-            }
-            else if (outerBuildable->IsA(AFGBuildableStorage::StaticClass()))
-            {
-                minConnectorOffset -= 10.0f;
-                AL_LOG("FindAndLinkCompatibleBeltConnection:\tStorage container to conveyor. Setting min connector offset to %f to handle alignment issues.", minConnectorOffset);
-            }
-        }
-        else if (connectionDirection == EFactoryConnectionDirection::FCD_OUTPUT && (connectionConveyorBelt || connectionConveyorLift))
-        {
-            if (candidateOuterBuildable->IsA(AFGCentralStorageContainer::StaticClass()))
-            {
-                maxConnectorOffset += 10.0f;
-                AL_LOG("FindAndLinkCompatibleBeltConnection:\tConveyor to dimensional depot. Setting max connector offset to %f to handle alignment issues.", maxConnectorOffset);
-            }
-            else if (candidateOuterBuildable->IsA(AFGBuildableStorage::StaticClass()))
-            {
-                minConnectorOffset -= 10.0f;
-                AL_LOG("FindAndLinkCompatibleBeltConnection:\tConveyor to storage container. Settings min connector offset to %f to handle alignment issues.", minConnectorOffset);
-            }
+            continue;
         }
 
-        AL_LOG("FindAndLinkCompatibleBeltConnection:\tFinal offsets . Min offset: %f. Max offset: %f", minConnectorOffset, maxConnectorOffset);
-
-        if (minConnectorOffset > maxConnectorOffset)
+        // The game's own check goes last since it means calling into the component, and few candidates get this far
+        if (!candidateConnection->CanConnectTo(connectionComponent))
         {
-            AL_LOG("FindAndLinkCompatibleBeltConnection:\tMin offset %f is greater than Max offset %f? Would be great to get a reproduction of how this could happen... skipping this candidate", minConnectorOffset, maxConnectorOffset);
+            AL_LOG("FindAndLinkCompatibleBeltConnection:\tCannot be connected to this!");
             continue;
         }
 
-        const FVector candidateConnectorLocation = candidateConnection->GetConnectorLocation();
-        // This gives the vector from the candidate connection to the main connector, which is useful to know where the connectors are in space relative to each other.
-        // With simple vector operations on just the connector normals, they could theoretically point "against" each other but be on opposite sides of the map. Using
-        // the vector between the connector and the candidate lets us determine their distance and whether the connectors are overlapping.
-        FVector fromCandidateToConnectorVector = connectorLocation - candidateConnectorLocation; 
-
-        AL_LOG("FindAndLinkCompatibleBeltConnection:\tConnector Location %s, Candidate Location: %s, Candidate to Connector Vector: %s",
-            *connectorLocation.ToString(),
-            *candidateConnectorLocation.ToString(),
-            *fromCandidateToConnectorVector.ToString());
-
-        const FVector connectorNormal = connectionComponent->GetConnectorNormal();
-        const FVector candidateConnectorNormal = candidateConnection->GetConnectorNormal();
-
-        AL_LOG("FindAndLinkCompatibleBeltConnection:\tConnector normal: %s, Candidate normal: %s",
-            *connectorNormal.ToString(),
-            *candidateConnectorNormal.ToString());
+        AL_LOG("FindAndLinkCompatibleBeltConnection:\tFound a new closest one (%f) at: %s", fromCandidateToConnectorDistance, *table.GetLocation(candidateRow).ToString());
+        closestDistance = fromCandidateToConnectorDistance;
+        compatibleRow = candidateRow;
 
-        double fromCandidateToConnectorDistance;
-        if (fromCandidateToConnectorVector.IsNearlyZero(1)) // Treat a distance within 1 cm as touching
+        if (closestDistance < 1)
         {
-            if (minConnectorOffset > 0 || maxConnectorOffset < 0)
-            {
-                AL_LOG("FindAndLinkCompatibleBeltConnection:\tConnectors are touching but this is not allowed per the connector offset limits!");
-                continue;
-            }
-
-            AL_LOG("FindAndLinkCompatibleBeltConnection:\tUnitVectorsArePointingInOppositeDirections: %d", UnitVectorsArePointingInOppositeDirections(connectorNormal, candidateConnectorNormal, .015));
-
-            // If the connectors are touching and 0 is an allowed distance, then check whether they are facing each other.
-            if (!FVector::PointsAreNear(connectorNormal, -candidateConnectorNormal, .1)) // Allow a little floating point precision error
-            {
-                AL_LOG("FindAndLinkCompatibleBeltConnection:\tConnectors are touching but not pointed in opposite directions!");
-                continue;
-            }
-
-            fromCandidateToConnectorDistance = 0;
-        }
-        else if (minConnectorOffset == 0 && maxConnectorOffset == 0)
-        {
-            AL_LOG("FindAndLinkCompatibleBeltConnection:\tConnectors are not touching but min and max offset are both 0!");
-            continue;
+            AL_LOG("FindAndLinkCompatibleBeltConnection:\tFound extremely close candidate (%f units away). Taking it as the best.", closestDistance);
+            break;
         }
-        else
-        {
-            // Connectors are some distance from each other and min/max offsets allow some distance - now we figure out if they match
-            FVector fromCandidateToConnectorNormal;
-            fromCandidateToConnectorVector.ToDirectionAndLength(fromCandidateToConnectorNormal, fromCandidateToConnectorDistance);
-
-            AL_LOG("FindAndLinkCompatibleBeltConnection:\tCandidate Distance: %f, Candidate to connector normal: %s",
-                fromCandidateToConnectorDistance,
-                *fromCandidateToConnectorNormal.ToString());
-
-            const int ConnectorOffsetPadding = 1; // Padding to allow for floating point issues and ever-so-slightly angled connectors
-            const double CosineTolerance = .001; // Equates to 2.563 degrees of tolerance, which is around the limit of the angle at which conveyor lifts will naturally snap to connections, from in-game testing
-
-            if (UnitVectorsArePointingInOppositeDirections(connectorNormal, fromCandidateToConnectorNormal, CosineTolerance) // Connector normal points at candidate
-                &&
-                UnitVectorsArePointingInOppositeDirections(candidateConnectorNormal, -fromCandidateToConnectorNormal, CosineTolerance)) // Candidate normal points at connector
-            {
-                // They are aligned, pointing at each other, and the candidate is at a positive offset, so check against allowed positive offsets
-
-                if (maxConnectorOffset <= 0 || fromCandidateToConnectorDistance > maxConnectorOffset + ConnectorOffsetPadding)
-                {
-                    AL_LOG("FindAndLinkCompatibleBeltConnection:\tCandidate offset (%f) is outside of the max connector offset (%f)!", fromCandidateToConnectorDistance, maxConnectorOffset);
-                    continue;
-                }
-                else if (minConnectorOffset >= 0 && fromCandidateToConnectorDistance < minConnectorOffset - ConnectorOffsetPadding)
-                {
-                    AL_LOG("FindAndLinkCompatibleBeltConnection:\tCandidate offset (%f) is outside of the min connector offset (%f)!", fromCandidateToConnectorDistance, minConnectorOffset);
-                    continue;
-                }
-            }
-            else if (
-                UnitVectorsArePointingInOppositeDirections(connectorNormal, -fromCandidateToConnectorNormal, CosineTolerance) // Connector normal points away from candidate
-                &&
-                UnitVectorsArePointingInOppositeDirections(candidateConnectorNormal, fromCandidateToConnectorNormal, CosineTolerance)) // Candidate normal points away from connector
-            {
-                auto negativeCandidateDistance = -fromCandidateToConnectorDistance;
+    }
 
-                // They are aligned, pointing away from each other, and the candidate is at a negative offset, so check against allowed negative offsets
-                if (minConnectorOffset >= 0 || negativeCandidateDistance < minConnectorOffset - ConnectorOffsetPadding)
-                {
-                    AL_LOG("FindAndLinkCompatibleBeltConnection:\tCandidate offset (%f) is outside of the min connector offset (%f)!", negativeCandidateDistance, minConnectorOffset);
-                    continue;
-                }
-                else if (maxConnectorOffset <= 0 && negativeCandidateDistance > maxConnectorOffset + ConnectorOffsetPadding)
-                {
-                    AL_LOG("FindAndLinkCompatibleBeltConnection:\tCandidate offset (%f) is outside of the max connector offset (%f)!", negativeCandidateDistance, maxConnectorOffset);
-                    continue;
-                }
-            }
-            else
-            {
-                AL_LOG("FindAndLinkCompatibleBeltConnection:\tThe connectors are not collinear!");
-                continue;
-            }
-        }
+    if (compatibleRow == INDEX_NONE)
+    {
+        AL_LOG("FindAndLinkCompatibleBeltConnection: No compatible connection found");
 
-        if (fromCandidateToConnectorDistance < closestDistance)
+        // Nothing the guess offered could be linked, so the scene gets asked after all
+        if (bIsGuess)
         {
-            AL_LOG("FindAndLinkCompatibleBeltConnection:\tFound a new closest one (%f) at: %s", fromCandidateToConnectorDistance, *candidateConnectorLocation.ToString());
-            closestDistance = fromCandidateToConnectorDistance;
-            compatibleConnectionComponent = candidateConnection;
-
-            if (closestDistance < 1)
-            {
-                AL_LOG("FindAndLinkCompatibleBeltConnection:\tFound extremely close candidate (%f units away). Taking it as the best.", closestDistance);
-                break;
-            }
+            TGuardValue<bool> noGuesses(bAreScanGuessesAllowed, false);
+            FindAndLinkCompatibleBeltConnection(connectionComponent);
         }
+
+        return;
     }
 
-    if (!compatibleConnectionComponent)
+    auto compatibleConnectionComponent = CastChecked<UFGFactoryConnectionComponent>(table.Components[compatibleRow]);
+    if (!coreConnector.IsOnConveyor() && !table.GetConnector(compatibleRow).IsOnConveyor())
     {
-        AL_LOG("FindAndLinkCompatibleBeltConnection: No compatible connection found");
+        // Closed in the table so nothing else in the pass picks either end
+        AutoLinkDeferredLinks::Add(connectionComponent, compatibleConnectionComponent);
+        table.NoteLinked(connectorRow, compatibleRow);
         return;
     }
 
@@ -980,20 +1054,31 @@ void UAutoLinkRootInstanceModule::FindAndLinkCompatibleBeltConnection(UFGFactory
         AL_LOG("FindAndLinkCompatibleBeltConnection: Connecting the components!");
         connectionComponent->SetConnection(compatibleConnectionComponent);
     }
+
+    table.NoteLinked(connectorRow, compatibleRow);
+    AL_PASS_STAT_ADD(NumLinks, 1);
+    NotifyLinked(connectionComponent, compatibleConnectionComponent);
 }
 
 void UAutoLinkRootInstanceModule::FindAndLinkCompatibleRailroadConnection(AutoLinkRailConnectionData& connectionData)
 {
+    auto& table = AutoLinkConnectorTable::Get();
     auto connectionComponent = connectionData.Connection;
+    const int32 connectorRow = table.Capture(connectionComponent);
     auto maxConnectionComponentConnections = connectionData.MaxConnections;
-    auto numStartingConnections = connectionComponent->GetConnections().Num();
-    if (numStartingConnections >= maxConnectionComponentConnections)
+    auto numStartingConnections = (int)table.NumConnections[connectorRow];
+    if (!table.IsOpen(connectorRow) || numStartingConnections >= maxConnectionComponentConnections)
     {
         AL_LOG("FindAndLinkCompatibleBeltConnection: Exiting because the connection component is already full");
         return;
     }
 
-    auto connectorLocation = connectionComponent->GetConnectorLocation();
+    if (CanSkipScan(table.GetLocation(connectorRow), AutoLinkCore::ConnectorKind::Railroad, connectionComponent->GetOwner()))
+    {
+        return;
+    }
+
+    auto connectorLocation = table.GetLocation(connectorRow);
     auto searchStart = connectorLocation;
     // Search a small extra distance from the connector. Though we will limit connections to 1 cm away, sometimes the hit box for the containing actor is a bit further
     auto searchRadius = 30.0f;
@@ -1002,15 +1087,16 @@ void UAutoLinkRootInstanceModule::FindAndLinkCompatibleRailroadConnection(AutoLi
 
     // Curved rails don't always seem to be hit by linear hitscan out of the connector normal so we do a radius search here to be sure we're getting good candidates.
     auto connectionOwner = connectionComponent->GetOwner();
-    TArray< AActor* > hitActors;
-    OverlapScan(
+    AutoLinkScratchArray<AActor*> hitActors;
+    const bool bIsGuess = OverlapScan(
         hitActors,
         connectionComponent->GetWorld(),
         searchStart,
         searchRadius,
+        connectionComponent,
         connectionOwner);
 
-    TArray<UFGRailroadTrackConnectionComponent*> candidates;
+    AutoLinkScratchArray<UFGRailroadTrackConnectionComponent*> candidates;
     for (auto actor : hitActors)
     {
         if (auto buildable = Cast<AFGBuildable>(actor))
@@ -1031,83 +1117,72 @@ void UAutoLinkRootInstanceModule::FindAndLinkCompatibleRailroadConnection(AutoLi
         }
     }
 
-    bool connectioniIsRailAttachment = connectionComponent->GetOwner()->IsA(AFGBuildableRailroadAttachment::StaticClass());
-    bool involvesRailAttachment = connectioniIsRailAttachment;
+    AL_PASS_STAT_ADD(NumCandidates, candidates.Num());
+
+    const auto coreConnector = table.GetConnector(connectorRow);
+    if (AutoLinkHookRecorder::IsRecording())
+    {
+        AutoLinkHookRecorder::RecordCandidates(connectionComponent, coreConnector, candidates);
+    }
+
+    bool involvesRailAttachment = table.HasOwnerFlags(connectorRow, AutoLinkCore::OwnerFlags::RailroadAttachment);
     auto numCompatibleConnections = 0;
-    TArray< UFGRailroadTrackConnectionComponent* > compatibleConnections;
+    AutoLinkScratchArray<int32> compatibleRows;
     for (auto candidateConnection : candidates)
     {
-        AL_LOG("FindAndLinkCompatibleRailroadConnection: Examining candidate connection: %s on %s at %s (%f units away)",
-            *candidateConnection->GetName(),
-            *candidateConnection->GetOwner()->GetName(),
-            *candidateConnection->GetConnectorLocation().ToString(),
-            FVector::Distance(connectorLocation, candidateConnection->GetConnectorLocation()));
-
         if (!IsValid(candidateConnection))
         {
-            AL_LOG("FindAndLinkCompatibleRailroadConnection:\tNot valid!");
+            AL_LOG("FindAndLinkCompatibleRailroadConnection: Candidate is not valid!");
             continue;
         }
 
+        const int32 candidateRow = table.Capture(candidateConnection);
+
+        AL_LOG("FindAndLinkCompatibleRailroadConnection: Examining candidate connection: %s on %s at %s (%f units away)",
+            *candidateConnection->GetName(),
+            *candidateConnection->GetOwner()->GetName(),
+            *table.GetLocation(candidateRow).ToString(),
+            FVector::Distance(connectorLocation, table.GetLocation(candidateRow)));
+
         // Don't need to explicitly check for the candidate being full because that's done in AddIfCandidate
 
         // We can only link the connection to a rail attachment candidate if the connection does not already have any connections
         // or has not already been slated to autolink with another connection
 
-        auto candidateIsRailAttachment = candidateConnection->GetOwner()->IsA(AFGBuildableRailroadAttachment::StaticClass());
-        auto numExistingConnections = candidateConnection->GetConnections().Num();
+        auto candidateIsRailAttachment = table.HasOwnerFlags(candidateRow, AutoLinkCore::OwnerFlags::RailroadAttachment);
+        auto numExistingConnections = (int)table.NumConnections[candidateRow];
         if (candidateIsRailAttachment && numExistingConnections + numCompatibleConnections > 0)
         {
             AL_LOG("FindAndLinkCompatibleRailroadConnection:\tThis candidate is a rail attachment but the connection already has a connection (or has found a different connection to auto-link to)!");
             continue;
         }
 
-        if (candidateConnection->GetConnections().Contains(connectionComponent))
-        {
-            AL_LOG("FindAndLinkCompatibleRailroadConnection:\tAlready connected to this candidate!");
-            continue;
-        }
-
-        if (compatibleConnections.Contains(candidateConnection))
+        if (compatibleRows.Contains(candidateRow))
         {
             AL_LOG("FindAndLinkCompatibleRailroadConnection:\tThis connection is already slated for linking!");
             continue;
         }
 
-        const FVector candidateLocation = candidateConnection->GetConnectorLocation();
-        const FVector fromCandidateToConnectorVector = connectorLocation - candidateLocation; // This gives the vector from the candidate connector to the main connector
-        const float distanceSq = fromCandidateToConnectorVector.SquaredLength();
-        if (distanceSq > 1) // Anything more than a 1 cm away is too far (and most are even much closer, based on my tests)
-        {
-            AL_LOG("FindAndLinkCompatibleRailroadConnection:\tCandidate connection is too far. Distance SQ: %f!", distanceSq);
-            continue;
-        }
-
-        const FVector connectorNormal = connectionComponent->GetConnectorNormal();
-        const FVector candidateConnectorNormal = candidateConnection->GetConnectorNormal();
-
-        // Determine if the connections components are aligned
-        const FVector crossProduct = FVector::CrossProduct(connectorNormal, candidateConnectorNormal);
-        // We allow slightly unaligned normal vectors to account for curved rails.
-        auto isCollinear = FMath::IsNearlyZero(crossProduct.X, .01) && FMath::IsNearlyZero(crossProduct.Y, .01) && FMath::IsNearlyZero(crossProduct.Z, 1.0);
-        if (!isCollinear)
+        auto candidateResult = AutoLinkCore::EvaluateRailCandidate(coreConnector, table.GetConnector(candidateRow));
+        if (candidateResult != AutoLinkCore::RailCandidateResult::Compatible)
         {
-            AL_LOG("FindAndLinkCompatibleRailroadConnection:\tCandidate connection normal is not collinear with this connector normal! The parts are not aligned! Cross product is %s", *crossProduct.ToString());
+            AL_LOG("FindAndLinkCompatibleRailroadConnection:\tCandidate connection is not compatible: %s. Connector normal: %s, candidate normal: %s",
+                ANSI_TO_TCHAR(AutoLinkCore::ToString(candidateResult)),
+                *table.GetNormal(connectorRow).ToString(),
+                *table.GetNormal(candidateRow).ToString());
             continue;
         }
 
-        // Determine if both connectors are facing in opposite directions. Rail junctions are an example where overlap might mean they're facing the same direction.
-        // If a dot product is positive, then the vectors are less than 90 degrees apart.
-        // So this dot product should be negative, meaning the connector normal is pointing AGAINST the candidate normal vector
-        const double connectorDotProduct = connectorNormal.Dot(candidateConnectorNormal);
-        if (connectorDotProduct >= 0)
+        // The table doesn't know which connectors were already linked before the pass, so this one asks the component. Only
+        // candidates touching the connector get this far.
+        if (numExistingConnections > 0 && candidateConnection->GetConnections().Contains(connectionComponent))
         {
-            AL_LOG("FindAndLinkCompatibleRailroadConnection:\tThe connectors are not facing in opposite directions! connectorDotProduct: %.8f", connectorDotProduct);
+            AL_LOG("FindAndLinkCompatibleRailroadConnection:\tAlready connected to this candidate!");
             continue;
         }
 
-        AL_LOG("FindAndLinkCompatibleRailroadConnection:\tThis is a compatible connection! Saving it for linking. Location: %s", *candidateLocation.ToString());
-        compatibleConnections.AddUnique(candidateConnection);
+        AL_LOG("FindAndLinkCompatibleRailroadConnection:\tThis is a compatible connection! Saving it for linking. Location: %s", *table.GetLocation(candidateRow).ToString());
+        compatibleRows.Add(candidateRow);
         ++numCompatibleConnections;
         involvesRailAttachment = involvesRailAttachment || candidateIsRailAttachment;
 
@@ -1129,6 +1204,12 @@ void UAutoLinkRootInstanceModule::FindAndLinkCompatibleRailroadConnection(AutoLi
     if (numCompatibleConnections == 0)
     {
         AL_LOG("FindAndLinkCompatibleRailroadConnection:\tNo compatible connections found!");
+        if (bIsGuess)
+        {
+            TGuardValue<bool> noGuesses(bAreScanGuessesAllowed, false);
+            FindAndLinkCompatibleRailroadConnection(connectionData);
+        }
+
         return;
     }
 
@@ -1141,6 +1222,12 @@ void UAutoLinkRootInstanceModule::FindAndLinkCompatibleRailroadConnection(AutoLi
         return;
     }
 
+    AutoLinkScratchArray<UFGRailroadTrackConnectionComponent*> compatibleConnections;
+    for (auto compatibleRow : compatibleRows)
+    {
+        compatibleConnections.Add(CastChecked<UFGRailroadTrackConnectionComponent>(table.Components[compatibleRow]));
+    }
+
     AL_LOG("FindAndLinkCompatibleRailroadConnection:\tFound a total of %d compatible connections to attempt to link", numCompatibleConnections);
 
     // Linking multiple connections to the same opposing connection creates a switch in the graph so trains can choose
@@ -1149,7 +1236,7 @@ void UAutoLinkRootInstanceModule::FindAndLinkCompatibleRailroadConnection(AutoLi
     // for the compatible connections.
 
     AFGBuildableRailroadSwitchControl* scanningConnectionBestSwitchControl = connectionComponent->GetSwitchControl();
-    TArray<UFGRailroadTrackConnectionComponent*> scanningConnectionSwitchControlGroup;
+    AutoLinkScratchArray<UFGRailroadTrackConnectionComponent*> scanningConnectionSwitchControlGroup;
 
     for (auto compatibleConnection : compatibleConnections)
     {
@@ -1185,9 +1272,9 @@ void UAutoLinkRootInstanceModule::FindAndLinkCompatibleRailroadConnection(AutoLi
     // We've gathered switch data for the side of the scanning connection. Now we have to figure out if we need to make a new switch for any of the compatible connections.
 
     AFGBuildableRailroadSwitchControl* compatibleConnectionsBestSwitchControl = nullptr;
-    TArray<UFGRailroadTrackConnectionComponent*> compatibleConnectionsSwitchControlGroup;
+    AutoLinkScratchArray<UFGRailroadTrackConnectionComponent*> compatibleConnectionsSwitchControlGroup;
 
-    TArray<UFGRailroadTrackConnectionComponent*> compatibleConnectionSiblings(compatibleConnections);
+    AutoLinkScratchArray<UFGRailroadTrackConnectionComponent*> compatibleConnectionSiblings(compatibleConnections);
     compatibleConnectionSiblings.Append(connectionComponent->GetConnections());
 
     for (auto compatibleConnectionSibling : compatibleConnectionSiblings)
@@ -1214,51 +1301,19 @@ void UAutoLinkRootInstanceModule::FindAndLinkCompatibleRailroadConnection(AutoLi
         return;
     }
 
-    // At the time this runs, the game has already created graph IDs and calculated overlapping tracks while thinking they are
-    // not connected (if they're connected, the code will not treat them as overlapping).  If the tracks are curved very tightly,
-    // they can ever-so-slightly overlap and get tracked as overlapping, which can confuse the game into thinking there are rail
-    // signal loops if we just simply connect them. Also, regardless of overlap, if you JUST connect the tracks and don't force
-    // the game to fully recalculate graphs and signal blocks here, that has created edge cases that mess up other rail signals.
-    // 
-    // Side note: all of these get fixed when the game gets reloaded and all rail stuff is calculated from scratch, which is comforting
-    // but obviously not what we want.
-    // 
-    // We can fix the current track entirely by removing it from the subsystem, connecting it to appropriate candidates, then re-adding it
-    // and forcing recalculation. This queues graph rebuilds and updates the overlapping calculations of the current track to NOT include
-    // any candidates. To ensure the overlapping tracks are correct on the compatible connection tracks, we just explicitly update their
-    // overlapping tracks after the connection is made.
-
-    auto connectionTrack = connectionComponent->GetTrack();
-    auto railSubsystem = AFGRailroadSubsystem::Get(connectionComponent->GetWorld());
-
-    // If this autolink involves a rail attachment, then removing the track prior to linking the attachment can crash the game. Thankfully,
-    // everything seems to work correctly if we just skip the remove/add step specifically for attachment linking.
-    if (!involvesRailAttachment)
-    {
-        railSubsystem->RemoveTrack(connectionTrack);
-    }
-
+    LinkRailConnections(connectionComponent, compatibleConnections, involvesRailAttachment);
     for (auto compatibleConnection : compatibleConnections)
     {
-        AL_LOG("FindAndLinkCompatibleRailroadConnection:\tLinking to connection %s on %s", *compatibleConnection->GetName(), *compatibleConnection->GetOwner()->GetName());
-        connectionComponent->AddConnection(compatibleConnection);
+        NotifyLinked(connectionComponent, compatibleConnection);
     }
 
-    if (!involvesRailAttachment)
+    for (auto compatibleRow : compatibleRows)
     {
-        railSubsystem->AddTrack(connectionTrack);
-
-        for (auto compatibleConnection : compatibleConnections)
-        {
-            auto linkedTrack = compatibleConnection->GetTrack();
-            if (linkedTrack->mOverlappingTracks.Contains(connectionTrack))
-            {
-                AL_LOG("FindAndLinkCompatibleRailroadConnection:\tTrack %s still thinks it's overlapping the base track. Updating it.", *linkedTrack->GetName());
-                linkedTrack->UpdateOverlappingTracks();
-            }
-        }
+        table.NoteLinked(connectorRow, compatibleRow);
     }
 
+    AL_PASS_STAT_ADD(NumLinks, compatibleConnections.Num());
+
     // Now that tracks are connected and updated, we can update or create necessary switch controls.
     // Note that if a connection has a switch control with 2 connections and 1 gets removed, the game doesn't immediately clean up the switch control, seeming
     // to rely on a periodic cleanup process of some kind.  So if we auto-link to that connection point before it's cleaned up, we will still detect the switch
@@ -1285,15 +1340,22 @@ void UAutoLinkRootInstanceModule::FindAndLinkCompatibleRailroadConnection(AutoLi
 
 bool UAutoLinkRootInstanceModule::FindAndLinkCompatibleFluidConnection(
     UFGPipeConnectionComponent* connectionComponent,
-    const TArray<UClass*>& incompatibleClasses)
+    const AutoLinkScratchArray<UClass*>& incompatibleClasses)
 {
-    if (connectionComponent->IsConnected())
+    auto& table = AutoLinkConnectorTable::Get();
+    const int32 connectorRow = table.Capture(connectionComponent, AutoLinkCore::ConnectorKind::Fluid);
+    if (!table.IsOpen(connectorRow))
     {
         AL_LOG("FindAndLinkCompatibleFluidConnection: Exiting because the connection component is already connected");
         return false;
     }
 
-    auto searchStart = connectionComponent->GetConnectorLocation();
+    if (CanSkipScan(table.GetLocation(connectorRow), AutoLinkCore::ConnectorKind::Fluid, connectionComponent->GetOwner()))
+    {
+        return false;
+    }
+
+    auto searchStart = table.GetLocation(connectorRow);
     // Search a small extra distance out from the connector. Though we will limit pipes to 1 cm away, sometimes the hit box for the containing actor is a bit further
     auto searchRadius = 50.0f;
 
@@ -1302,15 +1364,16 @@ bool UAutoLinkRootInstanceModule::FindAndLinkCompatibleFluidConnection(
         *connectionComponent->GetClass()->GetName(),
         connectionComponent->GetPipeConnectionType());
 
-    TArray< AActor* > hitActors;
-    OverlapScan(
+    AutoLinkScratchArray<AActor*> hitActors;
+    const bool bIsGuess = OverlapScan(
         hitActors,
         connectionComponent->GetWorld(),
         searchStart,
         searchRadius,
+        connectionComponent,
         connectionComponent->GetOwner());
 
-    TArray< UFGPipeConnectionComponentBase* > candidates;
+    AutoLinkScratchArray<UFGPipeConnectionComponentBase*> candidates;
     for (auto actor : hitActors)
     {
         if (auto buildable = Cast<AFGBuildable>(actor))
@@ -1344,32 +1407,51 @@ bool UAutoLinkRootInstanceModule::FindAndLinkCompatibleFluidConnection(
         }
     }
 
-    return ConnectBestPipeCandidate(connectionComponent, candidates);
+    if (ConnectBestPipeCandidate(connectionComponent, AutoLinkCore::ConnectorKind::Fluid, candidates))
+    {
+        return true;
+    }
+
+    if (bIsGuess)
+    {
+        TGuardValue<bool> noGuesses(bAreScanGuessesAllowed, false);
+        return FindAndLinkCompatibleFluidConnection(connectionComponent, incompatibleClasses);
+    }
+
+    return false;
 }
 
 bool UAutoLinkRootInstanceModule::FindAndLinkCompatibleHyperConnection(UFGPipeConnectionComponentHyper* connectionComponent)
 {
-    if (connectionComponent->IsConnected())
+    auto& table = AutoLinkConnectorTable::Get();
+    const int32 connectorRow = table.Capture(connectionComponent, AutoLinkCore::ConnectorKind::Hyper);
+    if (!table.IsOpen(connectorRow))
     {
         AL_LOG("FindAndLinkCompatibleHyperConnection: Exiting because the connection component is already connected");
         return false;
     }
 
-    auto connectorLocation = connectionComponent->GetConnectorLocation();
+    if (CanSkipScan(table.GetLocation(connectorRow), AutoLinkCore::ConnectorKind::Hyper, connectionComponent->GetOwner()))
+    {
+        return false;
+    }
+
+    auto connectorLocation = table.GetLocation(connectorRow);
     // Search a small extra distance straight out from the connector. Though we will limit pipes to 1 cm away, sometimes the hit box for the containing actor is a bit further
-    auto searchEnd = connectorLocation + (connectionComponent->GetConnectorNormal() * 10);
+    auto searchEnd = connectorLocation + (table.GetNormal(connectorRow) * 10);
 
     AL_LOG("FindAndLinkCompatibleHyperConnection: Connector at: %s, searchEnd is at: %s", *connectorLocation.ToString(), *searchEnd.ToString());
 
-    TArray< AActor* > hitActors;
-    HitScan(
+    AutoLinkScratchArray<AActor*> hitActors;
+    const bool bIsGuess = HitScan(
         hitActors,
         connectionComponent->GetWorld(),
         connectorLocation,
         searchEnd,
+        connectionComponent,
         connectionComponent->GetOwner());
 
-    TArray< UFGPipeConnectionComponentBase* > candidates;
+    AutoLinkScratchArray<UFGPipeConnectionComponentBase*> candidates;
     for (auto actor : hitActors)
     {
         if (auto buildable = Cast<AFGBuildable>(actor))
@@ -1389,50 +1471,72 @@ bool UAutoLinkRootInstanceModule::FindAndLinkCompatibleHyperConnection(UFGPipeCo
         }
     }
 
-    return ConnectBestPipeCandidate(connectionComponent, candidates);
+    if (ConnectBestPipeCandidate(connectionComponent, AutoLinkCore::ConnectorKind::Hyper, candidates))
+    {
+        return true;
+    }
+
+    if (bIsGuess)
+    {
+        TGuardValue<bool> noGuesses(bAreScanGuessesAllowed, false);
+        return FindAndLinkCompatibleHyperConnection(connectionComponent);
+    }
+
+    return false;
 }
 
-bool UAutoLinkRootInstanceModule::ConnectBestPipeCandidate(UFGPipeConnectionComponentBase* connectionComponent, TArray<UFGPipeConnectionComponentBase*>& candidates)
+bool UAutoLinkRootInstanceModule::ConnectBestPipeCandidate(
+    UFGPipeConnectionComponentBase* connectionComponent,
+    AutoLinkCore::ConnectorKind kind,
+    AutoLinkScratchArray<UFGPipeConnectionComponentBase*>& candidates)
 {
-    auto connectorLocation = connectionComponent->GetConnectorLocation();
-    auto connectionFluidComponent = Cast<UFGPipeConnectionComponent>(connectionComponent);
-    for (auto candidateConnection : candidates)
+    AL_PASS_STAT_ADD(NumCandidates, candidates.Num());
+
+    auto& table = AutoLinkConnectorTable::Get();
+    const int32 connectorRow = table.Capture(connectionComponent, kind);
+    const auto coreConnector = table.GetConnector(connectorRow);
+    if (AutoLinkHookRecorder::IsRecording())
     {
-        AL_LOG("ConnectBestPipeCandidate: Examining connection candidate: %s (%s) at %s (%f units away). Connection type %d",
-            *candidateConnection->GetName(),
-            *candidateConnection->GetClass()->GetName(),
-            *candidateConnection->GetConnectorLocation().ToString(),
-            FVector::Distance(connectorLocation, candidateConnection->GetConnectorLocation()),
-            candidateConnection->GetPipeConnectionType());
+        AutoLinkHookRecorder::RecordCandidates(connectionComponent, coreConnector, candidates);
+    }
 
+    for (auto candidateConnection : candidates)
+    {
         if (!IsValid(candidateConnection))
         {
-            AL_LOG("ConnectBestPipeCandidate:\tNot valid!");
+            AL_LOG("ConnectBestPipeCandidate: Candidate is not valid!");
             continue;
         }
 
-        // Determine if the connections components are aligned
-        const FVector connectorNormal = connectionComponent->GetConnectorNormal();
-        const FVector crossProduct = FVector::CrossProduct(connectorNormal, candidateConnection->GetConnectorNormal());
-        auto isCollinear = crossProduct.IsNearlyZero(.01);
-        if (!isCollinear)
+        const int32 candidateRow = table.Capture(candidateConnection, kind);
+
+        AL_LOG("ConnectBestPipeCandidate: Examining connection candidate: %s (%s) at %s (%f units away). Connection type %d",
+            *candidateConnection->GetName(),
+            *candidateConnection->GetClass()->GetName(),
+            *table.GetLocation(candidateRow).ToString(),
+            FVector::Distance(table.GetLocation(connectorRow), table.GetLocation(candidateRow)),
+            candidateConnection->GetPipeConnectionType());
+
+        if (!table.IsOpen(candidateRow))
         {
-            AL_LOG("ConnectBestPipeCandidate:\tOther connection normal is not collinear with this connector normal! The parts are not aligned!");
+            AL_LOG("ConnectBestPipeCandidate:\tAlready connected!");
             continue;
         }
 
-        // Pipes have to be virtually touching for us to link them so we just make double sure of that here.
-        const FVector otherLocation = candidateConnection->GetConnectorLocation();
-        const float distanceSq = FVector::DistSquared(otherLocation, connectorLocation);
-        if (distanceSq > 1) // Anything more than a 1 cm away is too far (and most are even much closer, based on my tests)
+        auto candidateResult = AutoLinkCore::EvaluatePipeCandidate(coreConnector, table.GetConnector(candidateRow));
+        if (candidateResult != AutoLinkCore::PipeCandidateResult::Compatible)
         {
-            AL_LOG("ConnectBestPipeCandidate:\tConnection is too far away to be auto-linked!");
+            AL_LOG("ConnectBestPipeCandidate:\tCandidate is not compatible: %s", ANSI_TO_TCHAR(AutoLinkCore::ToString(candidateResult)));
             continue;
         }
 
-        AL_LOG("ConnectBestPipeCandidate:\tFound one that's extremely close; taking it as the best result. Location: %s", *otherLocation.ToString());
+        AL_LOG("ConnectBestPipeCandidate:\tFound one that's extremely close; taking it as the best result. Location: %s", *table.GetLocation(candidateRow).ToString());
 
         candidateConnection->SetConnection(connectionComponent);
+        table.NoteLinked(connectorRow, candidateRow);
+        AL_PASS_STAT_ADD(NumLinks, 1);
+        NotifyLinked(connectionComponent, candidateConnection);
+
         return true;
     }
 
@@ -1442,20 +1546,75 @@ bool UAutoLinkRootInstanceModule::ConnectBestPipeCandidate(UFGPipeConnectionComp
 
 bool UAutoLinkRootInstanceModule::UnitVectorsArePointingInOppositeDirections(FVector firstUnitVector, FVector secondUnitVector, double cosineTolerance)
 {
-    auto dotProduct = firstUnitVector.Dot(secondUnitVector);
+    auto result = AutoLinkCore::UnitVectorsArePointingInOppositeDirections(
+        AutoLinkCoreBridge::ToCore(firstUnitVector),
+        AutoLinkCoreBridge::ToCore(secondUnitVector),
+        cosineTolerance);
+    AL_LOG("UnitVectorsArePointingInOppositeDirections: Dot product of %s and %s is %f. Cosine tolerance is %f. Angle between them is: %f. Result: %d", *firstUnitVector.ToString(), *secondUnitVector.ToString(), firstUnitVector.Dot(secondUnitVector), cosineTolerance, FMath::RadiansToDegrees(acos(firstUnitVector.Dot(secondUnitVector))), result);
+    return result;
+}
 
-    // Because they are unit vectors, the dot product is exactly the cosine of the angle between the vectors. For them to be in opposite directions,
-    // that should be -1, but we have a tolerance for floating point error and to allow slight angles when needed
+void UAutoLinkRootInstanceModule::LinkRailConnections(
+    UFGRailroadTrackConnectionComponent* connectionComponent,
+    const AutoLinkScratchArray<UFGRailroadTrackConnectionComponent*>& compatibleConnections,
+    bool involvesRailAttachment)
+{
+    // At the time this runs, the game has already created graph IDs and calculated overlapping tracks while thinking they are
+    // not connected (if they're connected, the code will not treat them as overlapping).  If the tracks are curved very tightly,
+    // they can ever-so-slightly overlap and get tracked as overlapping, which can confuse the game into thinking there are rail
+    // signal loops if we just simply connect them. Also, regardless of overlap, if you JUST connect the tracks and don't force
+    // the game to fully recalculate graphs and signal blocks here, that has created edge cases that mess up other rail signals.
+    // 
+    // Side note: all of these get fixed when the game gets reloaded and all rail stuff is calculated from scratch, which is comforting
+    // but obviously not what we want.
+    // 
+    // We can fix the current track entirely by removing it from the subsystem, connecting it to appropriate candidates, then re-adding it
+    // and forcing recalculation. This queues graph rebuilds and updates the overlapping calculations of the current track to NOT include
+    // any candidates. To ensure the overlapping tracks are correct on the compatible connection tracks, we just explicitly update their
+    // overlapping tracks after the connection is made.
 
-    auto result = dotProduct <= (cosineTolerance - 1);
-    AL_LOG("UnitVectorsArePointingInOppositeDirections: Dot product of %s and %s is %f. Cosine tolerance is %f. Angle between them is: %f. Result: %d", *firstUnitVector.ToString(), *secondUnitVector.ToString(), dotProduct, cosineTolerance, FMath::RadiansToDegrees(acos(dotProduct)), result);
-    return result;
+    auto connectionTrack = connectionComponent->GetTrack();
+    auto railSubsystem = AFGRailroadSubsystem::Get(connectionComponent->GetWorld());
+
+    // The rebuild is timed from the removal to the last overlap update, links included
+    const uint64 trackRebuildStartCycles = FPlatformTime::Cycles64();
+
+    // If this autolink involves a rail attachment, then removing the track prior to linking the attachment can crash the game. Thankfully,
+    // everything seems to work correctly if we just skip the remove/add step specifically for attachment linking.
+    if (!involvesRailAttachment)
+    {
+        railSubsystem->RemoveTrack(connectionTrack);
+    }
+
+    for (auto compatibleConnection : compatibleConnections)
+    {
+        AL_LOG("LinkRailConnections:\tLinking to connection %s on %s", *compatibleConnection->GetName(), *compatibleConnection->GetOwner()->GetName());
+        connectionComponent->AddConnection(compatibleConnection);
+    }
+
+    if (!involvesRailAttachment)
+    {
+        railSubsystem->AddTrack(connectionTrack);
+
+        for (auto compatibleConnection : compatibleConnections)
+        {
+            auto linkedTrack = compatibleConnection->GetTrack();
+            if (linkedTrack->mOverlappingTracks.Contains(connectionTrack))
+            {
+                AL_LOG("LinkRailConnections:\tTrack %s still thinks it's overlapping the base track. Updating it.", *linkedTrack->GetName());
+                linkedTrack->UpdateOverlappingTracks();
+            }
+        }
+
+        AL_PASS_STAT_ADD(NumTrackRebuilds, 1);
+        AL_PASS_STAT_ADD(TrackRebuildCycles, FPlatformTime::Cycles64() - trackRebuildStartCycles);
+    }
 }
 
 void UAutoLinkRootInstanceModule::UpdateOrCreateSwitchControl(
     UFGRailroadTrackConnectionComponent* anchorConnection,
     AFGBuildableRailroadSwitchControl* existingSwitchControl,
-    TArray<UFGRailroadTrackConnectionComponent*>& finalSwitchControlConnections)
+    const AutoLinkScratchArray<UFGRailroadTrackConnectionComponent*>& finalSwitchControlConnections)
 {
     if (existingSwitchControl)
     {
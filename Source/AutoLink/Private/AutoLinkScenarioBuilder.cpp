@@ -0,0 +1,340 @@
+#include "AutoLinkScenarioBuilder.h"
+
+#include "AutoLinkLogCategory.h"
+
+#include "FGBuildableRailroadSwitchControl.h"
+#include "FGFactoryConnectionComponent.h"
+#include "FGPipeConnectionComponent.h"
+#include "FGRailroadTrackConnectionComponent.h"
+
+static const TCHAR* GetScenarioClassPath(EAutoLinkScenarioClass scenarioClass)
+{
+    switch (scenarioClass)
+    {
+    case EAutoLinkScenarioClass::ConveyorBelt: return TEXT("/Game/FactoryGame/Buildable/Factory/ConveyorBeltMk1/Build_ConveyorBeltMk1.Build_ConveyorBeltMk1_C");
+    case EAutoLinkScenarioClass::ConveyorLift: return TEXT("/Game/FactoryGame/Buildable/Factory/ConveyorLiftMk1/Build_ConveyorLiftMk1.Build_ConveyorLiftMk1_C");
+    case EAutoLinkScenarioClass::Splitter: return TEXT("/Game/FactoryGame/Buildable/Factory/CA_Splitter/Build_ConveyorAttachmentSplitter.Build_ConveyorAttachmentSplitter_C");
+    case EAutoLinkScenarioClass::Merger: return TEXT("/Game/FactoryGame/Buildable/Factory/CA_Merger/Build_ConveyorAttachmentMerger.Build_ConveyorAttachmentMerger_C");
+    case EAutoLinkScenarioClass::Constructor: return TEXT("/Game/FactoryGame/Buildable/Factory/ConstructorMk1/Build_ConstructorMk1.Build_ConstructorMk1_C");
+    case EAutoLinkScenarioClass::StorageContainer: return TEXT("/Game/FactoryGame/Buildable/Factory/StorageContainerMk1/Build_StorageContainerMk1.Build_StorageContainerMk1_C");
+    case EAutoLinkScenarioClass::DimensionalDepot: return TEXT("/Game/FactoryGame/Buildable/Factory/CentralStorage/Build_CentralStorage.Build_CentralStorage_C");
+    case EAutoLinkScenarioClass::Pipeline: return TEXT("/Game/FactoryGame/Buildable/Factory/Pipeline/Build_Pipeline.Build_Pipeline_C");
+    case EAutoLinkScenarioClass::PipelineJunction: return TEXT("/Game/FactoryGame/Buildable/Factory/PipeJunction/Build_PipelineJunction_Cross.Build_PipelineJunction_Cross_C");
+    case EAutoLinkScenarioClass::PipeHyper: return TEXT("/Game/FactoryGame/Buildable/Factory/PipeHyper/Build_PipeHyper.Build_PipeHyper_C");
+    case EAutoLinkScenarioClass::RailroadTrack: return TEXT("/Game/FactoryGame/Buildable/Factory/Train/Track/Build_RailroadTrack.Build_RailroadTrack_C");
+    default: return nullptr;
+    }
+}
+
+AutoLinkScenarioBuilder::AutoLinkScenarioBuilder(UWorld* world, const FVector& origin)
+    : Origin(origin)
+    , World(world)
+{
+}
+
+AutoLinkScenarioBuilder::~AutoLinkScenarioBuilder()
+{
+    DestroyAll();
+}
+
+bool AutoLinkScenarioBuilder::LoadClasses()
+{
+    bool loadedAll = true;
+    for (int32 i = 0; i < (int32)EAutoLinkScenarioClass::Num; ++i)
+    {
+        if (Classes[i])
+        {
+            continue;
+        }
+
+        auto path = GetScenarioClassPath((EAutoLinkScenarioClass)i);
+        Classes[i] = LoadClass<AFGBuildable>(nullptr, path);
+        if (!Classes[i])
+        {
+            UE_LOG(LogAutoLink, Error, TEXT("AutoLinkScenarioBuilder: Could not load buildable class %s"), path);
+            loadedAll = false;
+        }
+    }
+
+    return loadedAll;
+}
+
+UClass* AutoLinkScenarioBuilder::GetClass(EAutoLinkScenarioClass scenarioClass)
+{
+    return Classes[(int32)scenarioClass];
+}
+
+template<typename T>
+T* AutoLinkScenarioBuilder::SpawnDeferred(EAutoLinkScenarioClass scenarioClass, const FTransform& transform, TFunctionRef<void(T*)> configure)
+{
+    auto buildableClass = GetClass(scenarioClass);
+    if (!buildableClass)
+    {
+        return nullptr;
+    }
+
+    auto buildable = World->SpawnActorDeferred<T>(buildableClass, transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+    if (!buildable)
+    {
+        return nullptr;
+    }
+
+    configure(buildable);
+    buildable->FinishSpawning(transform);
+    Buildables.Add(buildable);
+    return buildable;
+}
+
+TArray<FSplinePointData> AutoLinkScenarioBuilder::MakeSpline(const FVector& localEnd)
+{
+    // Reflecting the start tangent across the chord gives the end tangent of the circular arc through both points, which
+    // is a straight line when the end is on the X axis
+    auto length = localEnd.Length();
+    auto chord = localEnd.GetSafeNormal();
+    auto startTangent = FVector(length, 0, 0);
+    auto endTangent = (2 * chord.X * chord - FVector::ForwardVector) * length;
+
+    TArray<FSplinePointData> splineData;
+
+    FSplinePointData start;
+    start.Location = FVector::ZeroVector;
+    start.ArriveTangent = startTangent;
+    start.LeaveTangent = startTangent;
+    splineData.Add(start);
+
+    FSplinePointData end;
+    end.Location = localEnd;
+    end.ArriveTangent = endTangent;
+    end.LeaveTangent = endTangent;
+    splineData.Add(end);
+
+    return splineData;
+}
+
+AFGBuildable* AutoLinkScenarioBuilder::SpawnBuildable(EAutoLinkScenarioClass scenarioClass, const FVector& location, const FRotator& rotation)
+{
+    return SpawnDeferred<AFGBuildable>(scenarioClass, FTransform(rotation, Origin + location), [](AFGBuildable*) {});
+}
+
+AFGBuildableConveyorBelt* AutoLinkScenarioBuilder::SpawnBelt(const FVector& start, const FVector& end)
+{
+    auto span = end - start;
+    return SpawnDeferred<AFGBuildableConveyorBelt>(
+        EAutoLinkScenarioClass::ConveyorBelt,
+        FTransform(span.Rotation(), Origin + start),
+        [&](AFGBuildableConveyorBelt* belt) { belt->mSplineData = MakeSpline(FVector(span.Length(), 0, 0)); });
+}
+
+AFGBuildableConveyorLift* AutoLinkScenarioBuilder::SpawnLift(const FVector& bottom, float height, const FRotator& rotation)
+{
+    return SpawnDeferred<AFGBuildableConveyorLift>(
+        EAutoLinkScenarioClass::ConveyorLift,
+        FTransform(rotation, Origin + bottom),
+        [&](AFGBuildableConveyorLift* lift)
+        {
+            lift->mTopTransform = FTransform(FRotator::ZeroRotator, FVector(0, 0, height));
+            lift->mIsReversed = false;
+        });
+}
+
+AFGBuildablePipeline* AutoLinkScenarioBuilder::SpawnPipe(const FVector& start, const FVector& end)
+{
+    auto span = end - start;
+    return SpawnDeferred<AFGBuildablePipeline>(
+        EAutoLinkScenarioClass::Pipeline,
+        FTransform(span.Rotation(), Origin + start),
+        [&](AFGBuildablePipeline* pipe) { pipe->mSplineData = MakeSpline(FVector(span.Length(), 0, 0)); });
+}
+
+AFGBuildablePipeHyper* AutoLinkScenarioBuilder::SpawnHyper(const FVector& start, const FVector& end, const FVector& startDirection)
+{
+    FVector localEnd;
+    auto transform = GetSplineTransform(start, end, startDirection, localEnd);
+    return SpawnDeferred<AFGBuildablePipeHyper>(
+        EAutoLinkScenarioClass::PipeHyper,
+        transform,
+        [&](AFGBuildablePipeHyper* pipe) { pipe->mSplineData = MakeSpline(localEnd); });
+}
+
+AFGBuildableRailroadTrack* AutoLinkScenarioBuilder::SpawnTrack(const FVector& start, const FVector& end, const FVector& startDirection)
+{
+    FVector localEnd;
+    auto transform = GetSplineTransform(start, end, startDirection, localEnd);
+    return SpawnDeferred<AFGBuildableRailroadTrack>(
+        EAutoLinkScenarioClass::RailroadTrack,
+        transform,
+        [&](AFGBuildableRailroadTrack* track) { track->mSplineData = MakeSpline(localEnd); });
+}
+
+FTransform AutoLinkScenarioBuilder::GetSplineTransform(const FVector& start, const FVector& end, const FVector& startDirection, FVector& outLocalEnd) const
+{
+    auto span = end - start;
+    auto rotation = startDirection.IsNearlyZero() ? span.Rotation() : startDirection.Rotation();
+    outLocalEnd = rotation.UnrotateVector(span);
+    return FTransform(rotation, Origin + start);
+}
+
+AFGBuildable* AutoLinkScenarioBuilder::SpawnOnInput(EAutoLinkScenarioClass scenarioClass, const FVector& target, const FVector& outputNormal)
+{
+    auto probe = InputProbes.Find(scenarioClass);
+    if (!probe)
+    {
+        auto probeBuildable = SpawnBuildable(scenarioClass, FVector::ZeroVector);
+        auto input = FindConnection(probeBuildable, EFactoryConnectionDirection::FCD_INPUT);
+        if (!input)
+        {
+            DestroyBuildable(probeBuildable);
+            return nullptr;
+        }
+
+        probe = &InputProbes.Add(scenarioClass, TPair<FVector, FVector>(
+            input->GetConnectorLocation() - probeBuildable->GetActorLocation(),
+            input->GetConnectorNormal()));
+        DestroyBuildable(probeBuildable);
+    }
+
+    auto rotation = FRotator(0, (-outputNormal).Rotation().Yaw - probe->Value.Rotation().Yaw, 0);
+    return SpawnBuildable(scenarioClass, target - rotation.RotateVector(probe->Key), rotation);
+}
+
+UFGFactoryConnectionComponent* AutoLinkScenarioBuilder::FindConnection(AFGBuildable* buildable, EFactoryConnectionDirection direction, const FVector& facing)
+{
+    if (!buildable)
+    {
+        return nullptr;
+    }
+
+    TInlineComponentArray<UFGFactoryConnectionComponent*> connections;
+    buildable->GetComponents(connections);
+
+    UFGFactoryConnectionComponent* best = nullptr;
+    double bestDot = -FLT_MAX;
+    for (auto connection : connections)
+    {
+        if (connection->GetDirection() != direction)
+        {
+            continue;
+        }
+
+        auto dot = facing.IsNearlyZero() ? 0 : FVector::DotProduct(connection->GetConnectorNormal(), facing);
+        if (!best || dot > bestDot)
+        {
+            best = connection;
+            bestDot = dot;
+        }
+    }
+
+    return best;
+}
+
+double AutoLinkScenarioBuilder::MeasureJunctionHalfSize()
+{
+    auto probe = SpawnBuildable(EAutoLinkScenarioClass::PipelineJunction, FVector::ZeroVector);
+    if (!probe)
+    {
+        return 0;
+    }
+
+    TInlineComponentArray<UFGPipeConnectionComponent*> probeConnections;
+    probe->GetComponents(probeConnections);
+    double junctionHalfSize = 0;
+    for (auto connection : probeConnections)
+    {
+        junctionHalfSize = FMath::Max(junctionHalfSize, FMath::Abs(connection->GetConnectorLocation().X - probe->GetActorLocation().X));
+    }
+
+    DestroyBuildable(probe);
+    return junctionHalfSize;
+}
+
+void AutoLinkScenarioBuilder::DestroyBuildable(AFGBuildable* buildable)
+{
+    if (Buildables.Remove(buildable) > 0 && IsValid(buildable))
+    {
+        buildable->Destroy();
+    }
+}
+
+void AutoLinkScenarioBuilder::DestroyAll()
+{
+    // Switch controls are spawned by the linking itself, so they aren't in Buildables
+    TSet<AFGBuildableRailroadSwitchControl*> switchControls;
+    for (auto buildable : Buildables)
+    {
+        if (auto track = Cast<AFGBuildableRailroadTrack>(buildable))
+        {
+            for (auto connection : { track->GetConnection(0), track->GetConnection(1) })
+            {
+                if (connection && connection->GetSwitchControl())
+                {
+                    switchControls.Add(connection->GetSwitchControl());
+                }
+            }
+        }
+    }
+
+    for (auto switchControl : switchControls)
+    {
+        if (IsValid(switchControl))
+        {
+            switchControl->Destroy();
+        }
+    }
+
+    for (auto buildable : Buildables)
+    {
+        if (IsValid(buildable))
+        {
+            buildable->Destroy();
+        }
+    }
+
+    Buildables.Reset();
+}
+
+int32 AutoLinkScenarioBuilder::CountLinks() const
+{
+    TSet<const AActor*> spawned;
+    for (auto buildable : Buildables)
+    {
+        spawned.Add(buildable);
+    }
+
+    auto isSpawned = [&](const UActorComponent* component) { return component && spawned.Contains(component->GetOwner()); };
+
+    // Every link is seen from both ends, so count ends and halve
+    int32 numLinkEnds = 0;
+    for (auto buildable : Buildables)
+    {
+        if (!IsValid(buildable))
+        {
+            continue;
+        }
+
+        TInlineComponentArray<UFGFactoryConnectionComponent*> factoryConnections;
+        buildable->GetComponents(factoryConnections);
+        for (auto connection : factoryConnections)
+        {
+            numLinkEnds += connection->IsConnected() && isSpawned(connection->GetConnection()) ? 1 : 0;
+        }
+
+        TInlineComponentArray<UFGPipeConnectionComponentBase*> pipeConnections;
+        buildable->GetComponents(pipeConnections);
+        for (auto connection : pipeConnections)
+        {
+            numLinkEnds += connection->IsConnected() && isSpawned(connection->GetConnection()) ? 1 : 0;
+        }
+
+        TInlineComponentArray<UFGRailroadTrackConnectionComponent*> railConnections;
+        buildable->GetComponents(railConnections);
+        for (auto connection : railConnections)
+        {
+            for (auto connectedTo : connection->GetConnections())
+            {
+                numLinkEnds += isSpawned(connectedTo) ? 1 : 0;
+            }
+        }
+    }
+
+    return numLinkEnds / 2;
+}
@@ -0,0 +1,1089 @@
+#include "AutoLinkScenarioRunner.h"
+
+#include "AutoLinkAllocationCounter.h"
+#include "AutoLinkConnectorIndex.h"
+#include "AutoLinkConsoleVariables.h"
+#include "AutoLinkCoreBridge.h"
+#include "AutoLinkDeferredLinks.h"
+#include "AutoLinkLogCategory.h"
+#include "AutoLinkPassStats.h"
+#include "AutoLinkPlacementBatch.h"
+#include "AutoLinkRootInstanceModule.h"
+
+#include "Dom/JsonObject.h"
+#include "FGFactoryConnectionComponent.h"
+#include "FGPipeConnectionComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+// High above the map so scenarios can't touch (or link to) anything players built. Each scenario gets its own slot along X.
+static const FVector ScenarioOrigin(0, 0, 500000);
+static const double ScenarioSpacing = 100000;
+
+void AutoLinkScenarioContext::Link(const TArray<AFGBuildable*>& buildables, const TCHAR* source)
+{
+    const TArray<AActor*> children(buildables);
+    {
+        AutoLinkPassScope passScope(source, nullptr, true);
+        UAutoLinkRootInstanceModule::FindAndLinkForChildren(children);
+
+        // Scenarios run from a console command, outside any tick, so the links can be made right away and counted in the pass
+        if (children.Num() > 0)
+        {
+            AutoLinkDeferredLinks::Commit(children[0]->GetWorld());
+        }
+    }
+
+    auto& stats = AutoLinkPassScope::GetLastStats();
+    ++Result.NumPasses;
+    Result.NumBuildables += stats.NumBuildables;
+    for (auto numOpenConnectors : stats.NumOpenConnectors)
+    {
+        Result.NumOpenConnectors += numOpenConnectors;
+    }
+
+    Result.LinkMs += FPlatformTime::ToMilliseconds64(stats.TotalCycles);
+    Result.NumHitScans += stats.NumHitScans;
+    Result.NumOverlapScans += stats.NumOverlapScans;
+    Result.NumHitActors += stats.NumHitActors;
+    Result.NumCandidates += stats.NumCandidates;
+    Result.NumPrefilteredScans += stats.NumPrefilteredScans;
+    Result.NumSkippedScans += stats.NumSkippedScans;
+    Result.NumSkippedChildren += stats.NumSkippedChildren;
+    Result.NumTrackRebuilds += stats.NumTrackRebuilds;
+    Result.TrackRebuildMs += FPlatformTime::ToMilliseconds64(stats.TrackRebuildCycles);
+    Result.NumAllocations = AutoLinkAllocationCounter::IsInstalled() ? Result.NumAllocations + stats.NumAllocations : NumAllocationsUnavailable;
+}
+
+void AutoLinkScenarioContext::Fail(const FString& message)
+{
+    Result.Failures.Add(message);
+}
+
+void AutoLinkScenarioContext::Expect(int32 expectedLinks, const TCHAR* what)
+{
+    Result.ExpectedLinks = expectedLinks;
+    Result.ActualLinks = Builder.CountLinks();
+    if (Result.ActualLinks != expectedLinks)
+    {
+        Result.Failures.Add(FString::Printf(TEXT("%s: expected %d links but found %d"), what, expectedLinks, Result.ActualLinks));
+    }
+}
+
+int32 AutoLinkScenarioRunner::SpawnBeltsAtConnectors(AutoLinkScenarioBuilder& builder, AFGBuildable* buildable, float length, float startOffset)
+{
+    TInlineComponentArray<UFGFactoryConnectionComponent*> connections;
+    buildable->GetComponents(connections);
+
+    int32 numSpawned = 0;
+    for (auto connection : connections)
+    {
+        auto nearEnd = connection->GetConnectorLocation() + connection->GetConnectorNormal() * startOffset - builder.Origin;
+        auto farEnd = nearEnd + connection->GetConnectorNormal() * length;
+        switch (connection->GetDirection())
+        {
+        case EFactoryConnectionDirection::FCD_OUTPUT:
+            numSpawned += builder.SpawnBelt(nearEnd, farEnd) ? 1 : 0;
+            break;
+        case EFactoryConnectionDirection::FCD_INPUT:
+            numSpawned += builder.SpawnBelt(farEnd, nearEnd) ? 1 : 0;
+            break;
+        default:
+            break;
+        }
+    }
+
+    return numSpawned;
+}
+
+int32 AutoLinkScenarioRunner::SpawnPipesAtConnectors(AutoLinkScenarioBuilder& builder, AFGBuildable* buildable, float length)
+{
+    TInlineComponentArray<UFGPipeConnectionComponent*> connections;
+    buildable->GetComponents(connections);
+
+    int32 numSpawned = 0;
+    for (auto connection : connections)
+    {
+        auto nearEnd = connection->GetConnectorLocation() - builder.Origin;
+        numSpawned += builder.SpawnPipe(nearEnd, nearEnd + connection->GetConnectorNormal() * length) ? 1 : 0;
+    }
+
+    return numSpawned;
+}
+
+// A grid of constructors with a two-segment belt on every input and output
+void AutoLinkScenarioRunner::BeltGrid(AutoLinkScenarioContext& context)
+{
+    const int32 gridSize = 8;
+    const float beltLength = 400;
+
+    int32 numBelts = 0;
+    for (int32 x = 0; x < gridSize; ++x)
+    {
+        for (int32 y = 0; y < gridSize; ++y)
+        {
+            auto constructor = context.Builder.SpawnBuildable(EAutoLinkScenarioClass::Constructor, FVector(x * 3000, y * 3000, 0));
+            if (!constructor)
+            {
+                continue;
+            }
+
+            numBelts += SpawnBeltsAtConnectors(context.Builder, constructor, beltLength);
+            SpawnBeltsAtConnectors(context.Builder, constructor, beltLength, beltLength);
+        }
+    }
+
+    context.LinkAll();
+
+    // Each belt next to a constructor links to it and to the belt beyond it
+    context.Expect(numBelts * 2, TEXT("BeltGrid"));
+}
+
+// Columns of conveyor lifts stacked end to end
+void AutoLinkScenarioRunner::LiftStacks(AutoLinkScenarioContext& context)
+{
+    const int32 numStacks = 16;
+    const int32 liftsPerStack = 8;
+    const float liftHeight = 800;
+
+    int32 expectedLinks = 0;
+    for (int32 stack = 0; stack < numStacks; ++stack)
+    {
+        int32 numLifts = 0;
+        for (int32 lift = 0; lift < liftsPerStack; ++lift)
+        {
+            auto bottom = FVector((stack % 4) * 1000, (stack / 4) * 1000, lift * liftHeight);
+            numLifts += context.Builder.SpawnLift(bottom, liftHeight) ? 1 : 0;
+        }
+
+        expectedLinks += FMath::Max(numLifts - 1, 0);
+    }
+
+    context.LinkAll();
+    context.Expect(expectedLinks, TEXT("LiftStacks"));
+}
+
+// Rows of cross junctions with a pipe out of every connector. Neighbouring junctions in a row are spaced so their pipes meet
+// halfway; rows are far enough apart that theirs don't.
+void AutoLinkScenarioRunner::PipeManifold(AutoLinkScenarioContext& context)
+{
+    const int32 numRows = 6;
+    const int32 junctionsPerRow = 8;
+    const float pipeLength = 600;
+
+    // The junction's size decides the spacing, so measure one first
+    const double junctionHalfSize = context.Builder.MeasureJunctionHalfSize();
+    if (junctionHalfSize <= 0)
+    {
+        context.Fail(TEXT("PipeManifold could not spawn a junction"));
+        return;
+    }
+
+    const double spacing = (junctionHalfSize + pipeLength) * 2;
+    int32 expectedLinks = 0;
+    for (int32 row = 0; row < numRows; ++row)
+    {
+        for (int32 i = 0; i < junctionsPerRow; ++i)
+        {
+            auto junction = context.Builder.SpawnBuildable(EAutoLinkScenarioClass::PipelineJunction, FVector(i * spacing, row * spacing * 2, 0));
+            if (junction)
+            {
+                expectedLinks += SpawnPipesAtConnectors(context.Builder, junction, pipeLength);
+            }
+        }
+
+        // The pipes between neighbours meet end to end
+        expectedLinks += junctionsPerRow - 1;
+    }
+
+    context.LinkAll();
+    context.Expect(expectedLinks, TEXT("PipeManifold"));
+}
+
+// Parallel lines that each split into a three-way switch
+void AutoLinkScenarioRunner::RailYard(AutoLinkScenarioContext& context)
+{
+    const int32 numLines = 8;
+    const float trackLength = 3000;
+    const float branchSpread = 600;
+
+    int32 expectedLinks = 0;
+    for (int32 line = 0; line < numLines; ++line)
+    {
+        auto joint = FVector(0, line * 4000, 0);
+        auto incoming = context.Builder.SpawnTrack(joint - FVector(trackLength, 0, 0), joint);
+
+        int32 numBranches = 0;
+        for (float spread : { 0.0f, branchSpread, -branchSpread })
+        {
+            numBranches += context.Builder.SpawnTrack(joint, joint + FVector(trackLength, spread, 0), FVector::ForwardVector) ? 1 : 0;
+        }
+
+        expectedLinks += incoming ? numBranches : 0;
+    }
+
+    context.LinkAll();
+    context.Expect(expectedLinks, TEXT("RailYard"));
+}
+
+// Belts laid for a dimensional depot, a storage container built there first and then swapped for the depot
+void AutoLinkScenarioRunner::StorageDepotSwap(AutoLinkScenarioContext& context)
+{
+    const float beltLength = 400;
+    auto location = FVector::ZeroVector;
+
+    auto depot = context.Builder.SpawnBuildable(EAutoLinkScenarioClass::DimensionalDepot, location);
+    if (!depot)
+    {
+        context.Fail(TEXT("StorageDepotSwap could not spawn a depot"));
+        return;
+    }
+
+    auto numDepotBelts = SpawnBeltsAtConnectors(context.Builder, depot, beltLength);
+    context.Builder.DestroyBuildable(depot);
+
+    auto storage = context.Builder.SpawnBuildable(EAutoLinkScenarioClass::StorageContainer, location);
+    if (!storage)
+    {
+        context.Fail(TEXT("StorageDepotSwap could not spawn a storage container"));
+        return;
+    }
+
+    auto numStorageBelts = SpawnBeltsAtConnectors(context.Builder, storage, beltLength);
+    context.Link({ storage });
+    context.Expect(numStorageBelts, TEXT("StorageDepotSwap before the swap"));
+
+    context.Builder.DestroyBuildable(storage);
+    depot = context.Builder.SpawnBuildable(EAutoLinkScenarioClass::DimensionalDepot, location);
+    if (!depot)
+    {
+        context.Fail(TEXT("StorageDepotSwap could not spawn a depot for the swap"));
+        return;
+    }
+
+    context.Link({ depot });
+    context.Expect(numDepotBelts, TEXT("StorageDepotSwap after the swap"));
+}
+
+// A constructor with belts and a junction with pipes, each piece handed to AutoLinkPlacementBatch one at a time the way the
+// ConfigureComponents hooks hand over a lone placement. It runs once with AutoLink.BatchPlacements 0, which links from the
+// hook, and once with batching on, so both paths are checked end to end.
+void AutoLinkScenarioRunner::SinglePlacements(AutoLinkScenarioContext& context)
+{
+    const float beltLength = 400;
+    const float pipeLength = 600;
+    const bool bWasBatching = CVarAutoLinkBatchPlacements.GetValueOnGameThread();
+
+    int32 expectedLinks = 0;
+    int32 mode = 0;
+    for (bool bBatch : { false, true })
+    {
+        CVarAutoLinkBatchPlacements->Set(bBatch, ECVF_SetByCode);
+
+        auto location = FVector(mode++ * 10000, 0, 0);
+        auto constructor = context.Builder.SpawnBuildable(EAutoLinkScenarioClass::Constructor, location);
+        auto junction = context.Builder.SpawnBuildable(EAutoLinkScenarioClass::PipelineJunction, location + FVector(0, 5000, 0));
+        if (!constructor || !junction)
+        {
+            context.Fail(TEXT("SinglePlacements could not spawn a constructor and a junction"));
+            break;
+        }
+
+        TArray<AFGBuildable*> placements = { constructor, junction };
+        const auto numSpawned = context.Builder.GetBuildables().Num();
+        expectedLinks += SpawnBeltsAtConnectors(context.Builder, constructor, beltLength);
+        expectedLinks += SpawnPipesAtConnectors(context.Builder, junction, pipeLength);
+        for (int32 i = numSpawned; i < context.Builder.GetBuildables().Num(); ++i)
+        {
+            placements.Add(context.Builder.GetBuildables()[i]);
+        }
+
+        for (auto buildable : placements)
+        {
+            AutoLinkPlacementBatch::AddBuildable(nullptr, buildable);
+        }
+
+        // Scenarios run outside any tick, so the end of the tick is done here
+        AutoLinkPlacementBatch::Flush(context.Builder.GetWorld());
+        AutoLinkDeferredLinks::Commit(context.Builder.GetWorld());
+        context.Expect(expectedLinks, bBatch ? TEXT("SinglePlacements batched") : TEXT("SinglePlacements from the hook"));
+    }
+
+    CVarAutoLinkBatchPlacements->Set(bWasBatching, ECVF_SetByCode);
+}
+
+// Two identical rows of lone buildables with nothing to link to. Linking the first row warms up the pass scratch (see
+// AutoLinkScratch.h), after which linking the second should make no heap allocations of AutoLink's own at all.
+void AutoLinkScenarioRunner::SteadyStateAllocations(AutoLinkScenarioContext& context)
+{
+    const double rowSpacing = 5000;
+    const double pieceSpacing = 2000;
+
+    TArray<AFGBuildable*> rows[2];
+    for (int32 row = 0; row < 2; ++row)
+    {
+        auto location = FVector(0, row * rowSpacing, 0);
+        rows[row].Add(context.Builder.SpawnBuildable(EAutoLinkScenarioClass::Constructor, location));
+        rows[row].Add(context.Builder.SpawnBelt(location + FVector(pieceSpacing, 0, 0), location + FVector(pieceSpacing + 400, 0, 0)));
+        rows[row].Add(context.Builder.SpawnPipe(location + FVector(pieceSpacing * 2, 0, 0), location + FVector(pieceSpacing * 2 + 400, 0, 0)));
+        rows[row].Add(context.Builder.SpawnTrack(location + FVector(pieceSpacing * 3, 0, 0), location + FVector(pieceSpacing * 3 + 1000, 0, 0)));
+        if (rows[row].Contains(nullptr))
+        {
+            context.Fail(TEXT("SteadyStateAllocations could not spawn a full row"));
+            return;
+        }
+    }
+
+    context.Link(rows[0]);
+    context.Link(rows[1]);
+
+    auto numAllocations = AutoLinkPassScope::GetLastStats().NumAllocations;
+    if (!AutoLinkAllocationCounter::IsInstalled())
+    {
+        UE_LOG(LogAutoLink, Warning, TEXT("SteadyStateAllocations: Allocations are only counted with -AutoLinkCountAllocations, so only the links are checked"));
+    }
+    else if (numAllocations > 0)
+    {
+        context.Fail(FString::Printf(TEXT("SteadyStateAllocations: the second pass made %d heap allocations"), numAllocations));
+    }
+
+    context.Expect(0, TEXT("SteadyStateAllocations"));
+}
+
+bool AutoLinkScenarioRunner::RunScenarios(UWorld* world, const FString& filter, TArray<AutoLinkScenarioResult>& outResults)
+{
+    struct Scenario
+    {
+        const TCHAR* Name;
+        void (*Run)(AutoLinkScenarioContext& context);
+    };
+
+    const Scenario scenarios[] = {
+        { TEXT("BeltGrid"), &BeltGrid },
+        { TEXT("LiftStacks"), &LiftStacks },
+        { TEXT("PipeManifold"), &PipeManifold },
+        { TEXT("RailYard"), &RailYard },
+        { TEXT("StorageDepotSwap"), &StorageDepotSwap },
+        { TEXT("SinglePlacements"), &SinglePlacements },
+        { TEXT("SteadyStateAllocations"), &SteadyStateAllocations },
+    };
+
+    if (!AutoLinkScenarioBuilder::LoadClasses())
+    {
+        return false;
+    }
+
+    AutoLinkConnectorIndex::EnsureBuilt(world); // The blueprint prefilter needs it, and building it shouldn't count against the first scenario
+
+    bool allPassed = true;
+    int32 slot = 0;
+    for (auto& scenario : scenarios)
+    {
+        if (!filter.IsEmpty() && !FString(scenario.Name).Contains(filter))
+        {
+            continue;
+        }
+
+        auto& result = outResults.AddDefaulted_GetRef();
+        result.Name = scenario.Name;
+        {
+            AutoLinkScenarioBuilder builder(world, ScenarioOrigin + FVector(slot++ * ScenarioSpacing, 0, 0));
+            AutoLinkScenarioContext context{ builder, result };
+            scenario.Run(context);
+        }
+
+        LogResult(result);
+        allPassed = allPassed && result.Passed();
+    }
+
+    return allPassed;
+}
+
+int32 AutoLinkScenarioRunner::SpawnStressLayout(AutoLinkScenarioBuilder& builder, const AutoLinkCore::StressLayout& layout)
+{
+    int32 numSpawned = 0;
+    for (auto& piece : layout.Pieces)
+    {
+        auto start = AutoLinkCoreBridge::ToUnreal(piece.Start);
+        auto end = AutoLinkCoreBridge::ToUnreal(piece.End);
+        auto startDirection = AutoLinkCoreBridge::ToUnreal(piece.StartDirection);
+        AFGBuildable* buildable = nullptr;
+        switch (piece.Type)
+        {
+        case AutoLinkCore::StressPieceType::Belt:
+            buildable = builder.SpawnBelt(start, end);
+            break;
+        case AutoLinkCore::StressPieceType::Lift:
+            buildable = builder.SpawnLift(start, end.Z - start.Z);
+            break;
+        case AutoLinkCore::StressPieceType::Pipe:
+            buildable = builder.SpawnPipe(start, end);
+            break;
+        case AutoLinkCore::StressPieceType::PipeJunction:
+            buildable = builder.SpawnBuildable(EAutoLinkScenarioClass::PipelineJunction, start);
+            break;
+        case AutoLinkCore::StressPieceType::Hyper:
+            buildable = builder.SpawnHyper(start, end, startDirection);
+            break;
+        case AutoLinkCore::StressPieceType::Track:
+            buildable = builder.SpawnTrack(start, end, startDirection);
+            break;
+        default:
+            break;
+        }
+
+        numSpawned += buildable ? 1 : 0;
+    }
+
+    return numSpawned;
+}
+
+bool AutoLinkScenarioRunner::RunStress(UWorld* world, AutoLinkCore::StressLayoutType type, uint32 size, uint64 seed, AutoLinkScenarioResult& outResult)
+{
+    if (size == 0)
+    {
+        size = AutoLinkCore::GetDefaultStressSize(type);
+    }
+
+    outResult.Name = FString::Printf(TEXT("%hs_%u_%llu"), AutoLinkCore::ToString(type), size, seed);
+    if (!AutoLinkScenarioBuilder::LoadClasses())
+    {
+        outResult.Failures.Add(TEXT("Could not load the buildable classes"));
+        return false;
+    }
+
+    AutoLinkConnectorIndex::EnsureBuilt(world);
+
+    {
+        AutoLinkScenarioBuilder builder(world, ScenarioOrigin);
+        AutoLinkScenarioContext context{ builder, outResult };
+
+        // Generate around the real junction so pipes meet its connectors exactly
+        AutoLinkCore::StressGeometry geometry;
+        if (type == AutoLinkCore::StressLayoutType::PipeManifold)
+        {
+            geometry.JunctionHalfSize = builder.MeasureJunctionHalfSize();
+            if (geometry.JunctionHalfSize <= 0)
+            {
+                context.Fail(TEXT("Could not spawn a junction to measure"));
+                return false;
+            }
+        }
+
+        AutoLinkCore::StressLayout layout;
+        AutoLinkCore::GenerateStressLayout(type, size, seed, geometry, layout);
+        auto numSpawned = SpawnStressLayout(builder, layout);
+        if (numSpawned != (int32)layout.Pieces.size())
+        {
+            context.Fail(FString::Printf(TEXT("Only spawned %d of %d pieces"), numSpawned, (int32)layout.Pieces.size()));
+        }
+
+        context.LinkAll();
+        context.Expect(layout.ExpectedLinks, *outResult.Name);
+    }
+
+    LogResult(outResult);
+    return outResult.Passed();
+}
+
+int32 AutoLinkScenarioRunner::SpawnFactoryModule(AutoLinkScenarioBuilder& builder, const FVector& location)
+{
+    const float beltLength = 400;
+    const float liftHeight = 400;
+
+    // Each piece goes where the last one's output actually is, so the module holds together whatever the real meshes are
+    auto constructor = builder.SpawnBuildable(EAutoLinkScenarioClass::Constructor, location);
+    auto constructorOutput = AutoLinkScenarioBuilder::FindConnection(constructor, EFactoryConnectionDirection::FCD_OUTPUT);
+    if (!constructorOutput)
+    {
+        return 0;
+    }
+
+    auto direction = constructorOutput->GetConnectorNormal();
+    auto beltStart = constructorOutput->GetConnectorLocation() - builder.Origin;
+    auto beltEnd = beltStart + direction * beltLength;
+    auto splitter = builder.SpawnBelt(beltStart, beltEnd) ? builder.SpawnOnInput(EAutoLinkScenarioClass::Splitter, beltEnd, direction) : nullptr;
+    auto splitterOutput = AutoLinkScenarioBuilder::FindConnection(splitter, EFactoryConnectionDirection::FCD_OUTPUT, direction);
+    if (!splitterOutput)
+    {
+        return 0;
+    }
+
+    beltStart = splitterOutput->GetConnectorLocation() - builder.Origin;
+    beltEnd = beltStart + direction * beltLength;
+    auto lift = builder.SpawnBelt(beltStart, beltEnd) ? builder.SpawnLift(beltEnd, liftHeight, direction.Rotation()) : nullptr;
+    auto liftOutput = AutoLinkScenarioBuilder::FindConnection(lift, EFactoryConnectionDirection::FCD_OUTPUT);
+    if (!liftOutput)
+    {
+        return 0;
+    }
+
+    auto storage = builder.SpawnOnInput(EAutoLinkScenarioClass::StorageContainer, liftOutput->GetConnectorLocation() - builder.Origin, liftOutput->GetConnectorNormal());
+
+    // Constructor to belt, belt to splitter, splitter to belt, belt to lift and lift to storage
+    return storage ? 5 : 0;
+}
+
+bool AutoLinkScenarioRunner::RunBench(UWorld* world, int32 columns, int32 rows, AutoLinkScenarioResult& outResult)
+{
+    // Far enough apart that modules never see each other, so every module costs the same
+    const double moduleSpacing = 5000;
+
+    outResult.Name = FString::Printf(TEXT("Bench_%dx%d"), columns, rows);
+    if (!AutoLinkScenarioBuilder::LoadClasses())
+    {
+        outResult.Failures.Add(TEXT("Could not load the buildable classes"));
+        return false;
+    }
+
+    AutoLinkConnectorIndex::EnsureBuilt(world);
+
+    {
+        AutoLinkScenarioBuilder builder(world, ScenarioOrigin);
+        AutoLinkScenarioContext context{ builder, outResult };
+
+        int32 expectedLinks = 0;
+        int32 numFailedModules = 0;
+        for (int32 column = 0; column < columns; ++column)
+        {
+            for (int32 row = 0; row < rows; ++row)
+            {
+                auto moduleLinks = SpawnFactoryModule(builder, FVector(column * moduleSpacing, row * moduleSpacing, 0));
+                expectedLinks += moduleLinks;
+                numFailedModules += moduleLinks == 0 ? 1 : 0;
+            }
+        }
+
+        if (numFailedModules > 0)
+        {
+            context.Fail(FString::Printf(TEXT("%d modules could not be spawned completely"), numFailedModules));
+        }
+
+        context.LinkAll(TEXT("AutoLink.Bench"));
+        context.Expect(expectedLinks, *outResult.Name);
+    }
+
+    LogResult(outResult);
+    return outResult.Passed();
+}
+
+void AutoLinkScenarioRunner::LogResult(const AutoLinkScenarioResult& result)
+{
+    UE_LOG(LogAutoLink, Display, TEXT("Scenario %s: %s. %d of %d links from %d buildables in %d passes, %.3f ms. HitScans=%d OverlapScans=%d PrefilteredScans=%d SkippedScans=%d SkippedChildren=%d HitActors=%d Candidates=%d TrackRebuilds=%d (%.3f ms) Allocations=%s"),
+        *result.Name,
+        result.Passed() ? TEXT("PASSED") : TEXT("FAILED"),
+        result.ActualLinks,
+        result.ExpectedLinks,
+        result.NumBuildables,
+        result.NumPasses,
+        result.LinkMs,
+        result.NumHitScans,
+        result.NumOverlapScans,
+        result.NumPrefilteredScans,
+        result.NumSkippedScans,
+        result.NumSkippedChildren,
+        result.NumHitActors,
+        result.NumCandidates,
+        result.NumTrackRebuilds,
+        result.TrackRebuildMs,
+        result.NumAllocations == NumAllocationsUnavailable ? TEXT("unavailable") : *FString::FromInt(result.NumAllocations));
+
+    for (auto& failure : result.Failures)
+    {
+        UE_LOG(LogAutoLink, Error, TEXT("Scenario %s: %s"), *result.Name, *failure);
+    }
+}
+
+FString AutoLinkScenarioRunner::GetResultsFilePath()
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("AutoLink"), TEXT("ScenarioResults.json"));
+}
+
+FString AutoLinkScenarioRunner::GetBenchResultsFilePath()
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("AutoLink"), TEXT("BenchResults.json"));
+}
+
+FString AutoLinkScenarioRunner::GetStressResultsFilePath()
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("AutoLink"), TEXT("StressResults.json"));
+}
+
+FString AutoLinkScenarioRunner::GetBaselineFilePath(const FString& resultsFilePath)
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("AutoLink"), TEXT("Baselines"), FPaths::GetCleanFilename(resultsFilePath));
+}
+
+// Every counter a result records and its name in the results files
+static const TPair<const TCHAR*, int32 AutoLinkScenarioResult::*> ResultCounters[] =
+{
+    { TEXT("ExpectedLinks"), &AutoLinkScenarioResult::ExpectedLinks },
+    { TEXT("ActualLinks"), &AutoLinkScenarioResult::ActualLinks },
+    { TEXT("Buildables"), &AutoLinkScenarioResult::NumBuildables },
+    { TEXT("OpenConnectors"), &AutoLinkScenarioResult::NumOpenConnectors },
+    { TEXT("Passes"), &AutoLinkScenarioResult::NumPasses },
+    { TEXT("HitScans"), &AutoLinkScenarioResult::NumHitScans },
+    { TEXT("OverlapScans"), &AutoLinkScenarioResult::NumOverlapScans },
+    { TEXT("PrefilteredScans"), &AutoLinkScenarioResult::NumPrefilteredScans },
+    { TEXT("SkippedScans"), &AutoLinkScenarioResult::NumSkippedScans },
+    { TEXT("SkippedChildren"), &AutoLinkScenarioResult::NumSkippedChildren },
+    { TEXT("HitActors"), &AutoLinkScenarioResult::NumHitActors },
+    { TEXT("Candidates"), &AutoLinkScenarioResult::NumCandidates },
+    { TEXT("TrackRebuilds"), &AutoLinkScenarioResult::NumTrackRebuilds },
+    { TEXT("Allocations"), &AutoLinkScenarioResult::NumAllocations },
+};
+
+// Same for timings
+static const TPair<const TCHAR*, double AutoLinkScenarioResult::*> ResultTimings[] =
+{
+    { TEXT("LinkMs"), &AutoLinkScenarioResult::LinkMs },
+    { TEXT("TrackRebuildMs"), &AutoLinkScenarioResult::TrackRebuildMs },
+};
+
+bool AutoLinkScenarioRunner::WriteResults(const TArray<AutoLinkScenarioResult>& results, const FString& filePath)
+{
+    TArray<TSharedPtr<FJsonValue>> scenarioValues;
+    for (auto& result : results)
+    {
+        auto scenarioObject = MakeShared<FJsonObject>();
+        scenarioObject->SetStringField(TEXT("Name"), result.Name);
+        scenarioObject->SetBoolField(TEXT("Passed"), result.Passed());
+        for (auto& counter : ResultCounters)
+        {
+            scenarioObject->SetNumberField(counter.Key, result.*counter.Value);
+        }
+
+        for (auto& timing : ResultTimings)
+        {
+            scenarioObject->SetNumberField(timing.Key, result.*timing.Value);
+        }
+
+        TArray<TSharedPtr<FJsonValue>> failureValues;
+        for (auto& failure : result.Failures)
+        {
+            failureValues.Add(MakeShared<FJsonValueString>(failure));
+        }
+        scenarioObject->SetArrayField(TEXT("Failures"), failureValues);
+
+        scenarioValues.Add(MakeShared<FJsonValueObject>(scenarioObject));
+    }
+
+    auto rootObject = MakeShared<FJsonObject>();
+    rootObject->SetStringField(TEXT("Time"), FDateTime::UtcNow().ToIso8601());
+    rootObject->SetArrayField(TEXT("Scenarios"), scenarioValues);
+
+    FString json;
+    auto writer = TJsonWriterFactory<>::Create(&json);
+    if (!FJsonSerializer::Serialize(rootObject, writer))
+    {
+        return false;
+    }
+
+    FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(filePath));
+    return FFileHelper::SaveStringToFile(json, *filePath);
+}
+
+bool AutoLinkScenarioRunner::ReadResults(const FString& filePath, TArray<AutoLinkScenarioResult>& outResults)
+{
+    FString json;
+    if (!FFileHelper::LoadFileToString(json, *filePath))
+    {
+        return false;
+    }
+
+    TSharedPtr<FJsonObject> rootObject;
+    const TArray<TSharedPtr<FJsonValue>>* scenarioValues;
+    if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(json), rootObject)
+        || !rootObject.IsValid()
+        || !rootObject->TryGetArrayField(TEXT("Scenarios"), scenarioValues))
+    {
+        return false;
+    }
+
+    for (auto& scenarioValue : *scenarioValues)
+    {
+        const TSharedPtr<FJsonObject>* scenarioObject;
+        if (!scenarioValue->TryGetObject(scenarioObject))
+        {
+            return false;
+        }
+
+        // Counters added since the file was written stay at 0
+        auto& result = outResults.AddDefaulted_GetRef();
+        (*scenarioObject)->TryGetStringField(TEXT("Name"), result.Name);
+        for (auto& counter : ResultCounters)
+        {
+            (*scenarioObject)->TryGetNumberField(counter.Key, result.*counter.Value);
+        }
+
+        for (auto& timing : ResultTimings)
+        {
+            (*scenarioObject)->TryGetNumberField(timing.Key, result.*timing.Value);
+        }
+
+        (*scenarioObject)->TryGetStringArrayField(TEXT("Failures"), result.Failures);
+    }
+
+    return true;
+}
+
+// The fastest run of every scenario, by name. Repeated runs (like AutoLink.Bench's) share a name.
+static TMap<FString, const AutoLinkScenarioResult*> GetFastestResults(const TArray<AutoLinkScenarioResult>& results)
+{
+    TMap<FString, const AutoLinkScenarioResult*> fastestResults;
+    for (auto& result : results)
+    {
+        auto& fastest = fastestResults.FindOrAdd(result.Name, &result);
+        if (result.LinkMs < fastest->LinkMs)
+        {
+            fastest = &result;
+        }
+    }
+
+    return fastestResults;
+}
+
+bool AutoLinkScenarioRunner::CompareToBaseline(
+    const TArray<AutoLinkScenarioResult>& results,
+    const TArray<AutoLinkScenarioResult>& baseline,
+    float maxSlowdownPercent,
+    TArray<FString>& outRegressions)
+{
+    // Differences this small are mostly timer and scheduling noise, so they never count as slower
+    const double NoiseFloorMs = .05;
+
+    const int32 numStartingRegressions = outRegressions.Num();
+    auto baselineResults = GetFastestResults(baseline);
+    for (auto& nameAndResult : GetFastestResults(results))
+    {
+        auto baselineResult = baselineResults.FindRef(nameAndResult.Key);
+        if (!baselineResult)
+        {
+            UE_LOG(LogAutoLink, Display, TEXT("Scenario %s: Not in the baseline, so not compared"), *nameAndResult.Key);
+            continue;
+        }
+
+        // Counters have to match on every run, not just the fastest
+        for (auto& result : results)
+        {
+            if (result.Name != nameAndResult.Key)
+            {
+                continue;
+            }
+
+            for (auto& counter : ResultCounters)
+            {
+                // Allocations can only be compared when both runs counted them
+                if (counter.Value == &AutoLinkScenarioResult::NumAllocations
+                    && (result.NumAllocations == NumAllocationsUnavailable || baselineResult->NumAllocations == NumAllocationsUnavailable))
+                {
+                    continue;
+                }
+
+                if (result.*counter.Value != baselineResult->*counter.Value)
+                {
+                    outRegressions.Add(FString::Printf(TEXT("%s: %s is %d but was %d"), *result.Name, counter.Key, result.*counter.Value, baselineResult->*counter.Value));
+                }
+            }
+        }
+
+        for (auto& timing : ResultTimings)
+        {
+            const double ms = nameAndResult.Value->*timing.Value;
+            const double baselineMs = baselineResult->*timing.Value;
+            if (ms - baselineMs > NoiseFloorMs && ms > baselineMs * (1 + maxSlowdownPercent / 100))
+            {
+                outRegressions.Add(FString::Printf(TEXT("%s: %s is %.3f but was %.3f (%+.1f%%, at most %+.1f%% allowed)"),
+                    *nameAndResult.Key,
+                    timing.Key,
+                    ms,
+                    baselineMs,
+                    baselineMs > 0 ? (ms / baselineMs - 1) * 100 : 100.0,
+                    maxSlowdownPercent));
+            }
+        }
+    }
+
+    return outRegressions.Num() == numStartingRegressions;
+}
+
+// Linking only happens where buildables are authoritative
+static bool CanRunIn(UWorld* world, const TCHAR* command)
+{
+    if (!world || !world->IsGameWorld() || world->GetNetMode() == NM_Client)
+    {
+        UE_LOG(LogAutoLink, Error, TEXT("%s needs a game world with authority (a single player game, host or dedicated server)"), command);
+        return false;
+    }
+
+    return true;
+}
+
+// What the scenario commands do with the baseline for their results file
+enum class EAutoLinkBaselineMode : uint8
+{
+    None,
+    Save,  // savebaseline: the results become the new baseline
+    Check, // checkbaseline: the command fails if the results regressed from the baseline
+};
+
+static bool ParseBaselineArg(const FString& arg, EAutoLinkBaselineMode& outMode)
+{
+    if (arg.Equals(TEXT("savebaseline"), ESearchCase::IgnoreCase))
+    {
+        outMode = EAutoLinkBaselineMode::Save;
+        return true;
+    }
+
+    if (arg.Equals(TEXT("checkbaseline"), ESearchCase::IgnoreCase))
+    {
+        outMode = EAutoLinkBaselineMode::Check;
+        return true;
+    }
+
+    return false;
+}
+
+static bool WriteResultsFromConsole(const TArray<AutoLinkScenarioResult>& results, const FString& filePath, const TCHAR* command, bool allPassed, EAutoLinkBaselineMode baselineMode)
+{
+    if (!AutoLinkScenarioRunner::WriteResults(results, filePath))
+    {
+        UE_LOG(LogAutoLink, Error, TEXT("%s: Could not write results to %s"), command, *filePath);
+        return false;
+    }
+
+    UE_LOG(LogAutoLink, Display, TEXT("%s: %d scenarios %s. Wrote results to %s"), command, results.Num(), allPassed ? TEXT("passed") : TEXT("did NOT all pass"), *filePath);
+
+    const FString baselineFilePath = AutoLinkScenarioRunner::GetBaselineFilePath(filePath);
+    if (baselineMode == EAutoLinkBaselineMode::Save)
+    {
+        // A baseline with failures in it would let the same failures through as matching it
+        if (!allPassed)
+        {
+            UE_LOG(LogAutoLink, Error, TEXT("%s: Not saving a baseline from results that didn't all pass"), command);
+            return false;
+        }
+
+        if (!AutoLinkScenarioRunner::WriteResults(results, baselineFilePath))
+        {
+            UE_LOG(LogAutoLink, Error, TEXT("%s: Could not write the baseline to %s"), command, *baselineFilePath);
+            return false;
+        }
+
+        UE_LOG(LogAutoLink, Display, TEXT("%s: Saved the results as the baseline in %s"), command, *baselineFilePath);
+    }
+    else if (baselineMode == EAutoLinkBaselineMode::Check)
+    {
+        TArray<AutoLinkScenarioResult> baseline;
+        if (!AutoLinkScenarioRunner::ReadResults(baselineFilePath, baseline))
+        {
+            UE_LOG(LogAutoLink, Error, TEXT("%s: Could not read a baseline from %s. Run with savebaseline to make one."), command, *baselineFilePath);
+            return false;
+        }
+
+        TArray<FString> regressions;
+        const float maxSlowdownPercent = CVarAutoLinkBaselineMaxSlowdownPercent.GetValueOnGameThread();
+        if (!AutoLinkScenarioRunner::CompareToBaseline(results, baseline, maxSlowdownPercent, regressions))
+        {
+            for (auto& regression : regressions)
+            {
+                UE_LOG(LogAutoLink, Error, TEXT("%s: Regressed from the baseline. %s"), command, *regression);
+            }
+
+            return false;
+        }
+
+        UE_LOG(LogAutoLink, Display, TEXT("%s: No regressions from the baseline in %s"), command, *baselineFilePath);
+    }
+
+    return true;
+}
+
+static void RunScenariosFromConsole(const TArray<FString>& args, UWorld* world)
+{
+    FString filter;
+    bool quitWhenDone = false;
+    EAutoLinkBaselineMode baselineMode = EAutoLinkBaselineMode::None;
+    for (auto& arg : args)
+    {
+        if (arg.Equals(TEXT("quit"), ESearchCase::IgnoreCase))
+        {
+            quitWhenDone = true;
+        }
+        else if (ParseBaselineArg(arg, baselineMode))
+        {
+            continue;
+        }
+        else
+        {
+            filter = arg;
+        }
+    }
+
+    bool allPassed = false;
+    TArray<AutoLinkScenarioResult> results;
+    if (CanRunIn(world, TEXT("AutoLink.RunScenarios")))
+    {
+        allPassed = AutoLinkScenarioRunner::RunScenarios(world, filter, results);
+        allPassed = WriteResultsFromConsole(results, AutoLinkScenarioRunner::GetResultsFilePath(), TEXT("AutoLink.RunScenarios"), allPassed, baselineMode) && allPassed;
+    }
+
+    if (quitWhenDone)
+    {
+        FPlatformMisc::RequestExitWithStatus(false, allPassed ? 0 : 1);
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs RunScenariosCommand(
+    TEXT("AutoLink.RunScenarios"),
+    TEXT("Runs AutoLink's synthetic link scenarios in the current world and writes results to Saved/AutoLink/ScenarioResults.json. ")
+    TEXT("Usage: AutoLink.RunScenarios [NameFilter] [savebaseline|checkbaseline] [quit]. With quit, the process exits afterwards with a non-zero code if any scenario failed. ")
+    TEXT("savebaseline stores the results in Saved/AutoLink/Baselines and checkbaseline fails on any counter that changed or time that slowed by more than AutoLink.BaselineMaxSlowdownPercent since."),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunScenariosFromConsole));
+
+static void RunStressFromConsole(const TArray<FString>& args, UWorld* world)
+{
+    FString layoutName;
+    uint32 size = 0;
+    uint64 seed = 1;
+    int32 numNumbers = 0;
+    bool quitWhenDone = false;
+    EAutoLinkBaselineMode baselineMode = EAutoLinkBaselineMode::None;
+    for (auto& arg : args)
+    {
+        if (arg.Equals(TEXT("quit"), ESearchCase::IgnoreCase))
+        {
+            quitWhenDone = true;
+        }
+        else if (ParseBaselineArg(arg, baselineMode))
+        {
+            continue;
+        }
+        else if (arg.IsNumeric())
+        {
+            // Size first, then seed
+            if (numNumbers++ == 0)
+            {
+                size = (uint32)FCString::Strtoui64(*arg, nullptr, 10);
+            }
+            else
+            {
+                seed = FCString::Strtoui64(*arg, nullptr, 10);
+            }
+        }
+        else
+        {
+            layoutName = arg;
+        }
+    }
+
+    TArray<AutoLinkCore::StressLayoutType> types;
+    for (int32 type = 0; type < (int32)AutoLinkCore::StressLayoutType::Num; ++type)
+    {
+        if (layoutName.Equals(TEXT("all"), ESearchCase::IgnoreCase) || layoutName.Equals(AutoLinkCore::ToString((AutoLinkCore::StressLayoutType)type), ESearchCase::IgnoreCase))
+        {
+            types.Add((AutoLinkCore::StressLayoutType)type);
+        }
+    }
+
+    bool allPassed = false;
+    TArray<AutoLinkScenarioResult> results;
+    if (types.Num() == 0)
+    {
+        UE_LOG(LogAutoLink, Error, TEXT("AutoLink.RunStress: Unknown layout '%s'. Use BeltManifold, LiftStacks, PipeManifold, HyperSpaghetti, RailYard or all."), *layoutName);
+    }
+    else if (CanRunIn(world, TEXT("AutoLink.RunStress")))
+    {
+        allPassed = true;
+        for (auto type : types)
+        {
+            allPassed = AutoLinkScenarioRunner::RunStress(world, type, size, seed, results.AddDefaulted_GetRef()) && allPassed;
+        }
+
+        allPassed = WriteResultsFromConsole(results, AutoLinkScenarioRunner::GetStressResultsFilePath(), TEXT("AutoLink.RunStress"), allPassed, baselineMode) && allPassed;
+    }
+
+    if (quitWhenDone)
+    {
+        FPlatformMisc::RequestExitWithStatus(false, allPassed ? 0 : 1);
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs RunStressCommand(
+    TEXT("AutoLink.RunStress"),
+    TEXT("Spawns one of AutoLink's procedural stress layouts in the current world, links it, cleans it up and writes results to Saved/AutoLink/StressResults.json. ")
+    TEXT("Usage: AutoLink.RunStress <BeltManifold|LiftStacks|PipeManifold|HyperSpaghetti|RailYard|all> [Size] [Seed] [savebaseline|checkbaseline] [quit]. The same layout, size and seed always spawn the same thing."),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunStressFromConsole));
+
+static void RunBenchFromConsole(const TArray<FString>& args, UWorld* world)
+{
+    int32 numbers[] = { 10, 10, 3 }; // Columns, rows and repeats
+    int32 numNumbers = 0;
+    bool quitWhenDone = false;
+    EAutoLinkBaselineMode baselineMode = EAutoLinkBaselineMode::None;
+    for (auto& arg : args)
+    {
+        if (arg.Equals(TEXT("quit"), ESearchCase::IgnoreCase))
+        {
+            quitWhenDone = true;
+        }
+        else if (ParseBaselineArg(arg, baselineMode))
+        {
+            continue;
+        }
+        else if (arg.IsNumeric() && numNumbers < UE_ARRAY_COUNT(numbers))
+        {
+            numbers[numNumbers++] = FMath::Max(1, FCString::Atoi(*arg));
+        }
+    }
+
+    bool allPassed = false;
+    TArray<AutoLinkScenarioResult> results;
+    if (CanRunIn(world, TEXT("AutoLink.Bench")))
+    {
+        // Linking changes what it links, so every repeat spawns a fresh grid
+        allPassed = true;
+        for (int32 repeat = 0; repeat < numbers[2]; ++repeat)
+        {
+            allPassed = AutoLinkScenarioRunner::RunBench(world, numbers[0], numbers[1], results.AddDefaulted_GetRef()) && allPassed;
+        }
+
+        double bestMs = DBL_MAX;
+        double totalMs = 0;
+        for (auto& result : results)
+        {
+            bestMs = FMath::Min(bestMs, result.LinkMs);
+            totalMs += result.LinkMs;
+        }
+
+        auto& last = results.Last();
+        UE_LOG(LogAutoLink, Display, TEXT("AutoLink.Bench: %dx%d modules, %d buildables, %d open connectors, %d of %d links. Best %.3f ms (%.3f us per connector), average %.3f ms over %d runs."),
+            numbers[0],
+            numbers[1],
+            last.NumBuildables,
+            last.NumOpenConnectors,
+            last.ActualLinks,
+            last.ExpectedLinks,
+            bestMs,
+            last.NumOpenConnectors > 0 ? bestMs * 1000 / last.NumOpenConnectors : 0.0,
+            totalMs / results.Num(),
+            results.Num());
+
+        allPassed = WriteResultsFromConsole(results, AutoLinkScenarioRunner::GetBenchResultsFilePath(), TEXT("AutoLink.Bench"), allPassed, baselineMode) && allPassed;
+    }
+
+    if (quitWhenDone)
+    {
+        FPlatformMisc::RequestExitWithStatus(false, allPassed ? 0 : 1);
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchCommand(
+    TEXT("AutoLink.Bench"),
+    TEXT("Spawns a grid of factory modules (constructor, belt, splitter, belt, lift, storage container) high above the current world, links it the way a blueprint is linked, ")
+    TEXT("reports timings and query counts, cleans up and writes results to Saved/AutoLink/BenchResults.json. Usage: AutoLink.Bench [Columns] [Rows] [Repeats] [savebaseline|checkbaseline] [quit]. Defaults to 10 10 3."),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunBenchFromConsole));
@@ -0,0 +1,218 @@
+#include "AutoLinkShadow.h"
+
+#include "AutoLinkConnectorIndex.h"
+#include "AutoLinkConsoleVariables.h"
+#include "AutoLinkCore/AutoLinkMatcher.h"
+#include "AutoLinkLogCategory.h"
+
+static double GetSpeedup(uint64 legacyCycles, uint64 indexCycles)
+{
+    return indexCycles > 0 ? (double)legacyCycles / indexCycles : 0.0;
+}
+
+void AutoLinkShadow::BeginPass(const TCHAR* source)
+{
+    // Read once per pass, like the hitch threshold, so toggling it mid-pass can't leave a buildable half compared
+    bIsActive = CVarAutoLinkShadowMode.GetValueOnGameThread();
+
+    // The index side uses the AutoLinkCore rules, which never make attachment links, so every one would be a mismatch
+    if (bIsActive && CVarAutoLinkAttachmentLinks.GetValueOnGameThread())
+    {
+        if (!bHasWarnedAttachmentLinks)
+        {
+            UE_LOG(LogAutoLink, Warning, TEXT("AutoLinkShadow: Not comparing while AutoLink.AttachmentLinks is on"));
+            bHasWarnedAttachmentLinks = true;
+        }
+
+        bIsActive = false;
+    }
+
+    if (!bIsActive)
+    {
+        return;
+    }
+
+    PassSource = source ? source : TEXT("Unknown");
+    PassBuildables = 0;
+    PassMismatches = 0;
+    PassLegacyCycles = 0;
+    PassIndexCycles = 0;
+}
+
+void AutoLinkShadow::EndPass()
+{
+    if (!bIsActive)
+    {
+        return;
+    }
+
+    bIsActive = false;
+    if (PassBuildables == 0)
+    {
+        return;
+    }
+
+    ++NumPasses;
+    TotalLegacyCycles += PassLegacyCycles;
+    TotalIndexCycles += PassIndexCycles;
+
+    UE_LOG(LogAutoLink, Log, TEXT("AutoLinkShadow: %s linked %d buildables. Legacy %.3f ms, index %.3f ms (%.1fx), %d differ. Session: %d passes, %d of %d buildables differ, %.1fx."),
+        PassSource,
+        PassBuildables,
+        FPlatformTime::ToMilliseconds64(PassLegacyCycles),
+        FPlatformTime::ToMilliseconds64(PassIndexCycles),
+        GetSpeedup(PassLegacyCycles, PassIndexCycles),
+        PassMismatches,
+        NumPasses,
+        NumMismatches,
+        NumBuildables,
+        GetSpeedup(TotalLegacyCycles, TotalIndexCycles));
+}
+
+void AutoLinkShadow::BeginBuildable(AFGBuildable* buildable)
+{
+    // Building the index is a one-off per world and would swamp the timing of whichever placement happened to trigger it
+    AutoLinkConnectorIndex::EnsureBuilt(buildable->GetWorld());
+
+    const auto startCycles = FPlatformTime::Cycles64();
+
+    std::vector<AutoLinkCore::Connector> connectors;
+    TArray<UActorComponent*> components;
+    AutoLinkConnectorExport::AppendConnectors(buildable, connectors, ClassTable, &components);
+    const size_t numOwnConnectors = connectors.size();
+
+    // Candidates come from the index's snapshot, the way a planner off the game thread would see them
+    const auto snapshot = AutoLinkConnectorIndex::GetSnapshot();
+    TSet<UActorComponent*> seenComponents(components);
+    std::vector<AutoLinkCore::Connector> nearbyConnectors;
+    TArray<AutoLinkSnapshotHandle> nearbyHandles;
+    for (size_t i = 0; i < numOwnConnectors && snapshot.IsValid(); ++i)
+    {
+        if (!connectors[i].IsOpen())
+        {
+            continue;
+        }
+
+        nearbyConnectors.clear();
+        nearbyHandles.Reset();
+        snapshot->FindNearby(connectors[i].Location, nearbyConnectors, nearbyHandles);
+        for (int32 j = 0; j < nearbyHandles.Num(); ++j)
+        {
+            auto component = nearbyHandles[j].Component.Get();
+            bool isAlreadySeen = false;
+            seenComponents.Add(component, &isAlreadySeen);
+            if (component && !isAlreadySeen)
+            {
+                connectors.push_back(nearbyConnectors[j]);
+                components.Add(component);
+            }
+        }
+    }
+
+    // One buildable's neighbourhood is small enough that brute force beats setting up a grid
+    std::vector<AutoLinkCore::LinkDecision> decisions;
+    AutoLinkCore::FindLinksFor(connectors.data(), connectors.size(), numOwnConnectors, AutoLinkCore::MatchStrategy::BruteForce, decisions);
+
+    IndexLinks.Reset();
+    for (const auto& decision : decisions)
+    {
+        IndexLinks.Add(MakePair(components[decision.Connector], components[decision.Candidate]));
+    }
+
+    PassIndexCycles += FPlatformTime::Cycles64() - startCycles;
+
+    bIsInBuildable = true;
+    LegacyLinks.Reset();
+    LegacyStartCycles = FPlatformTime::Cycles64();
+}
+
+void AutoLinkShadow::EndBuildable(AFGBuildable* buildable)
+{
+    if (!bIsInBuildable)
+    {
+        return;
+    }
+
+    PassLegacyCycles += FPlatformTime::Cycles64() - LegacyStartCycles;
+    bIsInBuildable = false;
+    ++PassBuildables;
+    ++NumBuildables;
+
+    // The buildable may not have reached AFGBuildableSubsystem yet, and the next buildable in a blueprint can link to it
+    AutoLinkConnectorIndex::AddBuildable(buildable);
+
+    auto byPointers = [](const LinkPair& a, const LinkPair& b)
+    {
+        return a.Key != b.Key ? a.Key < b.Key : a.Value < b.Value;
+    };
+
+    LegacyLinks.Sort(byPointers);
+    IndexLinks.Sort(byPointers);
+    if (LegacyLinks == IndexLinks)
+    {
+        return;
+    }
+
+    ++PassMismatches;
+    ++NumMismatches;
+
+    TArray<LinkPair> legacyOnly;
+    TArray<LinkPair> indexOnly;
+    for (const auto& link : LegacyLinks)
+    {
+        if (!IndexLinks.Contains(link))
+        {
+            legacyOnly.Add(link);
+        }
+    }
+
+    for (const auto& link : IndexLinks)
+    {
+        if (!LegacyLinks.Contains(link))
+        {
+            indexOnly.Add(link);
+        }
+    }
+
+    UE_LOG(LogAutoLink, Warning, TEXT("AutoLinkShadow: %s (%s) at %s. Legacy only: %s. Index only: %s."),
+        *buildable->GetName(),
+        *buildable->GetClass()->GetName(),
+        *buildable->GetActorLocation().ToString(),
+        *DescribeLinks(legacyOnly),
+        *DescribeLinks(indexOnly));
+}
+
+void AutoLinkShadow::RecordLink(const UActorComponent* connection, const UActorComponent* candidate)
+{
+    if (bIsInBuildable)
+    {
+        LegacyLinks.Add(MakePair(connection, candidate));
+    }
+}
+
+AutoLinkShadow::LinkPair AutoLinkShadow::MakePair(const UActorComponent* first, const UActorComponent* second)
+{
+    // Either side can be the one that was being linked, so pairs are compared unordered
+    return first < second ? LinkPair(first, second) : LinkPair(second, first);
+}
+
+FString AutoLinkShadow::DescribeLinks(const TArray<LinkPair>& links)
+{
+    if (links.Num() == 0)
+    {
+        return TEXT("none");
+    }
+
+    auto describe = [](const UActorComponent* component)
+    {
+        return FString::Printf(TEXT("%s.%s"), *GetNameSafe(component->GetOwner()), *component->GetName());
+    };
+
+    FString description;
+    for (const auto& link : links)
+    {
+        description.Appendf(TEXT("%s%s <-> %s"), description.IsEmpty() ? TEXT("") : TEXT(", "), *describe(link.Key), *describe(link.Value));
+    }
+
+    return description;
+}
@@ -0,0 +1,249 @@
+#include "AutoLinkSpeculativePlan.h"
+
+#include "AutoLinkBlueprintManifest.h"
+#include "AutoLinkBlueprintPrefilter.h"
+#include "AutoLinkConsoleVariables.h"
+#include "AutoLinkCore/AutoLinkGeometry.h"
+#include "AutoLinkLogMacros.h"
+
+#include "AbstractInstanceManager.h"
+#include "Engine/World.h"
+#include "Hash/CityHash.h"
+
+// The furthest the FindAndLinkCompatible* functions scan from a connector of each kind: belts along their normal up to the
+// lift distance, rails and pipes in 30 and 50 unit spheres, hypertubes 10 units along their normal
+static float GetPlannedRadius(AutoLinkCore::ConnectorKind kind)
+{
+    return kind == AutoLinkCore::ConnectorKind::Belt ? AutoLinkCore::Tolerances::MaxBeltSearchDistance : 50.0f;
+}
+
+static FIntVector GetScanKey(const FVector& location)
+{
+    return FIntVector(FMath::RoundToInt(location.X), FMath::RoundToInt(location.Y), FMath::RoundToInt(location.Z));
+}
+
+void AutoLinkSpeculativePlan::OnHologramMoved(const AActor* hologram)
+{
+    const float delayMs = CVarAutoLinkSpeculativePlanDelayMs.GetValueOnGameThread();
+    if (delayMs < 0 || !Manifest.IsValid() || bIsConstructing)
+    {
+        return;
+    }
+
+    // Whatever blueprint hologram moves next is taken to be the same blueprint again. If it isn't, the signature check when it
+    // is built turns the plan down.
+    const auto frame = HologramToFrame * hologram->GetActorTransform();
+    const auto key = GetTransformKey(frame);
+    const double now = FPlatformTime::Seconds();
+    if (key != PlanKey)
+    {
+        Drop();
+        PlanKey = key;
+        StillSinceSeconds = now;
+        return;
+    }
+
+    if (bIsStarted || (now - StillSinceSeconds) * 1000 < delayMs)
+    {
+        return;
+    }
+
+    Start(hologram->GetWorld(), frame, hologram);
+}
+
+void AutoLinkSpeculativePlan::BeginConstruct(const AActor* hologram)
+{
+    bIsConstructing = true;
+
+    // The children this adds to the world are the ones the plan is for, so they don't count as changes
+    bIsCommitted = bIsStarted
+        && NumScansDone == Scans.Num()
+        && PlanGeneration == Generation
+        && PlanKey == GetTransformKey(HologramToFrame * hologram->GetActorTransform());
+
+    AL_LOG("AutoLinkSpeculativePlan::BeginConstruct: Plan with %d scans is %s", Scans.Num(), bIsCommitted ? TEXT("committed") : TEXT("dropped"));
+    if (!bIsCommitted)
+    {
+        Drop();
+    }
+}
+
+void AutoLinkSpeculativePlan::EndConstruct(const AActor* hologram, const TArray<AActor*>& children)
+{
+    bIsConstructing = false;
+
+    const auto frame = AutoLinkBlueprintManifest::GetFrame(children);
+    HologramToFrame = frame.GetRelativeTransform(hologram->GetActorTransform());
+    ConstructedFrameKey = GetTransformKey(frame);
+}
+
+void AutoLinkSpeculativePlan::NoteWorldChanged()
+{
+    if (!bIsConstructing)
+    {
+        ++Generation;
+    }
+}
+
+bool AutoLinkSpeculativePlan::FindPlannedActors(const FVector& location, AActor* ignoreActor, AutoLinkScratchArray<AActor*>& outActors)
+{
+    if (!bIsActive)
+    {
+        return false;
+    }
+
+    auto scanIndex = ScanIndices.Find(GetScanKey(location));
+    if (!scanIndex)
+    {
+        AL_LOG("AutoLinkSpeculativePlan::FindPlannedActors: Nothing planned at %s", *location.ToString());
+        return false;
+    }
+
+    for (auto& weakActor : Scans[*scanIndex].Actors)
+    {
+        auto actor = weakActor.Get();
+        if (actor && actor != ignoreActor)
+        {
+            outActors.AddUnique(actor);
+        }
+    }
+
+    AutoLinkBlueprintPrefilterScope::FindNearbyChildren(location, ignoreActor, outActors);
+    return true;
+}
+
+void AutoLinkSpeculativePlan::Start(UWorld* world, const FTransform& frame, const AActor* hologram)
+{
+    bIsStarted = true;
+    PlanGeneration = Generation;
+    NumScansDone = 0;
+    Scans.Reset();
+    ScanIndices.Reset();
+
+    // One query per place, covering the furthest scan of any connector there
+    for (auto& entry : Manifest->Entries)
+    {
+        const auto location = frame.TransformPosition(entry.LocalLocation);
+        const float radius = GetPlannedRadius(entry.Kind);
+        if (auto scanIndex = ScanIndices.Find(GetScanKey(location)))
+        {
+            Scans[*scanIndex].Radius = FMath::Max(Scans[*scanIndex].Radius, radius);
+            continue;
+        }
+
+        ScanIndices.Add(GetScanKey(location), Scans.Num());
+        auto& scan = Scans.AddDefaulted_GetRef();
+        scan.Location = location;
+        scan.Radius = radius;
+    }
+
+    auto collisionQueryParams = FCollisionQueryParams();
+    collisionQueryParams.AddIgnoredActor(hologram);
+    const auto onScanDone = FOverlapDelegate::CreateStatic(&AutoLinkSpeculativePlan::OnScanDone);
+    for (int32 i = 0; i < Scans.Num(); ++i)
+    {
+        Scans[i].Handle = world->AsyncOverlapByObjectType(
+            Scans[i].Location,
+            FQuat::Identity,
+            FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllStaticObjects),
+            FCollisionShape::MakeSphere(Scans[i].Radius),
+            collisionQueryParams,
+            &onScanDone,
+            i);
+    }
+
+    AL_LOG("AutoLinkSpeculativePlan::Start: Sent %d queries for %d connectors", Scans.Num(), Manifest->Entries.Num());
+}
+
+void AutoLinkSpeculativePlan::Drop()
+{
+    bIsStarted = false;
+    bIsCommitted = false;
+    PlanKey = 0;
+    NumScansDone = 0;
+    Scans.Reset();
+    ScanIndices.Reset();
+}
+
+void AutoLinkSpeculativePlan::OnScanDone(const FTraceHandle& handle, FOverlapDatum& datum)
+{
+    // Queries of a plan that has been dropped since can still come back
+    const int32 scanIndex = (int32)datum.UserData;
+    if (!Scans.IsValidIndex(scanIndex) || !(Scans[scanIndex].Handle == handle))
+    {
+        return;
+    }
+
+    auto& scan = Scans[scanIndex];
+    for (const FOverlapResult& result : datum.OutOverlaps)
+    {
+        auto actor = result.GetActor();
+        if (actor && actor->IsA(AAbstractInstanceManager::StaticClass()))
+        {
+            if (auto manager = AAbstractInstanceManager::GetInstanceManager(actor))
+            {
+                FInstanceHandle instanceHandle;
+                if (manager->ResolveOverlap(result, instanceHandle))
+                {
+                    actor = instanceHandle.GetOwner();
+                }
+            }
+        }
+
+        if (actor && !scan.Actors.Contains(actor))
+        {
+            scan.Actors.Add(actor);
+        }
+    }
+
+    ++NumScansDone;
+}
+
+uint64 AutoLinkSpeculativePlan::GetTransformKey(const FTransform& frame)
+{
+    // Same rounding as the manifest signature
+    const auto location = frame.GetLocation();
+    const auto forward = frame.GetRotation().GetForwardVector() * 100;
+    const auto up = frame.GetRotation().GetUpVector() * 100;
+    const int64 values[] = {
+        FMath::RoundToInt64(location.X), FMath::RoundToInt64(location.Y), FMath::RoundToInt64(location.Z),
+        FMath::RoundToInt64(forward.X), FMath::RoundToInt64(forward.Y), FMath::RoundToInt64(forward.Z),
+        FMath::RoundToInt64(up.X), FMath::RoundToInt64(up.Y), FMath::RoundToInt64(up.Z),
+    };
+
+    return CityHash64(reinterpret_cast<const char*>(values), sizeof(values));
+}
+
+AutoLinkSpeculativePlanScope::AutoLinkSpeculativePlanScope(const TArray<AActor*>& children, const TSharedRef<const AutoLinkBlueprintManifest>& manifest)
+{
+    // Scenarios and other callers link children no hologram built
+    using Plan = AutoLinkSpeculativePlan;
+    if (Plan::ConstructedFrameKey == 0 || Plan::GetTransformKey(AutoLinkBlueprintManifest::GetFrame(children)) != Plan::ConstructedFrameKey)
+    {
+        return;
+    }
+
+    // Anything built between the blueprint and its link pass, like an earlier placement in the same batch, wasn't planned for
+    bIsForConstructedChildren = true;
+    Plan::bIsActive = Plan::bIsCommitted
+        && Plan::PlanGeneration == Plan::Generation
+        && Plan::Manifest.IsValid()
+        && manifest->Signature != 0
+        && Plan::Manifest->Signature == manifest->Signature
+        && Plan::PlanKey == Plan::ConstructedFrameKey;
+
+    AL_LOG("AutoLinkSpeculativePlanScope: Plan is %s", Plan::bIsActive ? TEXT("in use") : TEXT("not in use"));
+    Plan::Manifest = manifest;
+}
+
+AutoLinkSpeculativePlanScope::~AutoLinkSpeculativePlanScope()
+{
+    if (!bIsForConstructedChildren)
+    {
+        return;
+    }
+
+    AutoLinkSpeculativePlan::bIsActive = false;
+    AutoLinkSpeculativePlan::ConstructedFrameKey = 0;
+    AutoLinkSpeculativePlan::Drop();
+}
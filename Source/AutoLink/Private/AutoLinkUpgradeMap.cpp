@@ -0,0 +1,110 @@
+#include "AutoLinkUpgradeMap.h"
+
+#include "AutoLinkCoreBridge.h"
+#include "AutoLinkLogMacros.h"
+
+#include "FGBuildable.h"
+#include "FGHologram.h"
+
+void AutoLinkUpgradeMap::Record(const AActor* hologram, AFGBuildable* buildable)
+{
+    auto fgHologram = Cast<AFGHologram>(hologram);
+    auto oldBuildable = fgHologram ? Cast<AFGBuildable>(fgHologram->GetUpgradedActor()) : nullptr;
+    if (!oldBuildable)
+    {
+        return;
+    }
+
+    TArray<OldConnector> oldConnectors;
+    TInlineComponentArray<UActorComponent*> components;
+    TArray<UActorComponent*> connectedComponents;
+    oldBuildable->GetComponents(components);
+    for (auto component : components)
+    {
+        AutoLinkCore::Connector connector;
+        connectedComponents.Reset();
+        AutoLinkCoreBridge::AppendConnectedComponents(component, connectedComponents);
+        if (connectedComponents.Num() == 0 || !AutoLinkCoreBridge::TryMakeConnector(component, connector))
+        {
+            continue;
+        }
+
+        OldConnector oldConnector;
+        oldConnector.Location = AutoLinkCoreBridge::ToUnreal(connector.Location);
+        for (auto connectedComponent : connectedComponents)
+        {
+            oldConnector.Partners.Add(connectedComponent->GetOwner());
+        }
+
+        oldConnectors.Add(MoveTemp(oldConnector));
+    }
+
+    AL_LOG("AutoLinkUpgradeMap::Record: %s replaces %s, which had %d linked connectors", *buildable->GetName(), *oldBuildable->GetName(), oldConnectors.Num());
+    if (oldConnectors.Num() > 0)
+    {
+        Records.Add(buildable, { buildable->GetWorld(), MoveTemp(oldConnectors) });
+    }
+}
+
+void AutoLinkUpgradeMap::EndFrame(UWorld* world)
+{
+    for (auto it = Records.CreateIterator(); it; ++it)
+    {
+        if (it.Value().World == world || !it.Value().World.IsValid())
+        {
+            AL_LOG("AutoLinkUpgradeMap::EndFrame: Dropping the unused record of %s", *GetNameSafe(it.Key().ResolveObjectPtr()));
+            it.RemoveCurrent();
+        }
+    }
+}
+
+bool AutoLinkUpgradeMap::FindPartnerActors(const FVector& location, AActor* ignoreActor, AutoLinkScratchArray<AActor*>& outActors)
+{
+    if (!Active)
+    {
+        return false;
+    }
+
+    // The new connectors don't always sit exactly where the old ones did, like a depot's inputs being deeper than a container's
+    constexpr double maxDistanceSquared = AutoLinkCore::Tolerances::BeltSearchDistance * AutoLinkCore::Tolerances::BeltSearchDistance;
+    bool bIsFound = false;
+    for (auto& oldConnector : *Active)
+    {
+        if (FVector::DistSquared(oldConnector.Location, location) > maxDistanceSquared)
+        {
+            continue;
+        }
+
+        bIsFound = true;
+        for (auto& weakPartner : oldConnector.Partners)
+        {
+            auto partner = weakPartner.Get();
+            if (partner && partner != ignoreActor)
+            {
+                outActors.AddUnique(partner);
+            }
+        }
+    }
+
+    return bIsFound;
+}
+
+AutoLinkUpgradeScope::AutoLinkUpgradeScope(AFGBuildable* buildable)
+    : PreviousActive(AutoLinkUpgradeMap::Active)
+{
+    AutoLinkUpgradeMap::UpgradeRecord record;
+    if (AutoLinkUpgradeMap::Records.RemoveAndCopyValue(buildable, record))
+    {
+        OldConnectors = MoveTemp(record.OldConnectors);
+        AutoLinkUpgradeMap::Active = &OldConnectors;
+    }
+    else
+    {
+        AutoLinkUpgradeMap::Active = nullptr;
+    }
+}
+
+AutoLinkUpgradeScope::~AutoLinkUpgradeScope()
+{
+    AutoLinkUpgradeMap::Active = PreviousActive;
+}
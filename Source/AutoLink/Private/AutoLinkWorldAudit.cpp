@@ -0,0 +1,316 @@
+#include "AutoLinkWorldAudit.h"
+
+#include "AutoLinkConnectorIndex.h"
+#include "AutoLinkConsoleVariables.h"
+#include "AutoLinkCore/AutoLinkMatcher.h"
+#include "AutoLinkLogCategory.h"
+#include "AutoLinkLogMacros.h"
+#include "AutoLinkPassStats.h"
+#include "AutoLinkRootInstanceModule.h"
+#include "AutoLinkScratch.h"
+
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "FGBuildableConveyorBase.h"
+#include "FGBuildableRailroadAttachment.h"
+#include "FGBuildableSubsystem.h"
+#include "FGFactoryConnectionComponent.h"
+#include "FGFluidIntegrantInterface.h"
+#include "FGPipeConnectionComponent.h"
+#include "FGRailroadTrackConnectionComponent.h"
+#include "HAL/IConsoleManager.h"
+
+void AutoLinkWorldAudit::Initialize()
+{
+    FWorldDelegates::OnWorldPostActorTick.AddLambda(
+        [](UWorld* world, ELevelTick tickType, float deltaSeconds)
+        {
+            Tick(world);
+        });
+}
+
+bool AutoLinkWorldAudit::Start(UWorld* world)
+{
+    if (Phase != EPhase::Idle || !world)
+    {
+        return false;
+    }
+
+    AutoLinkConnectorIndex::EnsureBuilt(world);
+    Snapshot = AutoLinkConnectorIndex::GetSnapshot();
+    if (!Snapshot.IsValid())
+    {
+        return false;
+    }
+
+    UE_LOG(LogAutoLink, Display, TEXT("AutoLinkWorldAudit: Auditing %d connectors in %s"), Snapshot->GetNumConnectors(), *world->GetName());
+    Phase = EPhase::Matching;
+    World = world;
+    Result = MatchResult();
+    NextSeam = 0;
+    NumRepairedSeams = 0;
+    StartSeconds = FPlatformTime::Seconds();
+    PendingMatch = Async(EAsyncExecution::ThreadPool, [snapshot = Snapshot]() { return Match(snapshot); });
+    return true;
+}
+
+void AutoLinkWorldAudit::Tick(UWorld* world)
+{
+    if (Phase == EPhase::Idle)
+    {
+        // Once per world, on its first tick in play. Saves are loaded and their buildables added by then.
+        if (CVarAutoLinkLoadAudit.GetValueOnGameThread()
+            && world->IsGameWorld()
+            && world->GetNetMode() != NM_Client
+            && world->HasBegunPlay()
+            && LastLoadedWorld.Get() != world)
+        {
+            LastLoadedWorld = world;
+            Start(world);
+        }
+
+        return;
+    }
+
+    if (!World.IsValid())
+    {
+        // The world went away mid-audit. The match, if it's still running, finishes on its own and is thrown away.
+        UE_LOG(LogAutoLink, Display, TEXT("AutoLinkWorldAudit: World unloaded, stopping the audit"));
+        Phase = EPhase::Idle;
+        Snapshot.Reset();
+        PendingMatch.Reset();
+        Result = MatchResult();
+        return;
+    }
+
+    if (World.Get() != world)
+    {
+        return;
+    }
+
+    switch (Phase)
+    {
+    case EPhase::Matching:
+        if (PendingMatch.IsReady())
+        {
+            Result = PendingMatch.Get();
+            PendingMatch.Reset();
+            CommitStartSeconds = FPlatformTime::Seconds();
+            Phase = EPhase::Committing;
+        }
+        break;
+    case EPhase::Committing:
+        CommitSlice();
+        if (NextSeam >= Result.Seams.Num())
+        {
+            Finish();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+AutoLinkWorldAudit::MatchResult AutoLinkWorldAudit::Match(const AutoLinkWorldSnapshot::Ptr& snapshot)
+{
+    MatchResult result;
+
+    auto startCycles = FPlatformTime::Cycles64();
+    std::vector<AutoLinkCore::Connector> connectors;
+    TArray<AutoLinkSnapshotHandle> handles;
+    snapshot->AppendAll(connectors, handles);
+    result.NumConnectors = (int32)connectors.size();
+    result.CollectMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - startCycles);
+
+    // Connectors only ever link to their own kind, so each kind is matched on its own worker and makes the same decisions it
+    // would matching them all together
+    startCycles = FPlatformTime::Cycles64();
+    constexpr int32 numKinds = (int32)AutoLinkCore::ConnectorKind::Num;
+    std::vector<AutoLinkCore::LinkDecision> decisions[numKinds];
+    ParallelFor(numKinds, [&](int32 kind)
+        {
+            AutoLinkCore::FindLinks(connectors, AutoLinkCore::MatchStrategy::SpatialGrid, decisions[kind], nullptr, 1u << kind);
+        });
+
+    // Only pairs where neither end has any link are seams. Partly linked rail connectors are junctions someone built on purpose.
+    for (const auto& kindDecisions : decisions)
+    {
+        for (const auto& decision : kindDecisions)
+        {
+            if (connectors[decision.Connector].NumConnections == 0 && connectors[decision.Candidate].NumConnections == 0)
+            {
+                result.Seams.Add({ handles[decision.Connector], handles[decision.Candidate] });
+            }
+        }
+    }
+
+    result.MatchMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - startCycles);
+    return result;
+}
+
+void AutoLinkWorldAudit::CommitSlice()
+{
+    AutoLinkPassScope passScope(TEXT("AutoLinkWorldAudit::CommitSlice"), World.Get());
+    const auto endSeam = FMath::Min(NextSeam + FMath::Max(1, CVarAutoLinkLoadAuditLinksPerFrame.GetValueOnGameThread()), Result.Seams.Num());
+    for (; NextSeam < endSeam; ++NextSeam)
+    {
+        // Either end may have been linked by an earlier slice, the player or the game since the snapshot
+        const auto& seam = Result.Seams[NextSeam];
+        if (!Snapshot->IsCurrent(seam.Connector) || !Snapshot->IsCurrent(seam.Candidate))
+        {
+            continue;
+        }
+
+        auto connection = seam.Connector.Component.Get();
+        auto candidate = seam.Candidate.Component.Get();
+        if (CommitSeam(connection, candidate))
+        {
+            AutoLinkConnectorIndex::NoteLinked(connection, candidate);
+            AL_PASS_STAT_ADD(NumLinks, 1);
+            ++NumRepairedSeams;
+        }
+    }
+}
+
+bool AutoLinkWorldAudit::CommitSeam(UActorComponent* connection, UActorComponent* candidate)
+{
+    if (!IsValid(connection) || !IsValid(candidate))
+    {
+        AL_LOG("AutoLinkWorldAudit::CommitSeam: Dropping a seam whose ends are gone");
+        return false;
+    }
+
+    AL_LOG("AutoLinkWorldAudit::CommitSeam: Connecting %s on %s to %s on %s",
+        *connection->GetName(),
+        *GetNameSafe(connection->GetOwner()),
+        *candidate->GetName(),
+        *GetNameSafe(candidate->GetOwner()));
+
+    // Checked again the same way AutoLinkDeferredLinks does, since the snapshot only knows about links AutoLink made
+    if (auto factoryConnection = Cast<UFGFactoryConnectionComponent>(connection))
+    {
+        auto factoryCandidate = Cast<UFGFactoryConnectionComponent>(candidate);
+        if (!factoryCandidate
+            || factoryConnection->IsConnected()
+            || factoryCandidate->IsConnected()
+            || !factoryCandidate->CanConnectTo(factoryConnection))
+        {
+            return false;
+        }
+
+        // Same as a link made while placing, so the belt gets the right chain actor
+        auto connectionConveyor = Cast<AFGBuildableConveyorBase>(factoryConnection->GetOuterBuildable());
+        if (connectionConveyor && Cast<AFGBuildableConveyorBase>(factoryCandidate->GetOuterBuildable()))
+        {
+            auto buildableSubsystem = AFGBuildableSubsystem::Get(World.Get());
+            buildableSubsystem->RemoveConveyor(connectionConveyor);
+            factoryConnection->SetConnection(factoryCandidate);
+            buildableSubsystem->AddConveyor(connectionConveyor);
+        }
+        else
+        {
+            factoryConnection->SetConnection(factoryCandidate);
+        }
+
+        return true;
+    }
+
+    if (auto pipeConnection = Cast<UFGPipeConnectionComponentBase>(connection))
+    {
+        auto pipeCandidate = Cast<UFGPipeConnectionComponentBase>(candidate);
+        if (!pipeCandidate
+            || pipeConnection->IsConnected()
+            || pipeCandidate->IsConnected()
+            || !pipeCandidate->CanConnectTo(pipeConnection))
+        {
+            return false;
+        }
+
+        auto fluidConnection = Cast<UFGPipeConnectionComponent>(pipeConnection);
+        if (!fluidConnection)
+        {
+            pipeCandidate->SetConnection(pipeConnection);
+            return true;
+        }
+
+        // Fluids need the same integrant handling as placing, or the two pipe networks stay apart and nothing flows across
+        auto buildable = Cast<AFGBuildable>(fluidConnection->GetOwner());
+        TInlineComponentArray<TPair<UFGPipeConnectionComponent*, IFGFluidIntegrantInterface*>> openConnectionsAndIntegrants;
+        UAutoLinkRootInstanceModule::FindOpenFluidConnections(openConnectionsAndIntegrants, buildable);
+        auto connectionAndIntegrant = openConnectionsAndIntegrants.FindByPredicate(
+            [fluidConnection](const TPair<UFGPipeConnectionComponent*, IFGFluidIntegrantInterface*>& pair) { return pair.Key == fluidConnection; });
+        if (!connectionAndIntegrant)
+        {
+            AL_LOG("AutoLinkWorldAudit::CommitSeam: %s has no fluid integrant", *fluidConnection->GetName());
+            return false;
+        }
+
+        if (!fluidConnection->HasFluidIntegrant())
+        {
+            fluidConnection->SetFluidIntegrant(connectionAndIntegrant->Value);
+        }
+
+        pipeCandidate->SetConnection(fluidConnection);
+
+        AutoLinkScratchSet<IFGFluidIntegrantInterface*> integrantsToRegister;
+        integrantsToRegister.Add(connectionAndIntegrant->Value);
+        UAutoLinkRootInstanceModule::RegisterFluidIntegrants(buildable, integrantsToRegister);
+        return true;
+    }
+
+    if (auto railConnection = Cast<UFGRailroadTrackConnectionComponent>(connection))
+    {
+        auto railCandidate = Cast<UFGRailroadTrackConnectionComponent>(candidate);
+        if (!railCandidate || railConnection->GetConnections().Num() > 0 || railCandidate->GetConnections().Num() > 0)
+        {
+            return false;
+        }
+
+        // Neither end has a link, so there's no switch control to make
+        AutoLinkScratchArray<UFGRailroadTrackConnectionComponent*> railCandidates;
+        railCandidates.Add(railCandidate);
+        UAutoLinkRootInstanceModule::LinkRailConnections(
+            railConnection,
+            railCandidates,
+            railConnection->GetOwner()->IsA<AFGBuildableRailroadAttachment>() || railCandidate->GetOwner()->IsA<AFGBuildableRailroadAttachment>());
+        return true;
+    }
+
+    return false;
+}
+
+void AutoLinkWorldAudit::Finish()
+{
+    const auto nowSeconds = FPlatformTime::Seconds();
+    UE_LOG(LogAutoLink, Display, TEXT("AutoLinkWorldAudit: Repaired %d of %d unlinked seams among %d connectors. Collected in %.3f ms and matched in %.3f ms off the game thread, linked over %.2f s, %.2f s in all"),
+        NumRepairedSeams,
+        Result.Seams.Num(),
+        Result.NumConnectors,
+        Result.CollectMs,
+        Result.MatchMs,
+        nowSeconds - CommitStartSeconds,
+        nowSeconds - StartSeconds);
+
+    Phase = EPhase::Idle;
+    Snapshot.Reset();
+    Result = MatchResult();
+}
+
+static FAutoConsoleCommandWithWorldAndArgs AuditWorldCommand(
+    TEXT("AutoLink.AuditWorld"),
+    TEXT("Finds every pair of open connectors in the current world that the placement rules would link, and links them over the next frames. ")
+    TEXT("Usage: AutoLink.AuditWorld"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& args, UWorld* world)
+    {
+        if (!world || !world->IsGameWorld() || world->GetNetMode() == NM_Client)
+        {
+            UE_LOG(LogAutoLink, Error, TEXT("AutoLink.AuditWorld needs a game world with authority"));
+            return;
+        }
+
+        if (!AutoLinkWorldAudit::Start(world))
+        {
+            UE_LOG(LogAutoLink, Error, TEXT("AutoLink.AuditWorld: An audit is already running"));
+        }
+    }));
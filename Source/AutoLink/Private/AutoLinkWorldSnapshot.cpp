@@ -0,0 +1,77 @@
+#include "AutoLinkWorldSnapshot.h"
+
+#include "AutoLinkConnectorIndex.h"
+#include "AutoLinkCoreBridge.h"
+
+void AutoLinkWorldSnapshot::FindNearby(const AutoLinkCore::Vector& location, std::vector<AutoLinkCore::Connector>& outConnectors, TArray<AutoLinkSnapshotHandle>& outHandles) const
+{
+    const auto center = AutoLinkConnectorIndex::GetCell(location);
+    for (int32 x = -1; x <= 1; ++x)
+    {
+        for (int32 y = -1; y <= 1; ++y)
+        {
+            for (int32 z = -1; z <= 1; ++z)
+            {
+                auto cell = FindCell(center + FIntVector(x, y, z));
+                if (!cell)
+                {
+                    continue;
+                }
+
+                const auto& connectors = cell->Connectors;
+                for (int32 i = 0; i < (int32)connectors.size(); ++i)
+                {
+                    outConnectors.push_back(connectors[i]);
+                    outHandles.Add({ cell->Components[i], cell->Generations[i], connectors[i].NumConnections });
+                }
+            }
+        }
+    }
+}
+
+void AutoLinkWorldSnapshot::AppendAll(std::vector<AutoLinkCore::Connector>& outConnectors, TArray<AutoLinkSnapshotHandle>& outHandles) const
+{
+    outConnectors.reserve(outConnectors.size() + NumConnectors);
+    outHandles.Reserve(outHandles.Num() + NumConnectors);
+    for (const auto& chunk : Chunks)
+    {
+        for (const auto& cell : chunk->Cells)
+        {
+            const auto& connectors = cell.Value->Connectors;
+            for (int32 i = 0; i < (int32)connectors.size(); ++i)
+            {
+                outConnectors.push_back(connectors[i]);
+                outHandles.Add({ cell.Value->Components[i], cell.Value->Generations[i], connectors[i].NumConnections });
+            }
+        }
+    }
+}
+
+const AutoLinkSnapshotCell* AutoLinkWorldSnapshot::FindCell(const FIntVector& cell) const
+{
+    if (Chunks.IsEmpty())
+    {
+        return nullptr;
+    }
+
+    auto found = Chunks[GetChunkIndex(cell)]->Cells.Find(cell);
+    return found ? &found->Get() : nullptr;
+}
+
+bool AutoLinkWorldSnapshot::IsCurrent(const AutoLinkSnapshotHandle& handle) const
+{
+    auto component = handle.Component.Get();
+    if (!component)
+    {
+        return false;
+    }
+
+    // The generation only moves when AutoLink links the connector, so with nothing in the index changed it can't have
+    if (Epoch != AutoLinkConnectorIndex::GetEpoch() && AutoLinkConnectorIndex::GetGeneration(component) != handle.Generation)
+    {
+        return false;
+    }
+
+    AutoLinkCore::Connector connector;
+    return AutoLinkCoreBridge::TryMakeConnector(component, connector) && connector.NumConnections == handle.NumConnections;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Counts heap allocations per thread so tools can check what a link pass allocates. The counter wraps GMalloc in a proxy that
+// forwards everything to the real allocator and bumps a thread-local counter on every Malloc and Realloc. Every allocation in the
+// process then pays for an extra virtual call, and GMalloc can't safely be swapped while other threads allocate, so the proxy is
+// only installed as the module starts, and only when the game was launched with -AutoLinkCountAllocations. It stays for the rest
+// of the process. Without it, tools report allocations as unavailable.
+class AUTOLINK_API AutoLinkAllocationCounter
+{
+public:
+    // Call once as the module starts
+    static void InstallIfRequested();
+    static bool IsInstalled() { return bIsInstalled; }
+
+    // Allocations the calling thread has made since Install, not counting any made while paused
+    static uint64 GetNumAllocations();
+
+private:
+    static inline bool bIsInstalled = false;
+};
+
+// Allocations made on this thread while one of these is alive aren't counted. For engine calls such as scene queries, whose
+// allocations are the engine's business rather than AutoLink's.
+class AUTOLINK_API AutoLinkUncountedAllocationsScope
+{
+public:
+    AutoLinkUncountedAllocationsScope();
+    ~AutoLinkUncountedAllocationsScope();
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkCore/AutoLinkGeometry.h"
+
+// The connectors of a blueprint that a paste has to try to link, in the blueprint's own space. A freshly pasted blueprint's
+// children come connected the way they were saved, so every copy has the same connectors left open and those are the only
+// ones that can link to anything, inside the blueprint or out. The manifest lists them once per blueprint and every later
+// paste goes straight to them: children with none are never looked at again, and the prefilter takes its bounds from the
+// entries instead of the children's components.
+//
+// Blueprints are told apart by a signature of their children's classes and placements relative to the first child, which
+// is where the entries are relative to as well. A blueprint saved again with different contents gets a new manifest, and a
+// paste that comes out a little differently only costs a rebuild. AutoLink.BlueprintManifestCache 0 builds one for every
+// paste, 1 keeps them for the session and 2 keeps them in Saved/AutoLink/BlueprintManifests across sessions too. Game thread
+// only.
+class AUTOLINK_API AutoLinkBlueprintManifest
+{
+public:
+    // One open connector on a child
+    struct Entry
+    {
+        int32 ChildIndex = 0;
+        AutoLinkCore::ConnectorKind Kind = AutoLinkCore::ConnectorKind::Belt;
+        FVector LocalLocation = FVector::ZeroVector;
+    };
+
+    // Returns the manifest for a blueprint's children, building it the first time the blueprint is seen. Call inside a pass.
+    static TSharedRef<const AutoLinkBlueprintManifest> Get(const TArray<AActor*>& children);
+
+    // What entries are relative to for these children
+    static FTransform GetFrame(const TArray<AActor*>& children);
+
+    bool HasOpenConnectors(int32 childIndex) const { return ChildrenWithConnectors[childIndex]; }
+
+    uint64 Signature = 0;
+    TArray<Entry> Entries;
+
+    // One bit per child, set when it has at least one entry
+    TBitArray<> ChildrenWithConnectors;
+
+private:
+    static TSharedRef<AutoLinkBlueprintManifest> Build(const TArray<AActor*>& children, const FTransform& frame, uint64 signature);
+    static uint64 MakeSignature(const TArray<AActor*>& children, const FTransform& frame);
+    static uint64 GetClassHash(const UClass* buildableClass);
+
+    static FString GetFilePath(uint64 signature);
+    bool Save(const FString& filePath) const;
+    static TSharedPtr<AutoLinkBlueprintManifest> Load(const FString& filePath, uint64 signature, int32 numChildren);
+
+    static inline TMap<uint64, TSharedRef<const AutoLinkBlueprintManifest>> Manifests;
+    static inline TMap<const UClass*, uint64> ClassHashes;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkScratch.h"
+
+class AutoLinkBlueprintManifest;
+
+// Skips the scene queries for a blueprint that nothing outside it can link to, like one pasted in open space or on bare
+// foundations. The scope works out the bounds of the blueprint's open connectors from its manifest (see
+// AutoLinkBlueprintManifest.h), grown by the furthest any connector scans
+// (Tolerances::MaxBeltSearchDistance), and asks AutoLinkConnectorIndex whether an open connector that isn't the blueprint's
+// own lies inside. If none does, HitScan and OverlapScan stop querying the scene for the rest of the pass. They look up the
+// blueprint's children with a connector in the cells around the scan instead, so only links inside the blueprint are made.
+// The candidates still go through all the usual rules.
+//
+// Turned off with AutoLink.BlueprintPrefilter 0. Lives inside a pass, since its containers are pass scratch. Game thread only.
+class AUTOLINK_API AutoLinkBlueprintPrefilterScope
+{
+public:
+    AutoLinkBlueprintPrefilterScope(const TArray<AActor*>& children, const AutoLinkBlueprintManifest& manifest);
+    ~AutoLinkBlueprintPrefilterScope();
+
+    // Whether a blueprint is being built
+    static bool IsActive() { return Active != nullptr; }
+
+    // Whether the running blueprint can only link to itself
+    static bool IsInternalOnly() { return Active && Active->bIsInternalOnly; }
+
+    // Stands in for the scene queries while IsInternalOnly, and for a speculative plan's own children. Appends every child
+    // other than ignoreActor that has an open connector in the cell location is in or the 26 around it.
+    static void FindNearbyChildren(const FVector& location, AActor* ignoreActor, AutoLinkScratchArray<AActor*>& outActors);
+
+private:
+    static inline AutoLinkBlueprintPrefilterScope* Active = nullptr;
+
+    bool bIsInternalOnly = false;
+    AutoLinkScratchSet<const AActor*> Children;
+    AutoLinkScratchMap<FIntVector, AutoLinkScratchArray<AActor*>> ChildCells;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AFGBuildable;
+
+// Answers the per-class questions every placement asks once per class instead of once per placement. The base
+// AFGBuildableHologram::ConfigureComponents hook used to run an IsA chain on every hologram to leave the ones with their own
+// hook alone, and every buildable went through the IsA chain in ShouldTryToAutoLink and then all four connector searches.
+// Now the hook does one lookup and FindAndLinkForBuildable only runs the searches for kinds the class has connectors of.
+//
+// The kinds come from the components of the first buildable of each class that gets here, so every buildable of a class is
+// taken to have the same kinds of connectors. That holds for everything in the base game, whose connectors all come from the
+// class. Game thread only.
+class AUTOLINK_API AutoLinkClassDispatch
+{
+public:
+    // Whether the base ConfigureComponents hook should hand over what holograms of this class build. False for the classes
+    // with a hook of their own.
+    static bool IsForBaseHook(const UClass* hologramClass);
+
+    // Bit N is set when the buildable's class has connectors of AutoLinkCore::ConnectorKind N. 0 for classes AutoLink never
+    // links.
+    static uint8 GetConnectorKinds(AFGBuildable* buildable);
+
+private:
+    static inline TMap<const UClass*, bool> BaseHookClasses;
+    static inline TMap<const UClass*, uint8> ConnectorKinds;
+};
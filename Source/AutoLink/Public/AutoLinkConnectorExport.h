@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkCore/AutoLinkGeometry.h"
+#include "FGBuildable.h"
+
+#include <string>
+#include <vector>
+
+// Gives every buildable class seen a small id and remembers its path so connectors can refer to classes by id
+struct AUTOLINK_API AutoLinkClassTable
+{
+    TMap<UClass*, uint32> Ids;
+    std::vector<std::string> Names;
+
+    uint32 GetId(UClass* buildableClass);
+};
+
+// Collects the connectors of placed buildables as AutoLinkCore structs and writes them out as a connector snapshot (see
+// AutoLinkCore/AutoLinkSnapshot.h) for the offline tools. Driven by the AutoLink.ExportConnectors console command.
+class AUTOLINK_API AutoLinkConnectorExport
+{
+public:
+    // Appends every connector on the buildable that AutoLink could link, whether or not it is connected already. The components
+    // they came from are appended to outComponents in the same order when it is given.
+    static void AppendConnectors(
+        AFGBuildable* buildable,
+        std::vector<AutoLinkCore::Connector>& outConnectors,
+        AutoLinkClassTable& classTable,
+        TArray<UActorComponent*>* outComponents = nullptr);
+
+    // Writes a snapshot of every buildable in the world. Returns the number of connectors written or INDEX_NONE on failure.
+    static int32 ExportWorld(UWorld* world, const FString& filePath);
+
+    static FString GetDefaultFilePath();
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkConnectorExport.h"
+#include "AutoLinkCore/AutoLinkGeometry.h"
+#include "AutoLinkScratch.h"
+#include "AutoLinkWorldSnapshot.h"
+#include "FGBuildable.h"
+#include "UObject/ObjectKey.h"
+
+// One cell of the index
+struct AutoLinkIndexCell
+{
+    TArray<TWeakObjectPtr<UActorComponent>> Components;
+
+    // Bit N is set when the cell has an open connector of ConnectorKind N. Only current while bIsDirty is false.
+    uint8 OpenKinds = 0;
+    bool bIsDirty = true;
+
+    // Connectors here that were linked to something since dismantled, and may still be open
+    TArray<TWeakObjectPtr<UActorComponent>> FreedComponents;
+};
+
+// Every linkable connector in the world bucketed into cells of AutoLinkCore::MatchCellSize, so the connectors that could link to
+// one can be found without scene queries. It is built from the world the first time something needs it (with
+// AutoLink.OccupancyFilter on, that is the first buildable added as the world loads) and kept current from
+// AFGBuildableSubsystem::AddBuildable afterwards. Dismantled buildables are dropped lazily when a lookup runs into them.
+// Everything here is game-thread only.
+//
+// On top of the cells sits an occupancy bitmap per connector kind, one bit per hashed cell, set when a connector of that kind is
+// indexed there. Each cell also keeps a mask of the kinds it has open connectors of. Cells are marked dirty when a buildable is
+// added in them or removed in or next to them, and their mask is recounted the next time a lookup needs it. That makes
+// MayHaveOpenConnectorNear a handful of bit tests when nothing is around, and only touches the components of changed cells.
+//
+// The index also publishes AutoLinkWorldSnapshots for planning off the game thread. Every change bumps the epoch and notes the
+// cells it touched. The next snapshot rebuilds only those cells, copies only the chunks they are in (see AutoLinkSnapshotChunk)
+// and shares every other chunk with the one before. Each connector AutoLink links gets its generation bumped, which is what a
+// snapshot checks its connectors against.
+//
+// When a buildable is dismantled, whatever its connectors were linked to goes into the freed list of its cell. Something rebuilt
+// in the same spot checks those first: they are exactly where the dismantled buildable's connectors were, which a trace can
+// miss (curved rails especially). Only freed connectors that could link to the one scanning count. A freed connector leaves
+// the list as soon as AutoLink links it or its buildable is removed, and when its cell is recounted after it was linked some
+// other way.
+class AUTOLINK_API AutoLinkConnectorIndex
+{
+public:
+    // Builds the index for the world unless it is already built for it
+    static void EnsureBuilt(UWorld* world);
+    static bool IsBuiltFor(const UWorld* world) { return world && World.Get() == world; }
+    static void Reset();
+
+    // Adds the buildable's connectors if the index is built for its world and doesn't have them yet
+    static void AddBuildable(AFGBuildable* buildable);
+
+    // Call when a buildable is removed. Whatever its connectors were linked to is open again, so their cells and the cells
+    // around them get recounted before the next lookup.
+    static void RemoveBuildable(AFGBuildable* buildable);
+
+    // False when there is certainly no open connector of the kind in the cell location is in or the 26 around it, which is as
+    // far as any candidate can be. True when there may be one, or when the index isn't built. Connectors of ignoredOwner don't
+    // count, though finding that out means going through the components of the cells that have the kind open.
+    static bool MayHaveOpenConnectorNear(const AutoLinkCore::Vector& location, AutoLinkCore::ConnectorKind kind, const AActor* ignoredOwner);
+
+    // Whether any indexed connector inside the box is open and owned by something other than ignoredOwners. It asks each
+    // connector's component for its location and state, so it's meant for coarse checks over a few cells at a time.
+    static bool HasOpenConnectorInBox(const FBox& box, const AutoLinkScratchSet<const AActor*>& ignoredOwners);
+
+    // Appends the owners of the open freed connectors in the cell location is in and the 26 around it that are of the same kind
+    // as connectionComponent and, for belts, of a direction it can link to. Skips those of ignoreActor. Returns true when one
+    // of them touches location and takes only one link, which makes it the one a connector there would link to.
+    static bool FindFreedNear(const UActorComponent* connectionComponent, const FVector& location, AActor* ignoreActor, AutoLinkScratchArray<AActor*>& outActors);
+
+    // Call when AutoLink links two connectors
+    static void NoteLinked(const UActorComponent* connection, const UActorComponent* candidate);
+
+    // The snapshot of the index as it is now, or null when the index isn't built. Reuses the last one if nothing changed.
+    static AutoLinkWorldSnapshot::Ptr GetSnapshot();
+
+    static uint64 GetEpoch() { return Epoch; }
+    static uint32 GetGeneration(const UActorComponent* component);
+
+    static int32 GetNumComponents() { return NumComponents; }
+
+    static FIntVector GetCell(const AutoLinkCore::Vector& location);
+
+private:
+    // Drops the cell's dead components and recounts its open connectors
+    static void RefreshCell(AutoLinkIndexCell& cell);
+    static bool HasOpenConnector(const AutoLinkIndexCell& cell, AutoLinkCore::ConnectorKind kind, const AActor* ignoredOwner);
+
+    static int32 GetOccupancyBit(const FIntVector& cell);
+
+    // Takes the component out of the freed list of the cell location is in, if it's there
+    static void ForgetFreed(const UActorComponent* component, const AutoLinkCore::Vector& location);
+
+    // Marks the cell around location and the 26 around it, which is as far as anything linked to a connector there can be, to
+    // be recounted and copied into the next snapshot
+    static void MarkChangedAround(const AutoLinkCore::Vector& location);
+
+    // 2^18 bits per kind keeps the bitmaps at 32 KB each. Cells sharing a bit only cost a lookup on a false positive.
+    static constexpr int32 NumOccupancyBits = 1 << 18;
+
+    static inline TWeakObjectPtr<UWorld> World;
+    static inline TMap<FIntVector, AutoLinkIndexCell> Cells;
+    static inline TBitArray<> Occupancy[(int32)AutoLinkCore::ConnectorKind::Num];
+    static inline TSet<FObjectKey> IndexedBuildables;
+    static inline AutoLinkClassTable ClassTable;
+    static inline int32 NumComponents = 0;
+    static inline int32 NumFreedComponents = 0;
+
+    static inline uint64 Epoch = 0;
+    static inline TSet<FIntVector> ChangedCells;
+    // Only connectors AutoLink linked have one. Dropped when their buildable is removed.
+    static inline TMap<FObjectKey, uint32> Generations;
+    static inline AutoLinkWorldSnapshot::Ptr Snapshot;
+};
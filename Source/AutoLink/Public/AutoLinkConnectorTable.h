@@ -0,0 +1,67 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkCore/AutoLinkGeometry.h"
+#include "AutoLinkScratch.h"
+
+class UFGFactoryConnectionComponent;
+class UFGPipeConnectionComponentBase;
+class UFGRailroadTrackConnectionComponent;
+
+// Every connector a link pass looks at, packed into columns. The first time the pass sees a connector, its getters are called
+// and its owner is cast once to fill in a row; after that the candidate filtering reads the columns instead of going back to the
+// components and their owners for every connector and candidate pair. Links the pass makes are written back with NoteLinked so
+// the connected state in the table stays current.
+//
+// The outermost AutoLinkPassScope owns the table and the columns are pass scratch (see AutoLinkScratch.h), so rows are only
+// good until the pass ends. Game thread only.
+class AUTOLINK_API AutoLinkConnectorTable
+{
+public:
+    AutoLinkConnectorTable();
+    ~AutoLinkConnectorTable();
+
+    // The running pass's table. Only call this inside a pass.
+    static AutoLinkConnectorTable& Get()
+    {
+        check(Active);
+        return *Active;
+    }
+
+    // Return the connector's row, capturing it first if the pass hasn't seen it yet. The connection must be valid.
+    int32 Capture(UFGFactoryConnectionComponent* connection);
+    int32 Capture(UFGPipeConnectionComponentBase* connection, AutoLinkCore::ConnectorKind kind);
+    int32 Capture(UFGRailroadTrackConnectionComponent* connection);
+
+    // Puts a row back together for the AutoLinkCore rules
+    AutoLinkCore::Connector GetConnector(int32 row) const;
+
+    FVector GetLocation(int32 row) const { return FVector(Locations[row].X, Locations[row].Y, Locations[row].Z); }
+    FVector GetNormal(int32 row) const { return FVector(Normals[row].X, Normals[row].Y, Normals[row].Z); }
+    bool IsOpen(int32 row) const { return NumConnections[row] < MaxConnections[row]; }
+    bool HasOwnerFlags(int32 row, uint8 flags) const { return (OwnerFlags[row] & flags) != 0; }
+
+    // Records a link the pass just made between two captured connectors. A track connector linked to a rail attachment can't
+    // take any more connections, so both ends of such a link are marked full.
+    void NoteLinked(int32 row, int32 otherRow);
+
+    int32 Num() const { return Components.Num(); }
+
+    // One entry per row in each
+    AutoLinkScratchArray<UActorComponent*> Components;
+    AutoLinkScratchArray<AutoLinkCore::Vector> Locations;
+    AutoLinkScratchArray<AutoLinkCore::Vector> Normals;
+    AutoLinkScratchArray<AutoLinkCore::ConnectorKind> Kinds;
+    AutoLinkScratchArray<AutoLinkCore::ConnectorDirection> Directions;
+    AutoLinkScratchArray<uint8> OwnerFlags;
+    AutoLinkScratchArray<uint32> OwnerIds;
+    AutoLinkScratchArray<uint8> NumConnections;
+    AutoLinkScratchArray<uint8> MaxConnections;
+
+private:
+    int32 AddRow(UActorComponent* component, const AutoLinkCore::Connector& connector);
+
+    static inline AutoLinkConnectorTable* Active = nullptr;
+
+    AutoLinkScratchMap<const UActorComponent*, int32> Rows;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+
+// Runtime-tunable settings. These can be set from the console, from Engine.ini under [ConsoleVariables], or on the command
+// line with -ExecCmds, which is how dedicated server operators are expected to change them.
+
+// Link passes that take longer than this write a detailed record to Saved/AutoLink/Hitches. 0 or less disables the capture.
+extern TAutoConsoleVariable<float> CVarAutoLinkHitchThresholdMs;
+
+// Runs the index-based link engine next to the scene query one on every placement without committing anything it decides, and
+// logs where they disagree and how long each took. See AutoLinkShadow.h.
+extern TAutoConsoleVariable<bool> CVarAutoLinkShadowMode;
+
+// How much slower than its baseline a scenario may link before the scenario commands' checkbaseline option fails it
+extern TAutoConsoleVariable<float> CVarAutoLinkBaselineMaxSlowdownPercent;
+
+// Lets blueprints that nothing outside them could link to skip the scene queries and only link to themselves. See
+// AutoLinkBlueprintPrefilter.h.
+extern TAutoConsoleVariable<bool> CVarAutoLinkBlueprintPrefilter;
+
+// Keeps AutoLinkConnectorIndex built from the moment a world loads and skips the scans of connectors it knows have no open
+// connector of their kind anywhere near them
+extern TAutoConsoleVariable<bool> CVarAutoLinkOccupancyFilter;
+
+// How long blueprint manifests are kept: 0 builds one for every paste, 1 keeps them for the session, 2 also keeps them on disk.
+// See AutoLinkBlueprintManifest.h.
+extern TAutoConsoleVariable<int32> CVarAutoLinkBlueprintManifestCache;
+
+// Queues placements and links everything placed in a frame together once the world has ticked. See AutoLinkPlacementBatch.h.
+extern TAutoConsoleVariable<bool> CVarAutoLinkBatchPlacements;
+
+// How long a blueprint hologram has to hold still before its paste's scene queries are sent ahead. Less than 0 disables it.
+// See AutoLinkSpeculativePlan.h.
+extern TAutoConsoleVariable<float> CVarAutoLinkSpeculativePlanDelayMs;
+
+// Links belt connectors of attachments and buildings to each other at the end of the tick. Off by default until it has had
+// more play. See AutoLinkDeferredLinks.h.
+extern TAutoConsoleVariable<bool> CVarAutoLinkAttachmentLinks;
+
+// Links every seam a world was loaded with on its first tick in play, a slice per frame. See AutoLinkWorldAudit.h.
+extern TAutoConsoleVariable<bool> CVarAutoLinkLoadAudit;
+extern TAutoConsoleVariable<int32> CVarAutoLinkLoadAuditLinksPerFrame;
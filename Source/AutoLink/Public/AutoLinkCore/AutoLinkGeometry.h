@@ -0,0 +1,186 @@
+#pragma once
+
+// The connector matching rules, free of any Unreal types so they can be built, benchmarked and fuzzed on their own (see the
+// CMakeLists.txt at the root of the repo). The mod converts UObjects into these structs and asks these functions for every
+// decision, so anything measured here is exactly what runs in game.
+//
+// The math intentionally mirrors the FVector functions the rules were first written with (IsNearlyZero, PointsAreNear,
+// ToDirectionAndLength, etc.), including their float/double mixing, so results are bit-for-bit what the game would decide.
+
+#include <cstdint>
+
+namespace AutoLinkCore
+{
+    struct Vector
+    {
+        double X;
+        double Y;
+        double Z;
+
+        Vector operator+(const Vector& other) const { return { X + other.X, Y + other.Y, Z + other.Z }; }
+        Vector operator-(const Vector& other) const { return { X - other.X, Y - other.Y, Z - other.Z }; }
+        Vector operator-() const { return { -X, -Y, -Z }; }
+        Vector operator*(double scale) const { return { X * scale, Y * scale, Z * scale }; }
+
+        double Dot(const Vector& other) const { return X * other.X + Y * other.Y + Z * other.Z; }
+        double SquaredLength() const { return X * X + Y * Y + Z * Z; }
+        double Length() const;
+
+        static Vector CrossProduct(const Vector& a, const Vector& b);
+
+        // Same as FVector::IsNearlyZero: every component within tolerance of zero
+        bool IsNearlyZero(double tolerance) const;
+
+        // Same as FVector::PointsAreNear: every component closer than the distance
+        static bool PointsAreNear(const Vector& a, const Vector& b, double distance);
+
+        // Same as FVector::ToDirectionAndLength, including returning a zero direction for tiny vectors
+        void ToDirectionAndLength(Vector& outDirection, double& outLength) const;
+    };
+
+    // Same order as EAutoLinkConnectorKind on the mod side
+    enum class ConnectorKind : uint8_t
+    {
+        Belt,
+        Railroad,
+        Fluid,
+        Hyper,
+        Num
+    };
+
+    enum class ConnectorDirection : uint8_t
+    {
+        Any,
+        Input,
+        Output,
+    };
+
+    // What we need to know about the buildable that owns a connector. The mod works these out with Cast/IsA once per connector.
+    namespace OwnerFlags
+    {
+        enum : uint8_t
+        {
+            None = 0,
+            ConveyorBelt = 1 << 0,
+            ConveyorLift = 1 << 1,
+            ConveyorAttachment = 1 << 2,
+            Storage = 1 << 3,
+            CentralStorage = 1 << 4, // Dimensional depot uploaders
+            RailroadAttachment = 1 << 5,
+            PipelineJunction = 1 << 6,
+        };
+    }
+
+    // One connector in the world. Plain old data with a fixed layout so arrays of them can be written straight to disk and
+    // memory-mapped back in.
+    struct Connector
+    {
+        Vector Location;
+        Vector Normal;
+        uint32_t ClassId;  // Index into whatever class table came with the connectors
+        uint32_t OwnerId;  // Connectors with the same owner never link to each other
+        ConnectorKind Kind;
+        ConnectorDirection Direction;
+        uint8_t OwnerFlags;
+        uint8_t NumConnections;
+        uint8_t MaxConnections; // 1 for everything except railroad track connectors
+        uint8_t Padding[3];
+
+        bool IsOpen() const { return NumConnections < MaxConnections; }
+        bool IsOnConveyor() const { return (OwnerFlags & (OwnerFlags::ConveyorBelt | OwnerFlags::ConveyorLift)) != 0; }
+    };
+
+    static_assert(sizeof(Connector) == 64, "Connector is written to disk as-is, so its size is part of the file formats");
+
+    // Constants shared by the rules below and the mod's scene queries
+    namespace Tolerances
+    {
+        constexpr double BeltTouchingDistance = 1;                // Belt connectors within 1 cm are touching
+        constexpr double BeltTouchingNormalDistance = .1;         // Touching connector normals must be this close to opposite
+        constexpr int BeltConnectorOffsetPadding = 1;             // Padding to allow for floating point issues and ever-so-slightly angled connectors
+        constexpr double BeltCosineTolerance = .001;              // Equates to 2.563 degrees, around the angle at which conveyor lifts naturally snap
+        constexpr float BeltCloseEnoughDistance = 1;              // A candidate this close is taken as the best without looking further
+        constexpr float BeltToLiftMaxOffset = 200.0f;
+        constexpr float LiftMinOffsetIntoBuilding = 100.0f;
+        constexpr float LiftToBuildingMaxOffset = 300.0f;
+        constexpr float LiftToLiftMaxOffset = 400.0f;
+        constexpr float StorageDepotAlignmentOffset = 10.0f;
+
+        constexpr float BeltSearchDistance = 20.0f;
+        constexpr float LiftSearchDistance = 420.0f;
+        constexpr float BuildingBeltSearchDistance = 320.0f;
+        constexpr float MaxBeltSearchDistance = LiftSearchDistance;
+
+        constexpr float PipeMaxDistanceSquared = 1;
+        constexpr double PipeCrossProductTolerance = .01;
+        constexpr float FluidSearchRadius = 50.0f;
+        constexpr float HyperSearchDistance = 10.0f;
+
+        constexpr float RailMaxDistanceSquared = 1;
+        constexpr double RailCrossProductXYTolerance = .01;
+        constexpr double RailCrossProductZTolerance = 1.0; // Looser vertically to account for curved rails
+        constexpr float RailSearchRadius = 30.0f;
+        constexpr int MaxConnectionsPerRailConnector = 3;
+    }
+
+    enum class BeltCandidateResult : uint8_t
+    {
+        Compatible,
+        InvalidOffsetWindow,
+        TouchingOutsideOffsetWindow,
+        TouchingNotOpposed,
+        NotTouchingWithZeroOffsetWindow,
+        BeyondMaxOffset,
+        BelowMinOffset,
+        NotCollinear,
+    };
+
+    enum class PipeCandidateResult : uint8_t
+    {
+        Compatible,
+        NotCollinear,
+        TooFar,
+    };
+
+    enum class RailCandidateResult : uint8_t
+    {
+        Compatible,
+        TooFar,
+        NotCollinear,
+        NotOpposed,
+    };
+
+    const char* ToString(BeltCandidateResult result);
+    const char* ToString(PipeCandidateResult result);
+    const char* ToString(RailCandidateResult result);
+
+    bool UnitVectorsArePointingInOppositeDirections(const Vector& firstUnitVector, const Vector& secondUnitVector, double cosineTolerance);
+
+    // How far out from a belt connector the mod scans for buildables, based on what owns the connector
+    float GetBeltSearchDistance(uint8_t ownerFlags);
+
+    // Whether a pair of belt connectors may be linked during a pass. Linking attachments or buildings to each other then causes
+    // crashes in the base game's multithreaded code, so the mod either skips pairs with no conveyor on either side or, with
+    // AutoLink.AttachmentLinks on, leaves them for the end of the tick (AutoLinkDeferredLinks). The rules here never link them.
+    bool IsBeltPairAllowed(const Connector& connector, const Connector& candidate);
+    bool AreBeltDirectionsCompatible(ConnectorDirection first, ConnectorDirection second);
+
+    // The window of offsets along the connector normal at which the candidate may sit, where negative is behind the connector
+    struct BeltOffsetWindow
+    {
+        float MinOffset;
+        float MaxOffset;
+    };
+
+    BeltOffsetWindow ComputeBeltOffsetWindow(const Connector& connector, const Connector& candidate);
+
+    // Checks the geometry of a belt candidate against the offset window for the pair. On success, outDistance is the distance
+    // between the connectors (0 when touching), which the caller uses to pick the closest candidate.
+    BeltCandidateResult EvaluateBeltCandidate(const Connector& connector, const Connector& candidate, double& outDistance);
+
+    // Pipes and hypertubes must be collinear and virtually touching
+    PipeCandidateResult EvaluatePipeCandidate(const Connector& connector, const Connector& candidate);
+
+    // Rail connectors must be virtually touching, collinear (with some vertical slack for curves) and facing each other
+    RailCandidateResult EvaluateRailCandidate(const Connector& connector, const Connector& candidate);
+}
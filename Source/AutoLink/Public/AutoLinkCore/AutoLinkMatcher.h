@@ -0,0 +1,80 @@
+#pragma once
+
+// Batch matching over a whole set of connectors using the rules in AutoLinkGeometry.h. The mod links one placed buildable at a
+// time, using scene queries to find candidates; this does the same decisions for every open connector in a set at once, which
+// is what the offline tools, the benchmarks and any future batch linking need.
+//
+// Connectors are processed in index order and each link immediately closes both ends, the same way linking a buildable's
+// connectors one after another does in game. Every strategy examines candidates in ascending index order so they all make
+// exactly the same decisions; they only differ in how they find the candidates.
+
+#include "AutoLinkCore/AutoLinkGeometry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AutoLinkCore
+{
+    enum class MatchStrategy : uint8_t
+    {
+        BruteForce,  // Every connector against every other connector. The reference implementation.
+        SpatialGrid, // Connectors bucketed into a sorted grid of cells, so each one only looks at its neighbourhood.
+        Num
+    };
+
+    const char* ToString(MatchStrategy strategy);
+
+    struct LinkDecision
+    {
+        uint32_t Connector; // Index of the connector that was being linked
+        uint32_t Candidate; // Index of the connector it was linked to
+        double Distance;
+
+        bool operator==(const LinkDecision& other) const
+        {
+            return Connector == other.Connector && Candidate == other.Candidate && Distance == other.Distance;
+        }
+    };
+
+    struct MatchStats
+    {
+        uint64_t CandidatesEvaluated = 0; // Connector pairs that went through the Evaluate*Candidate rules
+        uint64_t LinksMade = 0;
+    };
+
+    // Side length of the grid cells used by SpatialGrid. It must be at least the furthest any candidate can be from a connector
+    // and still be compatible (a lift-to-lift link plus depot and padding tolerances) so only adjacent cells need to be checked.
+    constexpr double MatchCellSize = 512.0;
+
+    // Appends a decision for every link made, in the order they are made. Only connectors of the given kinds are considered
+    // when kindMask is not all kinds (bit N is ConnectorKind N).
+    void FindLinks(
+        const Connector* connectors,
+        size_t numConnectors,
+        MatchStrategy strategy,
+        std::vector<LinkDecision>& outDecisions,
+        MatchStats* outStats = nullptr,
+        uint32_t kindMask = 0xFFFFFFFF);
+
+    // Like FindLinks, but only links the first numToLink connectors. The rest are only there as candidates, which is what
+    // linking one placed buildable against what its scene queries found looks like.
+    void FindLinksFor(
+        const Connector* connectors,
+        size_t numConnectors,
+        size_t numToLink,
+        MatchStrategy strategy,
+        std::vector<LinkDecision>& outDecisions,
+        MatchStats* outStats = nullptr,
+        uint32_t kindMask = 0xFFFFFFFF);
+
+    inline void FindLinks(
+        const std::vector<Connector>& connectors,
+        MatchStrategy strategy,
+        std::vector<LinkDecision>& outDecisions,
+        MatchStats* outStats = nullptr,
+        uint32_t kindMask = 0xFFFFFFFF)
+    {
+        FindLinks(connectors.data(), connectors.size(), strategy, outDecisions, outStats, kindMask);
+    }
+}
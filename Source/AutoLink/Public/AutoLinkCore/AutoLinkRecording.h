@@ -0,0 +1,122 @@
+#pragma once
+
+// A recording of what the mod's hooks did, written by AutoLink.Record and replayed by the offline tools. For every buildable
+// that went through FindAndLinkForBuildable it holds the connectors that were linked, every candidate the scene queries offered
+// them, the links that were made and how long it took, grouped into the passes (blueprint Constructs or single placements)
+// they happened in. Replaying a recording through the matcher shows whether a change to the rules changes any decision made in
+// game, and how its speed compares.
+//
+// The file is a RecordingHeader followed by a stream of records, each a RecordHeader and its payload:
+//   ClassName  uint32 class id, then the class path (not terminated)
+//   PassBegin  the source of the pass (not terminated)
+//   Buildable  RecordedBuildableHeader, Connector[NumOwnConnectors + NumCandidates], RecordedLink[NumLinks]
+//   PassEnd    RecordedPassEnd
+// Everything is little-endian.
+
+#include "AutoLinkCore/AutoLinkGeometry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AutoLinkCore
+{
+    constexpr char RecordingMagic[8] = { 'A', 'L', 'R', 'E', 'C', '\0', '\0', '\0' };
+    constexpr uint32_t RecordingVersion = 1;
+
+    struct RecordingHeader
+    {
+        char Magic[8];
+        uint32_t Version;
+        uint32_t ConnectorSize;
+        uint64_t Reserved[2];
+    };
+
+    static_assert(sizeof(RecordingHeader) == 32, "RecordingHeader is written to disk as-is");
+
+    enum class RecordType : uint32_t
+    {
+        ClassName,
+        PassBegin,
+        Buildable,
+        PassEnd,
+    };
+
+    struct RecordHeader
+    {
+        RecordType Type;
+        uint32_t PayloadSize;
+    };
+
+    struct RecordedBuildableHeader
+    {
+        uint32_t ClassId;
+        uint32_t NumOwnConnectors; // The buildable's own connectors come first, followed by the candidates
+        uint32_t NumCandidates;
+        uint32_t NumLinks;
+        uint64_t DurationNs;
+    };
+
+    // Indexes into the buildable's connectors
+    struct RecordedLink
+    {
+        uint32_t Connector;
+        uint32_t Candidate;
+    };
+
+    struct RecordedPassEnd
+    {
+        uint64_t DurationNs;
+        uint32_t NumBuildables;
+        uint32_t Padding;
+    };
+
+    // Appends records to a byte buffer, which the caller writes out whenever it likes
+    class RecordingWriter
+    {
+    public:
+        std::vector<uint8_t> Bytes;
+
+        void WriteHeader();
+        void WriteClassName(uint32_t classId, const std::string& className);
+        void WritePassBegin(const std::string& source);
+        void WriteBuildable(uint32_t classId, uint64_t durationNs, const std::vector<Connector>& ownConnectors, const std::vector<Connector>& candidates, const std::vector<RecordedLink>& links);
+        void WritePassEnd(uint64_t durationNs, uint32_t numBuildables);
+
+    private:
+        void WriteRecord(RecordType type, const void* payload, size_t payloadSize);
+        void Append(const void* data, size_t size);
+    };
+
+    struct RecordedBuildable
+    {
+        uint32_t ClassId = 0;
+        uint32_t NumOwnConnectors = 0;
+        uint64_t DurationNs = 0;
+        std::vector<Connector> Connectors;
+        std::vector<RecordedLink> Links;
+    };
+
+    struct RecordedPass
+    {
+        std::string Source;
+        uint64_t DurationNs = 0;
+        std::vector<RecordedBuildable> Buildables;
+    };
+
+    struct Recording
+    {
+        std::vector<std::string> ClassNames;
+        std::vector<RecordedPass> Passes;
+
+        const char* LookupClassName(uint32_t classId) const
+        {
+            return classId < ClassNames.size() ? ClassNames[classId].c_str() : "Unknown";
+        }
+    };
+
+    // Parses a whole recording. A recording cut off mid-record (e.g. the game crashed) keeps every complete pass before the
+    // cut. On failure, returns false and sets outError if given.
+    bool ReadRecording(const void* data, size_t size, Recording& outRecording, const char** outError = nullptr);
+}
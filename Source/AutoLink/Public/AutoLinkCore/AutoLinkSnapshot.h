@@ -0,0 +1,57 @@
+#pragma once
+
+// A file of every connector in a world, written by the mod's AutoLink.ExportConnectors command and read by the offline tools.
+//
+// The file is laid out so it can be memory-mapped and used in place:
+//   SnapshotHeader
+//   Connector[NumConnectors]          at ConnectorsOffset, 64-byte aligned
+//   NumClasses null-terminated names  at ClassNamesOffset, indexed by Connector::ClassId
+// Everything is little-endian, which covers every platform the game and the tools run on.
+
+#include "AutoLinkCore/AutoLinkGeometry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AutoLinkCore
+{
+    constexpr char SnapshotMagic[8] = { 'A', 'L', 'S', 'N', 'A', 'P', '\0', '\0' };
+    constexpr uint32_t SnapshotVersion = 1;
+
+    struct SnapshotHeader
+    {
+        char Magic[8];
+        uint32_t Version;
+        uint32_t ConnectorSize;
+        uint64_t NumConnectors;
+        uint64_t ConnectorsOffset;
+        uint64_t NumClasses;
+        uint64_t ClassNamesOffset;
+        uint64_t ClassNamesSize;
+        uint64_t Reserved;
+    };
+
+    static_assert(sizeof(SnapshotHeader) == 64, "SnapshotHeader is written to disk as-is");
+
+    // A snapshot that has been read or mapped. Connectors and ClassNames point into the caller's buffer.
+    struct SnapshotView
+    {
+        const Connector* Connectors = nullptr;
+        size_t NumConnectors = 0;
+        std::vector<const char*> ClassNames;
+
+        const char* LookupClassName(uint32_t classId) const
+        {
+            return classId < ClassNames.size() ? ClassNames[classId] : "Unknown";
+        }
+    };
+
+    // Serializes the connectors and class names into outBytes, replacing anything already there
+    void WriteSnapshot(const Connector* connectors, size_t numConnectors, const std::vector<std::string>& classNames, std::vector<uint8_t>& outBytes);
+
+    // Checks the header and every offset against the size of the buffer before pointing outView into it. The buffer must be
+    // 8-byte aligned, which anything from mmap or the heap is. On failure, returns false and sets outError if given.
+    bool ReadSnapshot(const void* data, size_t size, SnapshotView& outView, const char** outError = nullptr);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// Procedurally generated worst cases for benchmarking AutoLink. A layout is a list of pieces, one per buildable, with enough
+// information both to spawn them in game (AutoLinkStressSpawner) and to produce the connectors the game would report for them
+// (AppendStressConnectors), so in-game runs and offline datasets are made from exactly the same inputs. The same type, size and
+// seed always give the same layout on every platform.
+
+#include "AutoLinkCore/AutoLinkGeometry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AutoLinkCore
+{
+    enum class StressLayoutType : uint8_t
+    {
+        BeltManifold,   // Rows of belts laid end to end close enough together that every scan sees the neighbouring rows. Size is belts.
+        LiftStacks,     // Stacks of 50 conveyor lifts on a grid with 400 units between stacks. Size is stacks.
+        PipeManifold,   // Rows of cross junctions joined by pipes, with a stub pipe on each side. Size is junctions.
+        HyperSpaghetti, // Strands of curved hypertubes wandering through the same small volume. Size is tubes.
+        RailYard,       // Lines of three-way switches, each with a straight track on to the next and two curved sidings. Size is switches.
+        Num
+    };
+
+    const char* ToString(StressLayoutType type);
+
+    // Case sensitive, same names as ToString
+    bool ParseStressLayoutType(const char* name, StressLayoutType& outType);
+
+    // A sensible size for each type, e.g. 10000 belts for a belt manifold
+    uint32_t GetDefaultStressSize(StressLayoutType type);
+
+    enum class StressPieceType : uint8_t
+    {
+        Belt,
+        Lift,
+        Pipe,
+        PipeJunction,
+        Hyper,
+        Track,
+        Num
+    };
+
+    const char* ToString(StressPieceType type);
+
+    // Splines run from Start to End, leaving Start along StartDirection and curving to End along the circular arc between
+    // them, which is what the scenario builder spawns. Lifts run from their bottom at Start to their top at End. Junctions
+    // sit at Start.
+    struct StressPiece
+    {
+        StressPieceType Type;
+        Vector Start;
+        Vector End;
+        Vector StartDirection;
+    };
+
+    // Measurements of base game buildables the layouts are built around. The defaults are close enough for offline datasets;
+    // in game, the spawner measures the real buildables and generates with those.
+    struct StressGeometry
+    {
+        double JunctionHalfSize = 50; // From a cross junction's center to each of its connectors
+    };
+
+    struct StressLayout
+    {
+        StressLayoutType Type = StressLayoutType::BeltManifold;
+        uint32_t Size = 0;
+        uint64_t Seed = 0;
+        std::vector<StressPiece> Pieces;
+        uint32_t ExpectedLinks = 0; // Links linking every piece should make
+    };
+
+    void GenerateStressLayout(StressLayoutType type, uint32_t size, uint64_t seed, const StressGeometry& geometry, StressLayout& outLayout);
+
+    // Direction a spline piece ends in, the start direction reflected across the chord
+    Vector GetStressEndDirection(const StressPiece& piece);
+
+    // Appends the connectors of every piece. Each piece is its own owner and its type is its class id, so ToString(StressPieceType)
+    // gives the class names for a snapshot.
+    void AppendStressConnectors(const StressLayout& layout, const StressGeometry& geometry, std::vector<Connector>& outConnectors);
+}
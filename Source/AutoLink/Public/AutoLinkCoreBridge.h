@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkCore/AutoLinkGeometry.h"
+#include "FGFactoryConnectionComponent.h"
+#include "FGPipeConnectionComponent.h"
+#include "FGRailroadTrackConnectionComponent.h"
+
+// Converts connection components into the plain structs the AutoLinkCore rules work on
+class AUTOLINK_API AutoLinkCoreBridge
+{
+public:
+    static AutoLinkCore::Vector ToCore(const FVector& vector)
+    {
+        return { vector.X, vector.Y, vector.Z };
+    }
+
+    static FVector ToUnreal(const AutoLinkCore::Vector& vector)
+    {
+        return FVector(vector.X, vector.Y, vector.Z);
+    }
+
+    static uint8 GetOwnerFlags(const AActor* owner);
+
+    // Rail buffer stops only allow one connection, everything else on rails allows a three-way switch
+    static int GetMaxRailConnections(const AActor* owner);
+
+    static AutoLinkCore::Connector MakeConnector(UFGFactoryConnectionComponent* connection);
+    static AutoLinkCore::Connector MakeConnector(UFGPipeConnectionComponentBase* connection, AutoLinkCore::ConnectorKind kind);
+    static AutoLinkCore::Connector MakeConnector(UFGRailroadTrackConnectionComponent* connection, int maxConnections);
+
+    // Converts any kind of connection component AutoLink could link, whether or not it is connected already. Returns false for
+    // other components, including fluid connections of types AutoLink never links.
+    static bool TryMakeConnector(UActorComponent* component, AutoLinkCore::Connector& outConnector);
+
+    // Appends whatever connection components the component is connected to, if it's a kind AutoLink links
+    static void AppendConnectedComponents(UActorComponent* component, TArray<UActorComponent*>& outComponents);
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UFGFactoryConnectionComponent;
+
+// Holds belt links between two connectors that aren't on conveyors, like a splitter snapped straight onto a constructor, until
+// a point where the factory tick can't be running. Making those links while the game's multithreaded factory code is running
+// crashes it, so they used to be skipped altogether. Now the link pass only picks them and queues them here, and they're made
+// in one batch at the end of the world's tick, after every tick group (the buildable subsystem's factory tick included) is
+// done and before the next one starts. Links with a belt or lift on either side are still made straight away.
+//
+// Each link is checked again before it's made, since something else may have taken either end in the meantime. Those that no
+// longer fit are dropped. Only with AutoLink.AttachmentLinks 1, which is off by default. Game thread only.
+class AUTOLINK_API AutoLinkDeferredLinks
+{
+public:
+    static void Add(UFGFactoryConnectionComponent* connection, UFGFactoryConnectionComponent* candidate);
+
+    // Makes every queued link in the world
+    static void Commit(UWorld* world);
+
+private:
+    struct DeferredLink
+    {
+        TWeakObjectPtr<UWorld> World;
+        TWeakObjectPtr<UFGFactoryConnectionComponent> Connection;
+        TWeakObjectPtr<UFGFactoryConnectionComponent> Candidate;
+    };
+
+    static inline TArray<DeferredLink> Pending;
+};
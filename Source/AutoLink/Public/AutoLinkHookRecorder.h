@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkConnectorExport.h"
+#include "AutoLinkCore/AutoLinkRecording.h"
+#include "FGFactoryConnectionComponent.h"
+#include "FGPipeConnectionComponent.h"
+#include "FGRailroadTrackConnectionComponent.h"
+#include "HAL/PlatformFileManager.h"
+
+// Records what the hooks do to a file (see AutoLinkCore/AutoLinkRecording.h) so it can be replayed offline against new builds of
+// the matching rules. Passes are bracketed by the outermost AutoLinkPassScope and buildables by AutoLinkRecordBuildableScope;
+// the FindAndLinkCompatible* functions report the connector they are linking, the candidates they found and the links they
+// made. Started and stopped with the AutoLink.Record console command. Everything here is game-thread only.
+class AUTOLINK_API AutoLinkHookRecorder
+{
+public:
+    static bool Start(const FString& filePath);
+    static void Stop();
+    static bool IsRecording() { return File.IsValid(); }
+
+    static void BeginPass(const TCHAR* source);
+    static void EndPass();
+    static void BeginBuildable(AFGBuildable* buildable);
+    static void EndBuildable();
+
+    // Records the connector being linked and every candidate the scene queries found for it
+    static void RecordCandidates(UFGFactoryConnectionComponent* connection, const AutoLinkCore::Connector& coreConnector, TArrayView<UFGFactoryConnectionComponent* const> candidates);
+    static void RecordCandidates(UFGRailroadTrackConnectionComponent* connection, const AutoLinkCore::Connector& coreConnector, TArrayView<UFGRailroadTrackConnectionComponent* const> candidates);
+    static void RecordCandidates(UFGPipeConnectionComponentBase* connection, const AutoLinkCore::Connector& coreConnector, TArrayView<UFGPipeConnectionComponentBase* const> candidates);
+
+    static void RecordLink(const UActorComponent* connection, const UActorComponent* candidate);
+
+    static FString GetDefaultFilePath();
+
+private:
+    static void RecordConnector(const UActorComponent* component, AutoLinkCore::Connector connector, bool isOwn);
+    static void Flush();
+
+    static inline TUniquePtr<IFileHandle> File;
+    static inline AutoLinkCore::RecordingWriter Writer;
+    static inline AutoLinkClassTable ClassTable;
+    static inline size_t NumClassNamesWritten = 0;
+
+    static inline bool bIsInPass = false;
+    static inline uint64 PassStartCycles = 0;
+    static inline uint32 NumPassBuildables = 0;
+
+    static inline bool bIsInBuildable = false;
+    static inline uint32 BuildableClassId = 0;
+    static inline uint64 BuildableStartCycles = 0;
+    static inline std::vector<AutoLinkCore::Connector> OwnConnectors;
+    static inline std::vector<AutoLinkCore::Connector> Candidates;
+    static inline TMap<const UActorComponent*, uint32> OwnIndices;
+    static inline TMap<const UActorComponent*, uint32> CandidateIndices;
+    static inline TArray<TPair<const UActorComponent*, const UActorComponent*>> Links;
+};
+
+// Brackets one buildable in the recording, if one is running
+class AutoLinkRecordBuildableScope
+{
+public:
+    AutoLinkRecordBuildableScope(AFGBuildable* buildable)
+        : bIsRecording(AutoLinkHookRecorder::IsRecording())
+    {
+        if (bIsRecording)
+        {
+            AutoLinkHookRecorder::BeginBuildable(buildable);
+        }
+    }
+
+    ~AutoLinkRecordBuildableScope()
+    {
+        if (bIsRecording)
+        {
+            AutoLinkHookRecorder::EndBuildable();
+        }
+    }
+
+private:
+    bool bIsRecording;
+};
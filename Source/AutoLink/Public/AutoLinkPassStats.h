@@ -0,0 +1,146 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkConnectorTable.h"
+#include "Misc/MemStack.h"
+
+// The connector kinds we link, in the order FindAndLinkForBuildable processes them
+enum class EAutoLinkConnectorKind : uint8
+{
+    Belt,
+    Railroad,
+    Fluid,
+    Hyper,
+    Num
+};
+
+// Counters and timings for one link pass. A pass is the outermost AutoLinkPassScope, so a blueprint Construct is one pass
+// covering all its children and a single hologram's ConfigureComponents is a pass covering one buildable.
+struct AutoLinkPassStats
+{
+    static constexpr int32 NumKinds = (int32)EAutoLinkConnectorKind::Num;
+
+    const TCHAR* Source = nullptr;
+    const UObject* Context = nullptr;
+    uint64 StartCycles = 0;
+    uint64 TotalCycles = 0;
+
+    int32 NumBuildables = 0;
+    int32 NumOpenConnectors[NumKinds] = {};
+    uint64 PhaseCycles[NumKinds] = {};
+
+    int32 NumHitScans = 0;
+    int32 NumOverlapScans = 0;
+    int32 NumHitActors = 0;
+    int32 NumCandidates = 0;
+    int32 NumLinks = 0;
+
+    // Attachment and building links left for AutoLinkDeferredLinks to make at the end of the tick
+    int32 NumDeferredLinks = 0;
+
+    // Scans answered from the blueprint's own connectors instead of the scene (see AutoLinkBlueprintPrefilter.h)
+    int32 NumPrefilteredScans = 0;
+
+    // Connectors that weren't scanned for at all because the occupancy bitmap had no open connector of their kind near them
+    int32 NumSkippedScans = 0;
+
+    // Scans answered from what a speculative plan queried while the hologram was aimed (see AutoLinkSpeculativePlan.h)
+    int32 NumPlannedScans = 0;
+
+    // Scans answered from what the buildable being linked replaced was linked to (see AutoLinkUpgradeMap.h)
+    int32 NumUpgradeScans = 0;
+
+    // Scans answered by a connector freed by a dismantle right where the scan starts (see AutoLinkConnectorIndex.h)
+    int32 NumFreedScans = 0;
+
+    // Placements an AutoLinkPlacementBatch linked together in the pass
+    int32 NumPlacements = 0;
+
+    // Placements dropped that frame because a hook had already handed the buildable over (see AutoLinkPlacementBatch.h)
+    int32 NumDuplicatePlacements = 0;
+
+    // Blueprint children passed over because their blueprint's manifest has no open connectors on them
+    int32 NumSkippedChildren = 0;
+
+    // Rail links take the track out of the railroad subsystem and add it back, which rebuilds its graph
+    int32 NumTrackRebuilds = 0;
+    uint64 TrackRebuildCycles = 0;
+
+    // Heap allocations AutoLink itself made during the pass, scene queries excluded. Only counted once AutoLinkAllocationCounter
+    // is installed.
+    uint64 StartAllocations = 0;
+    int32 NumAllocations = 0;
+
+    // Every buildable class that went through the pass and how many times. Linear search is fine since even
+    // big blueprints only have a handful of distinct classes.
+    TArray<TPair<UClass*, int32>, TInlineAllocator<16>> Classes;
+
+    void Reset(const TCHAR* source, const UObject* context);
+    void AddClass(UClass* buildableClass);
+    FString ToRecordString(double totalMs, float thresholdMs) const;
+
+    static const TCHAR* GetKindName(EAutoLinkConnectorKind kind);
+};
+
+// Times a link pass and, when it runs over AutoLink.HitchThresholdMs, writes its stats to a file under Saved/. Nested scopes
+// (e.g. each FindAndLinkForBuildable inside a blueprint Construct) join the outermost pass instead of starting their own.
+// Everything here is game-thread only, like the hooks that drive it.
+//
+// The outermost scope also marks the game thread's FMemStack, so the pass's scratch containers (see AutoLinkScratch.h) are all
+// freed together when it ends, and owns the pass's AutoLinkConnectorTable.
+//
+// Tools that want the numbers for themselves (like the scenario runner) pass captureForCaller, which collects stats even when
+// hitch capture is disabled and never writes a hitch record. The stats can be read with GetLastStats once the scope ends.
+class AUTOLINK_API AutoLinkPassScope
+{
+public:
+    AutoLinkPassScope(const TCHAR* source, const UObject* context = nullptr, bool captureForCaller = false);
+    ~AutoLinkPassScope();
+
+    // Returns the stats of the running pass, or null if there is none or hitch capture is disabled
+    static AutoLinkPassStats* GetActiveStats() { return ActiveStats; }
+
+    // Returns the stats of the last captured pass
+    static const AutoLinkPassStats& GetLastStats() { return Stats; }
+
+private:
+    static void WriteHitchRecord(const AutoLinkPassStats& stats, double totalMs, float thresholdMs);
+
+    static inline int32 Depth = 0;
+    static inline AutoLinkPassStats* ActiveStats = nullptr;
+    static AutoLinkPassStats Stats;
+
+    bool bIsOutermost;
+    bool bCaptureForCaller;
+    TOptional<FMemMark> ScratchMark;
+    TOptional<AutoLinkConnectorTable> ConnectorTable; // After ScratchMark so it goes before the mark pops its columns
+};
+
+// Accumulates the time spent processing one connector kind into the active pass
+class AutoLinkPhaseScope
+{
+public:
+    AutoLinkPhaseScope(EAutoLinkConnectorKind kind)
+        : Stats(AutoLinkPassScope::GetActiveStats())
+        , Kind(kind)
+        , StartCycles(Stats ? FPlatformTime::Cycles64() : 0)
+    {
+    }
+
+    ~AutoLinkPhaseScope()
+    {
+        if (Stats)
+        {
+            Stats->PhaseCycles[(int32)Kind] += FPlatformTime::Cycles64() - StartCycles;
+        }
+    }
+
+private:
+    AutoLinkPassStats* Stats;
+    EAutoLinkConnectorKind Kind;
+    uint64 StartCycles;
+};
+
+// Bumps a counter on the active pass. Compiles down to a null check when no pass is being captured.
+#define AL_PASS_STAT_ADD(Field, Amount)\
+    do { if (auto alPassStats = AutoLinkPassScope::GetActiveStats()) { alPassStats->Field += (Amount); } } while (0)
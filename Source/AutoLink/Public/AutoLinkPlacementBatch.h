@@ -0,0 +1,102 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "UObject/ObjectKey.h"
+
+class AFGBuildable;
+
+// Which requests in a batch link first. Requests of the same priority link in the order they were made.
+enum class EAutoLinkRequestPriority : uint8
+{
+    Low,
+    Normal,
+    High,
+};
+
+// Collects what the placement hooks see during a frame and links it all in one pass once the world has ticked its actors.
+// Zooping, mass-placement mods and several players building at once can place dozens of buildables in a frame, and linking
+// each in its own pass meant a fresh connector table and scratch per call and the same neighbours captured over and over.
+// In the batch they share one table, so a connector is captured once per frame however many placements look at it.
+//
+// Placements are linked in the order they came in, blueprints as a whole through their manifest. By the time the batch runs
+// they have all begun play and are in the buildable subsystem, the same as blueprint children have always been when they
+// link. AutoLink.BatchPlacements 0 links every placement from its hook again.
+//
+// Every request goes through one lock-free multi-producer queue, whether it came from a hook or from RequestLink, which other
+// mods, server RPC handlers and other threads can call. Producers never wait on linking. The end of each world tick drains
+// the queue on the game thread and links the world's requests by priority, then by when they were made.
+//
+// A buildable is linked at most once a frame, whether or not batching is on. Several hooks can see the same buildable (the
+// blueprint hook and a ConfigureComponents one, or the base ConfigureComponents and an override), so later sightings in the
+// frame are dropped, and counted when a hook made them. A blueprint child seen before keeps its place in the blueprint as null. Hook requests are
+// checked as they come in and RequestLink ones as they are drained.
+class AUTOLINK_API AutoLinkPlacementBatch
+{
+public:
+    // Hooks the end of every world tick. Call once when the mod starts.
+    static void Initialize();
+
+    // Queue a buildable a hologram placed on its own, or the children a blueprint hologram built. Game thread only.
+    static void AddBuildable(const AActor* hologram, AFGBuildable* buildable);
+    static void AddBlueprint(const AActor* hologram, const TArray<AActor*>& children);
+
+    // Queue a buildable to be linked with the next batch in its world. Any thread, as long as the caller keeps the buildable and
+    // instigator alive for the call. The instigator is whatever asked for the link, and is only used for logging. Requests for
+    // objects destroyed before the drain are dropped.
+    static void RequestLink(AFGBuildable* buildable, const UObject* instigator, EAutoLinkRequestPriority priority = EAutoLinkRequestPriority::Normal);
+
+    // Links everything queued in the world. Placements queued while it runs go in the next batch.
+    static void Flush(UWorld* world);
+
+private:
+    // An object named from another thread. Only its address and its slot in the object array are read there, which is safe
+    // anywhere. Resolve, on the game thread, gives the object back if the slot still holds it and it's still alive.
+    struct RequestedObject
+    {
+        const UObject* Object = nullptr;
+        int32 Index = INDEX_NONE;
+        int32 SerialNumber = 0;
+
+        static RequestedObject Make(const UObject* object);
+        const UObject* Resolve() const;
+    };
+
+    struct LinkRequest
+    {
+        TWeakObjectPtr<UWorld> World;
+        TArray<TWeakObjectPtr<AActor>> Actors;
+        TWeakObjectPtr<const UObject> Instigator;
+        double Timestamp = 0;
+        EAutoLinkRequestPriority Priority = EAutoLinkRequestPriority::Normal;
+        bool bIsBlueprint = false;
+
+        // Hook requests were checked against the frame's sightings before they were queued
+        bool bIsSeen = false;
+
+        // RequestLink's buildable and instigator. Drain turns them into World, Actors and Instigator, which can only be made on
+        // the game thread.
+        RequestedObject RequestedBuildable;
+        RequestedObject RequestedInstigator;
+    };
+
+    static void Enqueue(LinkRequest&& request);
+
+    // Moves every queued request into Pending, resolving RequestLink's objects and dropping repeats
+    static void Drain();
+
+    static void LinkBlueprint(const TCHAR* source, const UObject* context, const TArray<AActor*>& children);
+
+    // False if the actor was already seen this frame. Only repeats from the hooks are counted, since asking for a link again
+    // through RequestLink is expected.
+    static bool MarkSeen(const AActor* actor, bool bCountDuplicate = true);
+    static void EndFrame();
+
+    static inline TQueue<LinkRequest, EQueueMode::Mpsc> Incoming;
+
+    // Drained requests for worlds that haven't flushed yet. Game thread only, like everything below.
+    static inline TArray<LinkRequest> Pending;
+    static inline TSet<TObjectKey<AActor>> SeenThisFrame;
+    static inline int32 NumFrameDuplicates = 0;
+    static inline int32 NumSessionDuplicates = 0;
+};
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "AutoLinkCore/AutoLinkGeometry.h"
+#include "AutoLinkScratch.h"
 #include "FGBuildableConveyorBase.h"
 #include "FGBuildableFactory.h"
 #include "FGBuildableHologram.h"
@@ -44,6 +46,9 @@ public:
     static bool ShouldTryToAutoLink(AFGBuildable* buildable);
     static void FindAndLinkForBuildable(AFGBuildable* buildable);
 
+    // Links every child of a blueprint with open connectors, as the blueprint's manifest has them. Call inside a pass.
+    static void FindAndLinkForChildren(const TArray<AActor*>& children);
+
     static void AddIfCandidate(
         TInlineComponentArray<UFGFactoryConnectionComponent*>& openConnections,
         UFGFactoryConnectionComponent* connection);
@@ -60,6 +65,10 @@ public:
         TInlineComponentArray<TPair<UFGPipeConnectionComponent*, IFGFluidIntegrantInterface*>>& openConnectionsAndIntegrants,
         AFGBuildable* buildable);
 
+    // Registers the integrants of the buildable's newly linked fluid connections with the pipe subsystem again, which merges
+    // their pipe networks. Does nothing inside a blueprint designer.
+    static void RegisterFluidIntegrants(AFGBuildable* buildable, const AutoLinkScratchSet<IFGFluidIntegrantInterface*>& integrants);
+
     static void AddIfCandidate(
         TInlineComponentArray<UFGPipeConnectionComponentHyper*>& openConnections,
         UFGPipeConnectionComponentHyper* connection);
@@ -75,34 +84,57 @@ public:
         TInlineComponentArray<AutoLinkRailConnectionData>& openConnections,
         AFGBuildable* buildable);
 
-    static void HitScan(
-        TArray<AActor*>& actors,
+    // Both scans return true when the actors are only a guess at what's there, like what the buildable being linked replaced
+    // was linked to or a freed connector, rather than what the scene has. A caller that links nothing from a guess scans again
+    // with guesses off.
+    static bool HitScan(
+        AutoLinkScratchArray<AActor*>& actors,
         UWorld* world,
         FVector scanStart,
         FVector scanEnd,
+        const UActorComponent* connectionComponent, // The connector scanning, which freed connectors must be able to link to
         AActor* ignoreActor); // The scan can resolve to the buildable we're trying to find connections for (and multiple times too),
     // which will never be the right result and can involve some deep, unnecessary searching. Allows us to skip it.
 
-    static void OverlapScan(
-        TArray<AActor*>& actors,
+    static bool OverlapScan(
+        AutoLinkScratchArray<AActor*>& actors,
         UWorld* world,
         FVector scanStart,
         float radius,
+        const UActorComponent* connectionComponent, // Same as in HitScan
         AActor* ignoreActor); // The scan can resolve to the buildable we're trying to find connections for (and multiple times too),
     // which will never be the right result and can involve some deep, unnecessary searching. Allows us to skip it.
 
+    // Whether AutoLinkConnectorIndex knows there's no open connector of this kind anywhere the connector at location could link
+    // to, other than the owner's own, so it doesn't need to be scanned for. Never true in a blueprint pass, since the children
+    // may not be indexed yet.
+    static bool CanSkipScan(const FVector& location, AutoLinkCore::ConnectorKind kind, const AActor* owner);
+
+    // Off while a connector scans again after a guess linked nothing
+    static inline bool bAreScanGuessesAllowed = true;
+
     static void FindAndLinkCompatibleBeltConnection(UFGFactoryConnectionComponent* connectionComponent);
     static void FindAndLinkCompatibleRailroadConnection(AutoLinkRailConnectionData& connectionData);
 
     // These functions return true if it found and connected something
-    static bool FindAndLinkCompatibleFluidConnection(UFGPipeConnectionComponent* connectionComponent, const TArray<UClass*>& incompatibleClasses);
+    static bool FindAndLinkCompatibleFluidConnection(UFGPipeConnectionComponent* connectionComponent, const AutoLinkScratchArray<UClass*>& incompatibleClasses);
     static bool FindAndLinkCompatibleHyperConnection(UFGPipeConnectionComponentHyper* connectionComponent);
-    static bool ConnectBestPipeCandidate(UFGPipeConnectionComponentBase* connectionComponent, TArray<UFGPipeConnectionComponentBase*>& candidates);
+    static bool ConnectBestPipeCandidate(
+        UFGPipeConnectionComponentBase* connectionComponent,
+        AutoLinkCore::ConnectorKind kind,
+        AutoLinkScratchArray<UFGPipeConnectionComponentBase*>& candidates);
 
     static bool UnitVectorsArePointingInOppositeDirections(FVector firstUnitVector, FVector secondUnitVector, double cosineTolerance);
 
+    // Links connectionComponent to each of compatibleConnections. The connection's track is taken out of the rail subsystem and
+    // put back around the links so its graphs and overlaps are rebuilt, unless a rail attachment is involved.
+    static void LinkRailConnections(
+        UFGRailroadTrackConnectionComponent* connectionComponent,
+        const AutoLinkScratchArray<UFGRailroadTrackConnectionComponent*>& compatibleConnections,
+        bool involvesRailAttachment);
+
     static void UpdateOrCreateSwitchControl(
         UFGRailroadTrackConnectionComponent* anchorConnection,
         AFGBuildableRailroadSwitchControl* existingSwitchControl,
-        TArray<UFGRailroadTrackConnectionComponent*>& finalSwitchControlConnections);
+        const AutoLinkScratchArray<UFGRailroadTrackConnectionComponent*>& finalSwitchControlConnections);
 };
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FGBuildable.h"
+#include "FGBuildableConveyorBelt.h"
+#include "FGBuildableConveyorLift.h"
+#include "FGBuildablePipeHyper.h"
+#include "FGBuildablePipeline.h"
+#include "FGBuildableRailroadTrack.h"
+#include "FGFactoryConnectionComponent.h"
+
+// The buildables synthetic scenarios are made of. Each maps to a base game buildable class.
+enum class EAutoLinkScenarioClass : uint8
+{
+    ConveyorBelt,
+    ConveyorLift,
+    Splitter,
+    Merger,
+    Constructor,
+    StorageContainer,
+    DimensionalDepot,
+    Pipeline,
+    PipelineJunction,
+    PipeHyper,
+    RailroadTrack,
+    Num
+};
+
+// Spawns buildables for synthetic scenarios directly, without holograms, so none of AutoLink's hooks run and nothing is linked
+// until the scenario asks for it. Everything is spawned relative to Origin and destroyed again with DestroyAll.
+class AUTOLINK_API AutoLinkScenarioBuilder
+{
+public:
+    AutoLinkScenarioBuilder(UWorld* world, const FVector& origin);
+    ~AutoLinkScenarioBuilder();
+
+    // Loads the base game classes. Returns false (and logs which one) if any are missing.
+    static bool LoadClasses();
+    static UClass* GetClass(EAutoLinkScenarioClass scenarioClass);
+
+    AFGBuildable* SpawnBuildable(EAutoLinkScenarioClass scenarioClass, const FVector& location, const FRotator& rotation = FRotator::ZeroRotator);
+    AFGBuildableConveyorBelt* SpawnBelt(const FVector& start, const FVector& end);
+    AFGBuildableConveyorLift* SpawnLift(const FVector& bottom, float height, const FRotator& rotation = FRotator::ZeroRotator);
+    AFGBuildablePipeline* SpawnPipe(const FVector& start, const FVector& end);
+    // Hypertubes and tracks leave start along startDirection and curve to end. A zero direction means a straight one.
+    AFGBuildablePipeHyper* SpawnHyper(const FVector& start, const FVector& end, const FVector& startDirection = FVector::ZeroVector);
+    AFGBuildableRailroadTrack* SpawnTrack(const FVector& start, const FVector& end, const FVector& startDirection = FVector::ZeroVector);
+
+    // Spawns the buildable so one of its belt inputs sits on target facing back against outputNormal, the way a building is
+    // placed at the end of a belt. It only turns around Z, so outputNormal should be horizontal.
+    AFGBuildable* SpawnOnInput(EAutoLinkScenarioClass scenarioClass, const FVector& target, const FVector& outputNormal);
+
+    // The belt connector of the given direction whose normal is closest to facing, or any of them if facing is zero
+    static UFGFactoryConnectionComponent* FindConnection(AFGBuildable* buildable, EFactoryConnectionDirection direction, const FVector& facing = FVector::ZeroVector);
+
+    // Spawns a cross junction to measure how far its connectors are from its center, then destroys it again. Returns 0 if
+    // the junction can't be spawned.
+    double MeasureJunctionHalfSize();
+
+    // Destroys one buildable the scenario spawned, e.g. to swap it for another
+    void DestroyBuildable(AFGBuildable* buildable);
+
+    // Destroys everything spawned, including switch controls linking created for spawned tracks
+    void DestroyAll();
+
+    // Counts links between the connectors of spawned buildables. Each link is counted once.
+    int32 CountLinks() const;
+
+    const TArray<AFGBuildable*>& GetBuildables() const { return Buildables; }
+    UWorld* GetWorld() const { return World; }
+
+    FVector Origin;
+
+private:
+    template<typename T>
+    T* SpawnDeferred(EAutoLinkScenarioClass scenarioClass, const FTransform& transform, TFunctionRef<void(T*)> configure);
+
+    // Makes a spline in the actor's space that leaves the origin along +X and ends at localEnd
+    static TArray<FSplinePointData> MakeSpline(const FVector& localEnd);
+
+    // The actor transform for a spline from start to end that leaves start along startDirection (or straight if it's zero),
+    // and the end in the actor's space
+    FTransform GetSplineTransform(const FVector& start, const FVector& end, const FVector& startDirection, FVector& outLocalEnd) const;
+
+    UWorld* World;
+    TArray<AFGBuildable*> Buildables;
+
+    // Where each class's first belt input sits relative to the buildable and which way it faces, unrotated. Measured the
+    // first time SpawnOnInput needs it.
+    TMap<EAutoLinkScenarioClass, TPair<FVector, FVector>> InputProbes;
+
+    static inline UClass* Classes[(int32)EAutoLinkScenarioClass::Num] = {};
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkCore/AutoLinkStressLayout.h"
+#include "AutoLinkScenarioBuilder.h"
+
+// What a result records as its allocations when the game wasn't launched with -AutoLinkCountAllocations
+constexpr int32 NumAllocationsUnavailable = -1;
+
+// What one scenario did. Counters are summed over every link pass the scenario ran.
+struct AutoLinkScenarioResult
+{
+    FString Name;
+    TArray<FString> Failures;
+    int32 ExpectedLinks = 0;
+    int32 ActualLinks = 0;
+    int32 NumBuildables = 0;
+    int32 NumOpenConnectors = 0;
+    int32 NumPasses = 0;
+    double LinkMs = 0;
+    int32 NumHitScans = 0;
+    int32 NumOverlapScans = 0;
+    int32 NumPrefilteredScans = 0;
+    int32 NumSkippedScans = 0;
+    int32 NumSkippedChildren = 0;
+    int32 NumHitActors = 0;
+    int32 NumCandidates = 0;
+    int32 NumTrackRebuilds = 0;
+    double TrackRebuildMs = 0;
+    int32 NumAllocations = 0; // NumAllocationsUnavailable when AutoLinkAllocationCounter isn't installed
+
+    bool Passed() const { return Failures.Num() == 0; }
+};
+
+// Handed to each scenario. Scenarios spawn with Builder, link with Link, and state the links they expect with Expect.
+struct AutoLinkScenarioContext
+{
+    AutoLinkScenarioBuilder& Builder;
+    AutoLinkScenarioResult& Result;
+
+    // Links the buildables in order, the same way a blueprint Construct links its children (prefilter included), and adds the
+    // pass's time and counters to the result
+    void Link(const TArray<AFGBuildable*>& buildables, const TCHAR* source = TEXT("AutoLink.RunScenarios"));
+    void LinkAll(const TCHAR* source = TEXT("AutoLink.RunScenarios")) { Link(Builder.GetBuildables(), source); }
+
+    // Records a failure if the spawned buildables don't have exactly the expected number of links
+    void Expect(int32 expectedLinks, const TCHAR* what);
+
+    void Fail(const FString& message);
+};
+
+// Runs synthetic layouts through FindAndLinkForBuildable in a live world, checks the links they end up with and records how
+// long linking took. It needs a real game world (so it works on a dedicated server, including headless with -nullrhi) and is
+// driven by the AutoLink.RunScenarios console command. Results are written to Saved/AutoLink/ScenarioResults.json.
+class AUTOLINK_API AutoLinkScenarioRunner
+{
+public:
+    // Runs every scenario whose name contains filter (all of them if it's empty). Returns true if they all passed.
+    static bool RunScenarios(UWorld* world, const FString& filter, TArray<AutoLinkScenarioResult>& outResults);
+
+    // Spawns a procedural stress layout (see AutoLinkCore/AutoLinkStressLayout.h), links it the same way and checks it gets
+    // every link it was designed to have. A size of 0 is the layout's default size. Driven by the AutoLink.RunStress console
+    // command, which writes to Saved/AutoLink/StressResults.json.
+    static bool RunStress(UWorld* world, AutoLinkCore::StressLayoutType type, uint32 size, uint64 seed, AutoLinkScenarioResult& outResult);
+
+    // Spawns a columns x rows grid of factory modules (constructor, belt, splitter, belt, lift, storage container) and links
+    // them all in one pass the way a blueprint would be. Driven by the AutoLink.Bench console command, which writes to
+    // Saved/AutoLink/BenchResults.json.
+    static bool RunBench(UWorld* world, int32 columns, int32 rows, AutoLinkScenarioResult& outResult);
+
+    static bool WriteResults(const TArray<AutoLinkScenarioResult>& results, const FString& filePath);
+    static bool ReadResults(const FString& filePath, TArray<AutoLinkScenarioResult>& outResults);
+
+    // Compares results against a baseline read from an earlier results file. Counters don't depend on the hardware, so any
+    // difference in them is a regression. Times are compared per scenario name using the fastest run of each, and are a regression
+    // when they are more than maxSlowdownPercent slower. Scenarios missing from the baseline are skipped. Returns true if there
+    // were no regressions.
+    static bool CompareToBaseline(
+        const TArray<AutoLinkScenarioResult>& results,
+        const TArray<AutoLinkScenarioResult>& baseline,
+        float maxSlowdownPercent,
+        TArray<FString>& outRegressions);
+
+    static FString GetResultsFilePath();
+    static FString GetStressResultsFilePath();
+    static FString GetBenchResultsFilePath();
+
+    // Where the baseline for a results file lives, e.g. Saved/AutoLink/Baselines/ScenarioResults.json
+    static FString GetBaselineFilePath(const FString& resultsFilePath);
+
+private:
+    static void BeltGrid(AutoLinkScenarioContext& context);
+    static void LiftStacks(AutoLinkScenarioContext& context);
+    static void PipeManifold(AutoLinkScenarioContext& context);
+    static void RailYard(AutoLinkScenarioContext& context);
+    static void StorageDepotSwap(AutoLinkScenarioContext& context);
+    static void SinglePlacements(AutoLinkScenarioContext& context);
+    static void SteadyStateAllocations(AutoLinkScenarioContext& context);
+
+    // Spawns a belt of the given length going straight out of (or into) every belt connector on the buildable and returns
+    // how many it spawned
+    static int32 SpawnBeltsAtConnectors(AutoLinkScenarioBuilder& builder, AFGBuildable* buildable, float length, float startOffset = 0);
+
+    // Same for pipes on fluid connectors
+    static int32 SpawnPipesAtConnectors(AutoLinkScenarioBuilder& builder, AFGBuildable* buildable, float length);
+
+    // Spawns every piece of the layout and returns how many it spawned
+    static int32 SpawnStressLayout(AutoLinkScenarioBuilder& builder, const AutoLinkCore::StressLayout& layout);
+
+    // Spawns one bench module and returns how many links it should make, or 0 if any part of it failed to spawn
+    static int32 SpawnFactoryModule(AutoLinkScenarioBuilder& builder, const FVector& location);
+
+    static void LogResult(const AutoLinkScenarioResult& result);
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/MemStack.h"
+
+// Containers for the temporary arrays and sets a link pass builds for every connector it looks at. They allocate from the game
+// thread's FMemStack, which the outermost AutoLinkPassScope marks when a pass starts and pops when it ends. Allocating is a
+// pointer bump, nothing is freed one by one, and once the stack's pages have been touched a pass makes no heap allocations for
+// its scratch at all. Only use these inside a pass, on the game thread, and never keep one past the end of the pass.
+using AutoLinkScratchAllocator = TMemStackAllocator<>;
+
+template<typename T>
+using AutoLinkScratchArray = TArray<T, AutoLinkScratchAllocator>;
+
+using AutoLinkScratchSetAllocator = TSetAllocator<
+    TSparseArrayAllocator<AutoLinkScratchAllocator, TInlineAllocator<4, AutoLinkScratchAllocator>>,
+    TInlineAllocator<1, AutoLinkScratchAllocator>>;
+
+template<typename T>
+using AutoLinkScratchSet = TSet<T, DefaultKeyFuncs<T>, AutoLinkScratchSetAllocator>;
+
+template<typename KeyType, typename ValueType>
+using AutoLinkScratchMap = TMap<KeyType, ValueType, AutoLinkScratchSetAllocator>;
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkConnectorExport.h"
+#include "FGBuildable.h"
+
+// Shadow mode (AutoLink.ShadowMode) checks a faster link engine against the one that actually links. Before the scene query path
+// links a buildable, the buildable's connectors are matched with the AutoLinkCore rules against the candidates
+// AutoLinkConnectorIndex has around them, and nothing that decides is committed. Once the scene query path is done, the links
+// it made are compared with those decisions. Every difference is logged as a warning and every pass logs how long each engine
+// took. Passes are bracketed by the outermost AutoLinkPassScope and buildables by AutoLinkShadowBuildableScope. Everything
+// here is game-thread only.
+class AUTOLINK_API AutoLinkShadow
+{
+public:
+    static bool IsActive() { return bIsActive; }
+
+    static void BeginPass(const TCHAR* source);
+    static void EndPass();
+    static void BeginBuildable(AFGBuildable* buildable);
+    static void EndBuildable(AFGBuildable* buildable);
+
+    // Reports a link the scene query path made
+    static void RecordLink(const UActorComponent* connection, const UActorComponent* candidate);
+
+private:
+    using LinkPair = TPair<const UActorComponent*, const UActorComponent*>;
+
+    static LinkPair MakePair(const UActorComponent* first, const UActorComponent* second);
+    static FString DescribeLinks(const TArray<LinkPair>& links);
+
+    static inline bool bIsActive = false;
+    static inline bool bHasWarnedAttachmentLinks = false;
+    static inline AutoLinkClassTable ClassTable;
+
+    static inline const TCHAR* PassSource = nullptr;
+    static inline int32 PassBuildables = 0;
+    static inline int32 PassMismatches = 0;
+    static inline uint64 PassLegacyCycles = 0;
+    static inline uint64 PassIndexCycles = 0;
+
+    static inline bool bIsInBuildable = false;
+    static inline uint64 LegacyStartCycles = 0;
+    static inline TArray<LinkPair> LegacyLinks;
+    static inline TArray<LinkPair> IndexLinks;
+
+    static inline int32 NumPasses = 0;
+    static inline int32 NumBuildables = 0;
+    static inline int32 NumMismatches = 0;
+    static inline uint64 TotalLegacyCycles = 0;
+    static inline uint64 TotalIndexCycles = 0;
+};
+
+// Brackets the scene query path linking one buildable, if shadow mode is active
+class AutoLinkShadowBuildableScope
+{
+public:
+    AutoLinkShadowBuildableScope(AFGBuildable* buildable)
+        : Buildable(AutoLinkShadow::IsActive() ? buildable : nullptr)
+    {
+        if (Buildable)
+        {
+            AutoLinkShadow::BeginBuildable(Buildable);
+        }
+    }
+
+    ~AutoLinkShadowBuildableScope()
+    {
+        if (Buildable)
+        {
+            AutoLinkShadow::EndBuildable(Buildable);
+        }
+    }
+
+private:
+    AFGBuildable* Buildable;
+};
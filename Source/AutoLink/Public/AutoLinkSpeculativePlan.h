@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkScratch.h"
+#include "WorldCollision.h"
+
+class AutoLinkBlueprintManifest;
+
+// Runs a blueprint paste's scene queries while the player is still aiming it. Tiling a blueprint means pasting the same one
+// again and again, and once it has been pasted its manifest says where its open connectors end up relative to the hologram.
+// When a blueprint hologram has held still for AutoLink.SpeculativePlanDelayMs, the plan sends an async overlap query to the
+// physics scene for every place those connectors will be, as far out as any of them scans. The results come back over the
+// next frames without holding up the game thread.
+//
+// When the blueprint is built, the plan is used if the hologram was built where it was planned, it is the same blueprint (by
+// manifest signature), every query has come back and nothing was built or dismantled in the world since the queries went
+// out. HitScan and OverlapScan then answer from the planned actors plus the blueprint's own children near the connector
+// instead of querying the scene. A query covers everything either scan could hit, and the candidates still go through all
+// the usual rules. Anything else, like a different blueprint, a hologram that was moved or a plan that isn't done, falls
+// back to the scans.
+//
+// Planning needs the hologram being aimed to be in the same world as the one being built, so it happens in single player and
+// for the host, but not for clients of a dedicated server. Game thread only.
+class AUTOLINK_API AutoLinkSpeculativePlan
+{
+public:
+    // Call whenever a blueprint hologram is moved (or held still) by the build gun
+    static void OnHologramMoved(const AActor* hologram);
+
+    // Call around AFGBlueprintHologram::Construct
+    static void BeginConstruct(const AActor* hologram);
+    static void EndConstruct(const AActor* hologram, const TArray<AActor*>& children);
+
+    // Call whenever a buildable is added to or removed from the world
+    static void NoteWorldChanged();
+
+    // Appends the actors the plan found around location, other than ignoreActor, and the blueprint's children near it. Returns
+    // false without appending anything when no plan is in use or it has no query at location.
+    static bool FindPlannedActors(const FVector& location, AActor* ignoreActor, AutoLinkScratchArray<AActor*>& outActors);
+
+private:
+    friend class AutoLinkSpeculativePlanScope;
+
+    struct PlannedScan
+    {
+        FVector Location = FVector::ZeroVector;
+        float Radius = 0;
+        FTraceHandle Handle;
+        TArray<TWeakObjectPtr<AActor>> Actors;
+    };
+
+    static void Start(UWorld* world, const FTransform& frame, const AActor* hologram);
+    static void Drop();
+    static void OnScanDone(const FTraceHandle& handle, FOverlapDatum& datum);
+    static uint64 GetTransformKey(const FTransform& frame);
+
+    // What the last blueprint built looked like, which is what the next aim is planned with
+    static inline TSharedPtr<const AutoLinkBlueprintManifest> Manifest;
+    static inline FTransform HologramToFrame;
+    static inline uint64 ConstructedFrameKey = 0;
+
+    static inline uint64 PlanKey = 0;
+    static inline double StillSinceSeconds = 0;
+    static inline bool bIsStarted = false;
+    static inline bool bIsCommitted = false;
+    static inline bool bIsActive = false;
+    static inline bool bIsConstructing = false;
+    static inline uint32 Generation = 0;
+    static inline uint32 PlanGeneration = 0;
+    static inline int32 NumScansDone = 0;
+    static inline TArray<PlannedScan> Scans;
+    static inline TMap<FIntVector, int32> ScanIndices;
+};
+
+// Puts the plan to use for a blueprint's link pass if it was made for these children, and keeps their manifest for planning
+// the next paste. Lives inside an AutoLinkBlueprintPrefilterScope, whose children it looks up.
+class AUTOLINK_API AutoLinkSpeculativePlanScope
+{
+public:
+    AutoLinkSpeculativePlanScope(const TArray<AActor*>& children, const TSharedRef<const AutoLinkBlueprintManifest>& manifest);
+    ~AutoLinkSpeculativePlanScope();
+
+private:
+    bool bIsForConstructedChildren = false;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkScratch.h"
+#include "UObject/ObjectKey.h"
+
+class AFGBuildable;
+class UWorld;
+
+// Remembers what a buildable being upgraded or replaced with the build gun was linked to, so its replacement can link back to
+// the same buildables without querying the scene. Swapping a storage container for a dimensional depot or a splitter for a
+// smart splitter puts the new buildable where the old one was, and whatever the old one was linked to is open again once it's
+// gone. Belts and lifts carry their own connections over when upgraded, so they never get here.
+//
+// The ConfigureComponents hooks record the old buildable's connectors and the owners of whatever each one was linked to while
+// the old buildable still exists. When the new buildable links, HitScan and OverlapScan answer from that record for any scan
+// that starts within Tolerances::BeltSearchDistance of one of the old connectors, and go to the scene for the rest. The old
+// partners still go through all the usual rules. They are only a first try: a connector that links none of them, because they
+// are gone, full or no longer line up, scans the scene after all.
+//
+// A record is used up when its buildable links. One that is still there at the end of the tick its world recorded it in
+// belongs to a buildable that was never linked, and is dropped. Game thread only.
+class AUTOLINK_API AutoLinkUpgradeMap
+{
+public:
+    // Call with every hologram and the buildable it built. Does nothing unless the hologram upgraded or replaced something.
+    static void Record(const AActor* hologram, AFGBuildable* buildable);
+
+    // Drops the world's records that weren't used this tick
+    static void EndFrame(UWorld* world);
+
+    // Appends the old partners recorded near location for the buildable being linked, other than ignoreActor. Returns false
+    // without appending anything when the buildable didn't replace anything or no old connector was near location.
+    static bool FindPartnerActors(const FVector& location, AActor* ignoreActor, AutoLinkScratchArray<AActor*>& outActors);
+
+private:
+    friend class AutoLinkUpgradeScope;
+
+    struct OldConnector
+    {
+        FVector Location = FVector::ZeroVector;
+        TArray<TWeakObjectPtr<AActor>> Partners;
+    };
+
+    struct UpgradeRecord
+    {
+        TWeakObjectPtr<UWorld> World;
+        TArray<OldConnector> OldConnectors;
+    };
+
+    static inline TMap<TObjectKey<AActor>, UpgradeRecord> Records;
+    static inline const TArray<OldConnector>* Active = nullptr;
+};
+
+// Puts the record of what the buildable replaced to use while it links, and forgets it afterwards
+class AUTOLINK_API AutoLinkUpgradeScope
+{
+public:
+    AutoLinkUpgradeScope(AFGBuildable* buildable);
+    ~AutoLinkUpgradeScope();
+
+private:
+    TArray<AutoLinkUpgradeMap::OldConnector> OldConnectors;
+    const TArray<AutoLinkUpgradeMap::OldConnector>* PreviousActive = nullptr;
+};
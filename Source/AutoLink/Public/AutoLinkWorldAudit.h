@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkWorldSnapshot.h"
+#include "Async/Future.h"
+
+// Finds the seams in a loaded world, pairs of connectors the placement rules would link that aren't linked, and links them.
+// Saves from before AutoLink was installed, or from versions that missed some cases, can have thousands of them, and nothing
+// ever looks at them again unless something is built next to them.
+//
+// With AutoLink.LoadAudit on, the first tick after a world begins play takes a snapshot of the connector index and hands it to
+// the thread pool, where every connector kind is matched on its own worker with the same rules as AutoLinkCore::FindLinks. Only
+// pairs of connectors with no links at all count as seams. Back on the game thread the matched pairs are linked as they are, a
+// slice per frame (AutoLink.LoadAuditLinksPerFrame), so the links are spread over the first seconds and nothing is queried
+// again. A seam with an end that changed since the snapshot is skipped, and each end is checked again like
+// AutoLinkDeferredLinks does before linking. The audit ticks after the world's actors, so linking attachments is safe. Once
+// every slice is in, the audit logs how many seams it found, how many it linked itself and how long each step took.
+//
+// AutoLink.AuditWorld runs the same audit on demand. Only one audit runs at a time, and only where the world has authority.
+class AUTOLINK_API AutoLinkWorldAudit
+{
+public:
+    // Hooks the end of every world tick. Call once when the mod starts.
+    static void Initialize();
+
+    // Starts an audit of the world unless one is running. Game thread only.
+    static bool Start(UWorld* world);
+
+private:
+    struct Seam
+    {
+        AutoLinkSnapshotHandle Connector;
+        AutoLinkSnapshotHandle Candidate;
+    };
+
+    struct MatchResult
+    {
+        TArray<Seam> Seams;
+        int32 NumConnectors = 0;
+        double CollectMs = 0;
+        double MatchMs = 0;
+    };
+
+    enum class EPhase : uint8
+    {
+        Idle,
+        Matching,
+        Committing,
+    };
+
+    static void Tick(UWorld* world);
+
+    // Runs on the thread pool
+    static MatchResult Match(const AutoLinkWorldSnapshot::Ptr& snapshot);
+
+    static void CommitSlice();
+
+    // Links the two ends of a seam if they can still be linked, the way placing would. Returns whether it linked them.
+    static bool CommitSeam(UActorComponent* connection, UActorComponent* candidate);
+    static void Finish();
+
+    static inline EPhase Phase = EPhase::Idle;
+    static inline TWeakObjectPtr<UWorld> World;
+    static inline TWeakObjectPtr<UWorld> LastLoadedWorld;
+    static inline AutoLinkWorldSnapshot::Ptr Snapshot;
+    static inline TFuture<MatchResult> PendingMatch;
+    static inline MatchResult Result;
+    static inline int32 NextSeam = 0;
+    static inline int32 NumRepairedSeams = 0;
+    static inline double StartSeconds = 0;
+    static inline double CommitStartSeconds = 0;
+};
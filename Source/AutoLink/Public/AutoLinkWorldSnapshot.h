@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutoLinkCore/AutoLinkGeometry.h"
+
+#include <vector>
+
+// One cell of a snapshot, as it was when it was copied out of AutoLinkConnectorIndex
+struct AutoLinkSnapshotCell
+{
+    std::vector<AutoLinkCore::Connector> Connectors;
+
+    // Same order as Connectors. Copying these is fine on any thread, getting the component out of them is not.
+    TArray<TWeakObjectPtr<UActorComponent>> Components;
+    TArray<uint32> Generations;
+};
+
+// A fixed slice of a snapshot's cells, picked by hashing the cell's coordinates. Snapshots share every chunk none of whose
+// cells changed between them, so publishing one only copies the chunks with changed cells instead of the whole map.
+struct AutoLinkSnapshotChunk
+{
+    TMap<FIntVector, TSharedRef<const AutoLinkSnapshotCell, ESPMode::ThreadSafe>> Cells;
+};
+
+// Where a connector found in a snapshot came from and what state it was in, so the game thread can tell whether it changed
+struct AutoLinkSnapshotHandle
+{
+    TWeakObjectPtr<UActorComponent> Component;
+    uint32 Generation = 0;
+    uint8 NumConnections = 0;
+};
+
+// An immutable copy of every connector AutoLinkConnectorIndex knows about, for planning links away from the game thread. Any
+// number of threads can read one without locks while the game thread keeps building, dismantling and linking, since nothing in
+// a snapshot changes once it is published. Get the latest from AutoLinkConnectorIndex::GetSnapshot on the game thread and hand
+// the shared pointer to the workers.
+//
+// Before acting on a plan, the game thread checks each end with IsCurrent. A connector is current while its component is
+// alive, AutoLink hasn't linked it since the snapshot (its generation in the index is the same) and it has as many connections
+// as it had then, which also catches links the game made on its own. Plans with an end that isn't current are dropped or made
+// again from a newer snapshot.
+class AUTOLINK_API AutoLinkWorldSnapshot
+{
+public:
+    using Ptr = TSharedPtr<const AutoLinkWorldSnapshot, ESPMode::ThreadSafe>;
+
+    // The index's epoch when this was published. The index bumps its epoch on every change, so equal epochs mean nothing in the
+    // index changed since.
+    uint64 GetEpoch() const { return Epoch; }
+    int32 GetNumConnectors() const { return NumConnectors; }
+
+    // Appends every connector in the cell location is in and the 26 around it. Any thread.
+    void FindNearby(const AutoLinkCore::Vector& location, std::vector<AutoLinkCore::Connector>& outConnectors, TArray<AutoLinkSnapshotHandle>& outHandles) const;
+
+    // Appends every connector in the snapshot. Any thread.
+    void AppendAll(std::vector<AutoLinkCore::Connector>& outConnectors, TArray<AutoLinkSnapshotHandle>& outHandles) const;
+
+    // Whether a connector found in this snapshot is still the way it was. Game thread only.
+    bool IsCurrent(const AutoLinkSnapshotHandle& handle) const;
+
+private:
+    friend class AutoLinkConnectorIndex;
+
+    // A power of two. Enough that a chunk holds a few dozen cells in a big factory, so copying the chunk array and the chunks
+    // that changed stays small next to the cells themselves.
+    static constexpr int32 NumChunks = 1024;
+
+    static int32 GetChunkIndex(const FIntVector& cell) { return (int32)(GetTypeHash(cell) & (NumChunks - 1)); }
+
+    const AutoLinkSnapshotCell* FindCell(const FIntVector& cell) const;
+
+    uint64 Epoch = 0;
+    int32 NumConnectors = 0;
+
+    // NumChunks of them once published
+    TArray<TSharedRef<const AutoLinkSnapshotChunk, ESPMode::ThreadSafe>> Chunks;
+};
@@ -0,0 +1,298 @@
+// Measures how fast the AutoLink matching rules run outside the game. For every connector kind it builds a synthetic layout,
+// times the raw candidate rules (the hot kernel the mod runs for every candidate a scene query returns) and then times each
+// batch matching strategy over the whole layout, checking that every strategy makes the same decisions as the reference.
+//
+// Usage: AutoLinkBench [--connectors N] [--iterations N]
+
+#include "AutoLinkCore/AutoLinkGeometry.h"
+#include "AutoLinkCore/AutoLinkMatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace AutoLinkCore;
+
+struct BenchOptions
+{
+    size_t NumConnectors = 4000;
+    int Iterations = 5;
+};
+
+static Connector MakeConnector(Vector location, Vector normal, ConnectorKind kind, ConnectorDirection direction, uint32_t ownerId, uint8_t ownerFlags, uint8_t maxConnections = 1)
+{
+    Connector connector{};
+    connector.Location = location;
+    connector.Normal = normal;
+    connector.Kind = kind;
+    connector.Direction = direction;
+    connector.OwnerId = ownerId;
+    connector.OwnerFlags = ownerFlags;
+    connector.MaxConnections = maxConnections;
+    return connector;
+}
+
+// Rows of belt segments laid end to end, with a storage container at the end of every row
+static std::vector<Connector> MakeBeltLayout(size_t numConnectors)
+{
+    std::vector<Connector> connectors;
+    const size_t segmentsPerRow = 50;
+    uint32_t ownerId = 0;
+    for (size_t row = 0; connectors.size() < numConnectors; ++row)
+    {
+        const double y = (double)row * 300.0;
+        for (size_t segment = 0; segment < segmentsPerRow && connectors.size() < numConnectors; ++segment)
+        {
+            const double startX = (double)segment * 400.0;
+            connectors.push_back(MakeConnector({ startX, y, 0 }, { -1, 0, 0 }, ConnectorKind::Belt, ConnectorDirection::Input, ownerId, OwnerFlags::ConveyorBelt));
+            connectors.push_back(MakeConnector({ startX + 400.0, y, 0 }, { 1, 0, 0 }, ConnectorKind::Belt, ConnectorDirection::Output, ownerId, OwnerFlags::ConveyorBelt));
+            ++ownerId;
+        }
+
+        connectors.push_back(MakeConnector({ segmentsPerRow * 400.0, y, 0 }, { -1, 0, 0 }, ConnectorKind::Belt, ConnectorDirection::Input, ownerId++, OwnerFlags::Storage));
+    }
+
+    return connectors;
+}
+
+// Columns of conveyor lifts stacked with 400 units between each lift's top and the next one's bottom
+static std::vector<Connector> MakeLiftLayout(size_t numConnectors)
+{
+    std::vector<Connector> connectors;
+    const size_t liftsPerStack = 50;
+    uint32_t ownerId = 0;
+    for (size_t stack = 0; connectors.size() < numConnectors; ++stack)
+    {
+        const double x = (double)(stack % 40) * 600.0;
+        const double y = (double)(stack / 40) * 600.0;
+        for (size_t lift = 0; lift < liftsPerStack && connectors.size() < numConnectors; ++lift)
+        {
+            const double bottomZ = (double)lift * 800.0;
+            connectors.push_back(MakeConnector({ x, y, bottomZ }, { 0, 0, -1 }, ConnectorKind::Belt, ConnectorDirection::Input, ownerId, OwnerFlags::ConveyorLift));
+            connectors.push_back(MakeConnector({ x, y, bottomZ + 400.0 }, { 0, 0, 1 }, ConnectorKind::Belt, ConnectorDirection::Output, ownerId, OwnerFlags::ConveyorLift));
+            ++ownerId;
+        }
+    }
+
+    return connectors;
+}
+
+// Pipe runs with a junction every few segments. Junctions get four connectors, two of which continue the run.
+static std::vector<Connector> MakePipeLayout(size_t numConnectors, ConnectorKind kind)
+{
+    std::vector<Connector> connectors;
+    uint32_t ownerId = 0;
+    for (size_t run = 0; connectors.size() < numConnectors; ++run)
+    {
+        const double y = (double)run * 500.0;
+        double x = 0;
+        for (size_t segment = 0; segment < 60 && connectors.size() < numConnectors; ++segment)
+        {
+            const bool isJunction = kind == ConnectorKind::Fluid && segment % 4 == 3;
+            const double length = isJunction ? 100.0 : 600.0;
+            const uint8_t flags = isJunction ? OwnerFlags::PipelineJunction : OwnerFlags::None;
+            connectors.push_back(MakeConnector({ x, y, 0 }, { -1, 0, 0 }, kind, ConnectorDirection::Any, ownerId, flags));
+            connectors.push_back(MakeConnector({ x + length, y, 0 }, { 1, 0, 0 }, kind, ConnectorDirection::Any, ownerId, flags));
+            if (isJunction)
+            {
+                connectors.push_back(MakeConnector({ x + length / 2, y + 50, 0 }, { 0, 1, 0 }, kind, ConnectorDirection::Any, ownerId, flags));
+                connectors.push_back(MakeConnector({ x + length / 2, y - 50, 0 }, { 0, -1, 0 }, kind, ConnectorDirection::Any, ownerId, flags));
+            }
+
+            x += length;
+            ++ownerId;
+        }
+    }
+
+    return connectors;
+}
+
+// Parallel tracks where every fourth joint is a three-way switch
+static std::vector<Connector> MakeRailLayout(size_t numConnectors)
+{
+    std::vector<Connector> connectors;
+    const uint8_t maxConnections = Tolerances::MaxConnectionsPerRailConnector;
+    uint32_t ownerId = 0;
+    for (size_t line = 0; connectors.size() < numConnectors; ++line)
+    {
+        const double y = (double)line * 2000.0;
+        for (size_t track = 0; track < 40 && connectors.size() < numConnectors; ++track)
+        {
+            const double startX = (double)track * 1200.0;
+            connectors.push_back(MakeConnector({ startX, y, 0 }, { -1, 0, 0 }, ConnectorKind::Railroad, ConnectorDirection::Any, ownerId, OwnerFlags::None, maxConnections));
+            connectors.push_back(MakeConnector({ startX + 1200.0, y, 0 }, { 1, 0, 0 }, ConnectorKind::Railroad, ConnectorDirection::Any, ownerId, OwnerFlags::None, maxConnections));
+            ++ownerId;
+
+            if (track % 4 == 3)
+            {
+                // Two more tracks leaving the same joint, slightly curved so their normals are a little off axis
+                for (double bend : { .004, -.004 })
+                {
+                    const double normalY = bend;
+                    const double normalX = -std::sqrt(1 - normalY * normalY);
+                    connectors.push_back(MakeConnector({ startX + 1200.0, y, 0 }, { normalX, normalY, 0 }, ConnectorKind::Railroad, ConnectorDirection::Any, ownerId, OwnerFlags::None, maxConnections));
+                    connectors.push_back(MakeConnector({ startX + 2400.0, y + bend * 100000, 0 }, { -normalX, normalY, 0 }, ConnectorKind::Railroad, ConnectorDirection::Any, ownerId, OwnerFlags::None, maxConnections));
+                    ++ownerId;
+                }
+            }
+        }
+    }
+
+    return connectors;
+}
+
+struct Layout
+{
+    const char* Name;
+    std::vector<Connector> Connectors;
+};
+
+static double GetElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs the per-pair rules over every adjacent pair in the layout, which is the work the mod does per scene query result
+static void BenchKernel(const Layout& layout, int iterations)
+{
+    const auto& connectors = layout.Connectors;
+    if (connectors.size() < 2)
+    {
+        return;
+    }
+
+    size_t numCompatible = 0;
+    size_t numEvaluated = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        for (size_t i = 0; i + 1 < connectors.size(); ++i)
+        {
+            for (size_t j = i + 1; j < connectors.size() && j < i + 8; ++j)
+            {
+                const Connector& connector = connectors[i];
+                const Connector& candidate = connectors[j];
+                bool compatible = false;
+                switch (connector.Kind)
+                {
+                case ConnectorKind::Belt:
+                {
+                    double distance;
+                    compatible = EvaluateBeltCandidate(connector, candidate, distance) == BeltCandidateResult::Compatible;
+                    break;
+                }
+                case ConnectorKind::Railroad:
+                    compatible = EvaluateRailCandidate(connector, candidate) == RailCandidateResult::Compatible;
+                    break;
+                default:
+                    compatible = EvaluatePipeCandidate(connector, candidate) == PipeCandidateResult::Compatible;
+                    break;
+                }
+
+                numCompatible += compatible ? 1 : 0;
+                ++numEvaluated;
+            }
+        }
+    }
+
+    const double elapsedMs = GetElapsedMs(start);
+    std::printf("%-10s %-12s %10zu %10zu %12.3f %16.0f\n",
+        layout.Name,
+        "Kernel",
+        numEvaluated / iterations,
+        numCompatible / iterations,
+        elapsedMs / iterations,
+        (double)numEvaluated / (elapsedMs / 1000.0));
+}
+
+// Returns false if the strategy disagreed with the reference
+static bool BenchStrategy(const Layout& layout, MatchStrategy strategy, int iterations, const std::vector<LinkDecision>& reference)
+{
+    std::vector<LinkDecision> decisions;
+    MatchStats stats;
+    auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        decisions.clear();
+        stats = MatchStats();
+        FindLinks(layout.Connectors, strategy, decisions, &stats);
+    }
+
+    const double elapsedMs = GetElapsedMs(start);
+    std::printf("%-10s %-12s %10zu %10zu %12.3f %16.0f\n",
+        layout.Name,
+        ToString(strategy),
+        layout.Connectors.size(),
+        decisions.size(),
+        elapsedMs / iterations,
+        (double)layout.Connectors.size() / (elapsedMs / (double)iterations / 1000.0));
+
+    if (decisions != reference)
+    {
+        std::printf("ERROR: %s made %zu decisions for %s that differ from the %zu the reference made!\n",
+            ToString(strategy), decisions.size(), layout.Name, reference.size());
+        return false;
+    }
+
+    return true;
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--connectors") == 0 && i + 1 < argc)
+        {
+            options.NumConnectors = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+        {
+            options.Iterations = std::max(1, std::atoi(argv[++i]));
+        }
+        else
+        {
+            std::printf("Usage: %s [--connectors N] [--iterations N]\n", argv[0]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    std::vector<Layout> layouts;
+    layouts.push_back({ "Belt", MakeBeltLayout(options.NumConnectors) });
+    layouts.push_back({ "Lift", MakeLiftLayout(options.NumConnectors) });
+    layouts.push_back({ "Pipe", MakePipeLayout(options.NumConnectors, ConnectorKind::Fluid) });
+    layouts.push_back({ "Hyper", MakePipeLayout(options.NumConnectors, ConnectorKind::Hyper) });
+    layouts.push_back({ "Rail", MakeRailLayout(options.NumConnectors) });
+
+    std::printf("%-10s %-12s %10s %10s %12s %16s\n", "Layout", "Strategy", "Inputs", "Links", "Ms/iter", "Inputs/sec");
+
+    bool allMatched = true;
+    for (const auto& layout : layouts)
+    {
+        BenchKernel(layout, options.Iterations);
+
+        std::vector<LinkDecision> reference;
+        FindLinks(layout.Connectors, MatchStrategy::BruteForce, reference);
+        for (int strategy = 0; strategy < (int)MatchStrategy::Num; ++strategy)
+        {
+            allMatched = BenchStrategy(layout, (MatchStrategy)strategy, options.Iterations, reference) && allMatched;
+        }
+    }
+
+    return allMatched ? 0 : 1;
+}
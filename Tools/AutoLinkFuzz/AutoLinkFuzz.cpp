@@ -0,0 +1,488 @@
+// Fuzzes the matching strategies against the candidate rules they are built on. Every input is turned into a handful of
+// connectors placed right on the edges the rules decide on: touching within 1 cm per component, the 2.563 degree cosine
+// tolerance, the 1 unit offset padding around every lift and depot window, the pipe and rail cross product tolerances
+// (including the looser vertical one on rails), float rounding of normals and grid cell borders. Two things are checked:
+//
+// - Every MatchStrategy makes exactly the same decisions as BruteForce, the reference.
+// - For a lone pair, BruteForce links exactly when the Evaluate*Candidate rule for that pair says it should.
+//
+// Any new fast path (a quantized grid, a SIMD kernel) only has to be added as a MatchStrategy to be fuzzed with the rest.
+//
+// Built with -DAUTOLINK_LIBFUZZER=ON (Clang only) this is a libFuzzer target and takes libFuzzer's usual arguments, e.g.
+// AutoLinkFuzz -max_total_time=600 corpus. Otherwise it has its own driver, which runs random inputs or replays crash files:
+//
+// Usage: AutoLinkFuzz [--runs N] [--seed N] [Input...]
+
+#include "AutoLinkCore/AutoLinkGeometry.h"
+#include "AutoLinkCore/AutoLinkMatcher.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace AutoLinkCore;
+
+// Hands out choices from the fuzz input. Once it runs out every choice is 0, so short inputs are still complete layouts.
+struct FuzzInput
+{
+    const uint8_t* Data;
+    size_t Size;
+    size_t Position = 0;
+
+    uint8_t Byte()
+    {
+        return Position < Size ? Data[Position++] : 0;
+    }
+
+    uint32_t Choose(uint32_t count)
+    {
+        const uint32_t value = (uint32_t)Byte() << 8 | Byte();
+        return value % count;
+    }
+
+    template<typename T, size_t N>
+    T Pick(const T (&values)[N])
+    {
+        return values[Choose((uint32_t)N)];
+    }
+
+    // Between -1 and 1
+    double Signed()
+    {
+        return Choose(65536) / 32767.5 - 1.0;
+    }
+};
+
+// How far a connector's normal can be turned before the cosine tolerance rejects it
+static const double CosineToleranceAngle = std::acos(1.0 - Tolerances::BeltCosineTolerance);
+
+// Small nudges that push a value just over or just under whatever edge it was put on
+static const double Nudges[] = { 0, 1e-9, -1e-9, 1e-7, -1e-7, 1e-5, -1e-5, 1e-3, -1e-3, .01, -.01, .5, -.5 };
+
+static double Nudge(FuzzInput& input, double value)
+{
+    return value + input.Pick(Nudges) * (input.Choose(4) == 0 ? std::abs(value) + 1 : 1);
+}
+
+static Vector RoundToFloat(const Vector& vector)
+{
+    return { (double)(float)vector.X, (double)(float)vector.Y, (double)(float)vector.Z };
+}
+
+// Any unit vector at right angles to the given one
+static Vector GetPerpendicular(const Vector& normal)
+{
+    const Vector axis = std::abs(normal.Z) < .9 ? Vector{ 0, 0, 1 } : Vector{ 1, 0, 0 };
+    Vector perpendicular;
+    double length;
+    Vector::CrossProduct(normal, axis).ToDirectionAndLength(perpendicular, length);
+    return perpendicular;
+}
+
+// Turns the unit vector by the given angle towards the (unit, perpendicular) axis
+static Vector Tilt(const Vector& normal, const Vector& towards, double angle)
+{
+    return normal * std::cos(angle) + towards * std::sin(angle);
+}
+
+static Vector MakeNormal(FuzzInput& input)
+{
+    static const Vector Axes[] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    if (input.Choose(3) > 0)
+    {
+        return input.Pick(Axes);
+    }
+
+    Vector normal;
+    double length;
+    Vector{ input.Signed(), input.Signed(), input.Signed() }.ToDirectionAndLength(normal, length);
+    return length > 0 ? normal : Vector{ 1, 0, 0 };
+}
+
+// Angles either side of every tolerance the connector kind holds a pair of normals to
+static double MakeTiltAngle(FuzzInput& input, ConnectorKind kind)
+{
+    double angle = 0;
+    switch (kind)
+    {
+    case ConnectorKind::Belt:
+        angle = input.Pick({
+            0.0,
+            CosineToleranceAngle,                                     // Normals pointing along the line between the connectors
+            CosineToleranceAngle / 2,                                 // Half on each side still adds up to the tolerance
+            std::acos(1.0 - Tolerances::BeltTouchingNormalDistance) }); // Touching belts use PointsAreNear on the normals instead
+        break;
+    case ConnectorKind::Railroad:
+        angle = input.Pick({
+            0.0,
+            std::asin(Tolerances::RailCrossProductXYTolerance),
+            std::asin(Tolerances::RailCrossProductZTolerance) });      // Vertically, i.e. a right angle
+        break;
+    default:
+        angle = input.Pick({ 0.0, std::asin(Tolerances::PipeCrossProductTolerance) });
+        break;
+    }
+
+    return Nudge(input, angle);
+}
+
+// Distances along the normal either side of every edge the connector kind is held to. Belts have offset windows (padded,
+// and stretched or shrunk for depots); everything else has to be within 1 cm.
+static double MakeOffset(FuzzInput& input, ConnectorKind kind)
+{
+    static const double Offsets[] =
+    {
+        0,
+        Tolerances::BeltTouchingDistance,
+        Tolerances::LiftMinOffsetIntoBuilding,
+        Tolerances::BeltToLiftMaxOffset,
+        Tolerances::LiftToBuildingMaxOffset,
+        Tolerances::LiftToLiftMaxOffset,
+    };
+
+    double offset = 0;
+    if (kind == ConnectorKind::Belt)
+    {
+        const double padding = input.Pick({ 0.0, (double)Tolerances::BeltConnectorOffsetPadding, -(double)Tolerances::BeltConnectorOffsetPadding });
+        const double depot = input.Choose(3) == 0 ? input.Pick({ (double)Tolerances::StorageDepotAlignmentOffset, -(double)Tolerances::StorageDepotAlignmentOffset }) : 0;
+        offset = input.Pick(Offsets) + padding + depot;
+    }
+    else
+    {
+        offset = input.Pick({ 0.0, .5, 1.0 });
+    }
+
+    offset = Nudge(input, offset);
+    return input.Choose(4) == 0 ? -offset : offset;
+}
+
+static uint8_t MakeOwnerFlags(FuzzInput& input, ConnectorKind kind)
+{
+    switch (kind)
+    {
+    case ConnectorKind::Belt:
+        // Pairs that aren't on conveyors never link, so most are
+        return input.Pick({
+            (uint8_t)OwnerFlags::ConveyorBelt,
+            (uint8_t)OwnerFlags::ConveyorBelt,
+            (uint8_t)OwnerFlags::ConveyorLift,
+            (uint8_t)OwnerFlags::ConveyorLift,
+            (uint8_t)OwnerFlags::ConveyorAttachment,
+            (uint8_t)OwnerFlags::Storage,
+            (uint8_t)OwnerFlags::CentralStorage,
+            (uint8_t)OwnerFlags::None });
+    case ConnectorKind::Fluid:
+        return input.Choose(2) == 0 ? (uint8_t)OwnerFlags::PipelineJunction : (uint8_t)OwnerFlags::None;
+    case ConnectorKind::Railroad:
+        return input.Choose(4) == 0 ? (uint8_t)OwnerFlags::RailroadAttachment : (uint8_t)OwnerFlags::None;
+    default:
+        return OwnerFlags::None;
+    }
+}
+
+static Connector MakeConnector(FuzzInput& input, ConnectorKind kind, const Vector& location, const Vector& normal, uint32_t ownerId, ConnectorDirection direction)
+{
+    Connector connector{};
+    connector.Location = location;
+    connector.Normal = input.Choose(3) == 0 ? RoundToFloat(normal) : normal;
+    connector.Kind = kind;
+    connector.OwnerId = ownerId;
+    connector.OwnerFlags = MakeOwnerFlags(input, kind);
+    connector.Direction = input.Choose(16) == 0 ? ConnectorDirection::Any : direction;
+    connector.MaxConnections = kind == ConnectorKind::Railroad ? (uint8_t)(1 + input.Choose(Tolerances::MaxConnectionsPerRailConnector)) : 1;
+    connector.NumConnections = input.Choose(16) == 0 ? connector.MaxConnections : 0;
+    return connector;
+}
+
+// A few connectors of mostly the same kind, each placed against one that came before it. The first sits on a grid cell
+// corner so the rest spill over into the neighbouring cells.
+static void MakeConnectors(FuzzInput& input, std::vector<Connector>& outConnectors)
+{
+    const uint32_t numConnectors = 2 + input.Choose(7);
+    const ConnectorKind kind = (ConnectorKind)input.Choose((uint32_t)ConnectorKind::Num);
+
+    const Vector corner =
+    {
+        Nudge(input, (double)((int)input.Choose(5) - 2) * MatchCellSize),
+        Nudge(input, (double)((int)input.Choose(5) - 2) * MatchCellSize),
+        Nudge(input, (double)((int)input.Choose(5) - 2) * MatchCellSize)
+    };
+    const ConnectorDirection direction = input.Choose(2) == 0 ? ConnectorDirection::Input : ConnectorDirection::Output;
+    outConnectors.push_back(MakeConnector(input, kind, corner, MakeNormal(input), 1, direction));
+
+    for (uint32_t index = 1; index < numConnectors; ++index)
+    {
+        const Connector& anchor = outConnectors[input.Choose(index)];
+        const Vector side = GetPerpendicular(anchor.Normal);
+        const Vector up = Vector::CrossProduct(anchor.Normal, side);
+
+        // Somewhere out along the anchor's normal, usually right on its axis but sometimes a touching distance to the side
+        const bool isOffAxis = input.Choose(3) == 0;
+        const Vector location = anchor.Location
+            + anchor.Normal * MakeOffset(input, anchor.Kind)
+            + side * (isOffAxis ? Nudge(input, input.Pick({ 0.0, .5, 1.0, -1.0, 1.5 })) : 0)
+            + up * (isOffAxis ? Nudge(input, input.Pick({ 0.0, .5, 1.0, -1.0 })) : 0);
+
+        // Usually facing the anchor, turned just about as far as the rules allow in some direction
+        const Vector facing = input.Choose(4) == 0 ? anchor.Normal : -anchor.Normal;
+        const Vector towards = Tilt(side, up, input.Signed() * 3.14159265358979);
+        const Vector normal = Tilt(facing, towards, MakeTiltAngle(input, anchor.Kind));
+
+        // Mostly the complement of the anchor, so most pairs get past the gates to the geometry
+        const ConnectorKind connectorKind = input.Choose(16) == 0 ? (ConnectorKind)input.Choose((uint32_t)ConnectorKind::Num) : kind;
+        const uint32_t ownerId = input.Choose(16) == 0 ? anchor.OwnerId : index + 1;
+        const ConnectorDirection connectorDirection = (anchor.Direction == ConnectorDirection::Input) == (input.Choose(8) > 0) ? ConnectorDirection::Output : ConnectorDirection::Input;
+        outConnectors.push_back(MakeConnector(input, connectorKind, location, normal, ownerId, connectorDirection));
+    }
+}
+
+static void PrintConnectors(const std::vector<Connector>& connectors)
+{
+    for (size_t index = 0; index < connectors.size(); ++index)
+    {
+        const Connector& connector = connectors[index];
+        std::fprintf(stderr, "  %zu: Kind=%d Direction=%d OwnerId=%u OwnerFlags=0x%02x Connections=%d/%d Location=(%.17g, %.17g, %.17g) Normal=(%.17g, %.17g, %.17g)\n",
+            index,
+            (int)connector.Kind,
+            (int)connector.Direction,
+            connector.OwnerId,
+            connector.OwnerFlags,
+            connector.NumConnections,
+            connector.MaxConnections,
+            connector.Location.X, connector.Location.Y, connector.Location.Z,
+            connector.Normal.X, connector.Normal.Y, connector.Normal.Z);
+    }
+}
+
+static void PrintDecisions(const char* name, const std::vector<LinkDecision>& decisions)
+{
+    std::fprintf(stderr, "  %s:", name);
+    for (auto& decision : decisions)
+    {
+        std::fprintf(stderr, " %u->%u (%.17g)", decision.Connector, decision.Candidate, decision.Distance);
+    }
+
+    std::fprintf(stderr, "%s\n", decisions.empty() ? " no links" : "");
+}
+
+// The only link the rules allow the first connector of a lone pair to make with the second, or false for none. This is the
+// matcher's contract written out the long way: the per-pair gates it applies and then the Evaluate*Candidate rule.
+static bool CanLinkPair(const Connector& connector, const Connector& candidate, const char*& outRule)
+{
+    outRule = "Gated";
+    if (connector.Kind >= ConnectorKind::Num
+        || candidate.Kind != connector.Kind
+        || candidate.OwnerId == connector.OwnerId
+        || !connector.IsOpen()
+        || !candidate.IsOpen())
+    {
+        return false;
+    }
+
+    switch (connector.Kind)
+    {
+    case ConnectorKind::Belt:
+    {
+        if (!AreBeltDirectionsCompatible(connector.Direction, candidate.Direction) || !IsBeltPairAllowed(connector, candidate))
+        {
+            return false;
+        }
+
+        double distance;
+        const BeltCandidateResult result = EvaluateBeltCandidate(connector, candidate, distance);
+        outRule = ToString(result);
+        return result == BeltCandidateResult::Compatible;
+    }
+    case ConnectorKind::Fluid:
+    case ConnectorKind::Hyper:
+    {
+        if (connector.Kind == ConnectorKind::Fluid
+            && (connector.OwnerFlags & OwnerFlags::PipelineJunction)
+            && (candidate.OwnerFlags & OwnerFlags::PipelineJunction))
+        {
+            return false;
+        }
+
+        const PipeCandidateResult result = EvaluatePipeCandidate(connector, candidate);
+        outRule = ToString(result);
+        return result == PipeCandidateResult::Compatible;
+    }
+    case ConnectorKind::Railroad:
+    {
+        if ((candidate.OwnerFlags & OwnerFlags::RailroadAttachment) && candidate.NumConnections > 0)
+        {
+            return false;
+        }
+
+        const RailCandidateResult result = EvaluateRailCandidate(connector, candidate);
+        outRule = ToString(result);
+        return result == RailCandidateResult::Compatible;
+    }
+    default:
+        return false;
+    }
+}
+
+static void CheckPair(const std::vector<Connector>& connectors)
+{
+    std::vector<Connector> pair = { connectors[0], connectors[1] };
+
+    // The first connector goes first; the second only gets a turn if the first didn't link them
+    const char* firstRule;
+    const char* secondRule = "Skipped";
+    bool expectLink = CanLinkPair(pair[0], pair[1], firstRule);
+    LinkDecision expected{ 0, 1, 0 };
+    if (!expectLink && CanLinkPair(pair[1], pair[0], secondRule))
+    {
+        expectLink = true;
+        expected = { 1, 0, 0 };
+    }
+
+    std::vector<LinkDecision> decisions;
+    FindLinks(pair, MatchStrategy::BruteForce, decisions);
+
+    const bool linked = decisions.size() == 1;
+    const bool matches = expectLink
+        ? linked && decisions[0].Connector == expected.Connector && decisions[0].Candidate == expected.Candidate
+        : decisions.empty();
+    if (!matches)
+    {
+        std::fprintf(stderr, "MISMATCH: The rules say 0->1 is %s and 1->0 is %s, so expected %s\n", firstRule, secondRule, expectLink ? (expected.Connector == 0 ? "0->1" : "1->0") : "no links");
+        PrintConnectors(pair);
+        PrintDecisions(ToString(MatchStrategy::BruteForce), decisions);
+        std::abort();
+    }
+}
+
+static void CheckStrategies(const std::vector<Connector>& connectors)
+{
+    std::vector<LinkDecision> reference;
+    FindLinks(connectors, MatchStrategy::BruteForce, reference);
+
+    for (int strategy = 0; strategy < (int)MatchStrategy::Num; ++strategy)
+    {
+        if ((MatchStrategy)strategy == MatchStrategy::BruteForce)
+        {
+            continue;
+        }
+
+        std::vector<LinkDecision> decisions;
+        FindLinks(connectors, (MatchStrategy)strategy, decisions);
+        if (decisions != reference)
+        {
+            std::fprintf(stderr, "MISMATCH: %s disagrees with %s\n", ToString((MatchStrategy)strategy), ToString(MatchStrategy::BruteForce));
+            PrintConnectors(connectors);
+            PrintDecisions(ToString(MatchStrategy::BruteForce), reference);
+            PrintDecisions(ToString((MatchStrategy)strategy), decisions);
+            std::abort();
+        }
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    FuzzInput input{ data, size };
+    std::vector<Connector> connectors;
+    MakeConnectors(input, connectors);
+
+    CheckPair(connectors);
+    CheckStrategies(connectors);
+    return 0;
+}
+
+#ifndef AUTOLINK_LIBFUZZER
+
+static bool ReadFile(const char* path, std::vector<uint8_t>& outBytes)
+{
+    FILE* file = std::fopen(path, "rb");
+    if (!file)
+    {
+        return false;
+    }
+
+    uint8_t buffer[4096];
+    size_t numRead;
+    while ((numRead = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        outBytes.insert(outBytes.end(), buffer, buffer + numRead);
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+// Same splitmix64 as the stress layouts, so a seed always gives the same inputs
+static uint64_t NextRandom(uint64_t& state)
+{
+    uint64_t value = (state += 0x9E3779B97F4A7C15ull);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t numRuns = 1000000;
+    uint64_t seed = 1;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+        {
+            numRuns = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argv[i][0] != '-')
+        {
+            paths.push_back(argv[i]);
+        }
+        else
+        {
+            std::printf("Usage: %s [--runs N] [--seed N] [Input...]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // Replaying crash files (or a corpus) found by a libFuzzer build
+    if (!paths.empty())
+    {
+        for (auto path : paths)
+        {
+            std::vector<uint8_t> bytes;
+            if (!ReadFile(path, bytes))
+            {
+                std::printf("ERROR: Could not read %s\n", path);
+                return 2;
+            }
+
+            LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+        }
+
+        std::printf("%zu inputs passed\n", paths.size());
+        return 0;
+    }
+
+    uint64_t state = seed;
+    uint8_t bytes[256];
+    for (uint64_t run = 0; run < numRuns; ++run)
+    {
+        for (size_t i = 0; i < sizeof(bytes); i += sizeof(uint64_t))
+        {
+            const uint64_t value = NextRandom(state);
+            std::memcpy(bytes + i, &value, sizeof(value));
+        }
+
+        LLVMFuzzerTestOneInput(bytes, sizeof(bytes));
+    }
+
+    std::printf("%llu random inputs passed (seed %llu)\n", (unsigned long long)numRuns, (unsigned long long)seed);
+    return 0;
+}
+
+#endif
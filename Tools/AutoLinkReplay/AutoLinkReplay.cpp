@@ -0,0 +1,420 @@
+// Runs the AutoLink matching rules offline over files captured in game. It takes either of:
+//
+// - A connector snapshot from AutoLink.ExportConnectors. The snapshot is memory-mapped and matched in place, so even megabase
+//   snapshots load instantly and can be profiled with perf. It reports what AutoLink would link if every open connector in the
+//   save were placed right now, how long each matching strategy takes on it and whether the strategies agree.
+//
+// - A hook recording from AutoLink.Record. Every recorded buildable is linked again against the candidates its scene queries
+//   found in game, in the same order. It reports every decision that differs from what the game did and compares the time
+//   the game took with the time the matcher takes now.
+//
+// Usage: AutoLinkReplay <file> [--strategy BruteForce|SpatialGrid|all] [--iterations N] [--classes N] [--mismatches N]
+
+#include "AutoLinkCore/AutoLinkGeometry.h"
+#include "AutoLinkCore/AutoLinkMatcher.h"
+#include "AutoLinkCore/AutoLinkRecording.h"
+#include "AutoLinkCore/AutoLinkSnapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace AutoLinkCore;
+
+struct ReplayOptions
+{
+    const char* SnapshotPath = nullptr; // Or recording
+    std::vector<MatchStrategy> Strategies = { MatchStrategy::SpatialGrid };
+    int Iterations = 3;
+    int NumClassesToShow = 10;
+    int NumMismatchesToShow = 10;
+};
+
+// Read-only mapping of a whole file, unmapped on destruction
+class MappedFile
+{
+public:
+    ~MappedFile()
+    {
+        if (Data)
+        {
+            munmap(Data, Size);
+        }
+    }
+
+    bool Open(const char* path)
+    {
+        const int fd = open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        Size = (size_t)fileStat.st_size;
+        void* data = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+
+        Data = data;
+        return true;
+    }
+
+    const void* GetData() const { return Data; }
+    size_t GetSize() const { return Size; }
+
+private:
+    void* Data = nullptr;
+    size_t Size = 0;
+};
+
+static const char* GetKindName(ConnectorKind kind)
+{
+    switch (kind)
+    {
+    case ConnectorKind::Belt: return "Belt";
+    case ConnectorKind::Railroad: return "Railroad";
+    case ConnectorKind::Fluid: return "Fluid";
+    case ConnectorKind::Hyper: return "Hyper";
+    default: return "Unknown";
+    }
+}
+
+static bool ParseStrategy(const char* name, std::vector<MatchStrategy>& outStrategies)
+{
+    outStrategies.clear();
+    for (int strategy = 0; strategy < (int)MatchStrategy::Num; ++strategy)
+    {
+        if (std::strcmp(name, "all") == 0 || std::strcmp(name, ToString((MatchStrategy)strategy)) == 0)
+        {
+            outStrategies.push_back((MatchStrategy)strategy);
+        }
+    }
+
+    return !outStrategies.empty();
+}
+
+static bool ParseOptions(int argc, char** argv, ReplayOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--strategy") == 0 && i + 1 < argc)
+        {
+            if (!ParseStrategy(argv[++i], options.Strategies))
+            {
+                return false;
+            }
+        }
+        else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+        {
+            options.Iterations = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--classes") == 0 && i + 1 < argc)
+        {
+            options.NumClassesToShow = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--mismatches") == 0 && i + 1 < argc)
+        {
+            options.NumMismatchesToShow = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (argv[i][0] != '-' && !options.SnapshotPath)
+        {
+            options.SnapshotPath = argv[i];
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return options.SnapshotPath != nullptr;
+}
+
+static void PrintSummary(const SnapshotView& snapshot)
+{
+    size_t numConnectors[(int)ConnectorKind::Num] = {};
+    size_t numOpen[(int)ConnectorKind::Num] = {};
+    for (size_t i = 0; i < snapshot.NumConnectors; ++i)
+    {
+        const Connector& connector = snapshot.Connectors[i];
+        if (connector.Kind < ConnectorKind::Num)
+        {
+            ++numConnectors[(int)connector.Kind];
+            numOpen[(int)connector.Kind] += connector.IsOpen() ? 1 : 0;
+        }
+    }
+
+    std::printf("%zu connectors, %zu classes\n", snapshot.NumConnectors, snapshot.ClassNames.size());
+    for (int kind = 0; kind < (int)ConnectorKind::Num; ++kind)
+    {
+        std::printf("    %-10s %10zu connectors %10zu open\n", GetKindName((ConnectorKind)kind), numConnectors[kind], numOpen[kind]);
+    }
+}
+
+// Shows which classes own the connectors that would be linked, which is usually the first question about a surprising result
+static void PrintLinksByClass(const SnapshotView& snapshot, const std::vector<LinkDecision>& decisions, int numClassesToShow)
+{
+    if (numClassesToShow == 0 || decisions.empty())
+    {
+        return;
+    }
+
+    std::map<std::pair<uint32_t, uint32_t>, size_t> linksByClassPair;
+    for (const auto& decision : decisions)
+    {
+        auto first = snapshot.Connectors[decision.Connector].ClassId;
+        auto second = snapshot.Connectors[decision.Candidate].ClassId;
+        ++linksByClassPair[{ std::min(first, second), std::max(first, second) }];
+    }
+
+    std::vector<std::pair<size_t, std::pair<uint32_t, uint32_t>>> sorted;
+    for (const auto& entry : linksByClassPair)
+    {
+        sorted.push_back({ entry.second, entry.first });
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::printf("Links by class pair:\n");
+    for (size_t i = 0; i < sorted.size() && i < (size_t)numClassesToShow; ++i)
+    {
+        std::printf("    %8zu  %s <-> %s\n", sorted[i].first, snapshot.LookupClassName(sorted[i].second.first), snapshot.LookupClassName(sorted[i].second.second));
+    }
+}
+
+static int ReplaySnapshot(const ReplayOptions& options, const void* data, size_t size)
+{
+    SnapshotView snapshot;
+    const char* error = nullptr;
+    if (!ReadSnapshot(data, size, snapshot, &error))
+    {
+        std::printf("ERROR: %s: %s\n", options.SnapshotPath, error);
+        return 2;
+    }
+
+    PrintSummary(snapshot);
+
+    std::printf("%-12s %10s %14s %12s\n", "Strategy", "Links", "Candidates", "Ms/iter");
+
+    bool allMatched = true;
+    std::vector<LinkDecision> reference;
+    for (size_t i = 0; i < options.Strategies.size(); ++i)
+    {
+        const MatchStrategy strategy = options.Strategies[i];
+        std::vector<LinkDecision> decisions;
+        MatchStats stats;
+        auto start = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < options.Iterations; ++iteration)
+        {
+            decisions.clear();
+            stats = MatchStats();
+            FindLinks(snapshot.Connectors, snapshot.NumConnectors, strategy, decisions, &stats);
+        }
+
+        const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-12s %10zu %14llu %12.3f\n",
+            ToString(strategy),
+            decisions.size(),
+            (unsigned long long)stats.CandidatesEvaluated,
+            elapsedMs / options.Iterations);
+
+        if (i == 0)
+        {
+            reference = std::move(decisions);
+        }
+        else if (decisions != reference)
+        {
+            std::printf("ERROR: %s made %zu decisions that differ from the %zu %s made!\n",
+                ToString(strategy), decisions.size(), reference.size(), ToString(options.Strategies[0]));
+            allMatched = false;
+        }
+    }
+
+    PrintLinksByClass(snapshot, reference, options.NumClassesToShow);
+    return allMatched ? 0 : 1;
+}
+
+// Links as unordered pairs of connector indexes, sorted, so the game's and the matcher's links can be compared directly
+static std::vector<std::pair<uint32_t, uint32_t>> NormalizeLinks(const std::vector<std::pair<uint32_t, uint32_t>>& links)
+{
+    std::vector<std::pair<uint32_t, uint32_t>> normalized;
+    normalized.reserve(links.size());
+    for (const auto& link : links)
+    {
+        normalized.push_back({ std::min(link.first, link.second), std::max(link.first, link.second) });
+    }
+
+    std::sort(normalized.begin(), normalized.end());
+    return normalized;
+}
+
+static void PrintLinks(const char* label, const Recording& recording, const RecordedBuildable& buildable, const std::vector<std::pair<uint32_t, uint32_t>>& links)
+{
+    std::printf("        %s:", label);
+    if (links.empty())
+    {
+        std::printf(" none");
+    }
+
+    for (const auto& link : links)
+    {
+        const Connector& first = buildable.Connectors[link.first];
+        const Connector& second = buildable.Connectors[link.second];
+        std::printf(" [%s %s #%u (%.1f, %.1f, %.1f) <-> %s #%u (%.1f, %.1f, %.1f)]",
+            GetKindName(first.Kind),
+            recording.LookupClassName(first.ClassId),
+            link.first,
+            first.Location.X, first.Location.Y, first.Location.Z,
+            recording.LookupClassName(second.ClassId),
+            link.second,
+            second.Location.X, second.Location.Y, second.Location.Z);
+    }
+
+    std::printf("\n");
+}
+
+struct ReplaySourceTotals
+{
+    size_t NumPasses = 0;
+    size_t NumBuildables = 0;
+    uint64_t RecordedNs = 0;
+    double ReplayedNs = 0;
+};
+
+static int ReplayRecording(const ReplayOptions& options, const void* data, size_t size)
+{
+    Recording recording;
+    const char* error = nullptr;
+    if (!ReadRecording(data, size, recording, &error))
+    {
+        std::printf("ERROR: %s: %s\n", options.SnapshotPath, error);
+        return 2;
+    }
+
+    const MatchStrategy strategy = options.Strategies.front();
+    std::map<std::string, ReplaySourceTotals> totalsBySource;
+    size_t numBuildables = 0;
+    size_t numMismatches = 0;
+    std::vector<LinkDecision> decisions;
+    for (size_t passIndex = 0; passIndex < recording.Passes.size(); ++passIndex)
+    {
+        const RecordedPass& pass = recording.Passes[passIndex];
+        auto& totals = totalsBySource[pass.Source];
+        ++totals.NumPasses;
+
+        for (size_t buildableIndex = 0; buildableIndex < pass.Buildables.size(); ++buildableIndex)
+        {
+            const RecordedBuildable& buildable = pass.Buildables[buildableIndex];
+            auto start = std::chrono::steady_clock::now();
+            for (int iteration = 0; iteration < options.Iterations; ++iteration)
+            {
+                decisions.clear();
+                FindLinksFor(buildable.Connectors.data(), buildable.Connectors.size(), buildable.NumOwnConnectors, strategy, decisions);
+            }
+
+            totals.ReplayedNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / options.Iterations;
+            totals.RecordedNs += buildable.DurationNs;
+            ++totals.NumBuildables;
+            ++numBuildables;
+
+            std::vector<std::pair<uint32_t, uint32_t>> recordedLinks;
+            for (const auto& link : buildable.Links)
+            {
+                recordedLinks.push_back({ link.Connector, link.Candidate });
+            }
+
+            std::vector<std::pair<uint32_t, uint32_t>> replayedLinks;
+            for (const auto& decision : decisions)
+            {
+                replayedLinks.push_back({ decision.Connector, decision.Candidate });
+            }
+
+            recordedLinks = NormalizeLinks(recordedLinks);
+            replayedLinks = NormalizeLinks(replayedLinks);
+            if (recordedLinks == replayedLinks)
+            {
+                continue;
+            }
+
+            if (numMismatches++ < (size_t)options.NumMismatchesToShow)
+            {
+                std::printf("MISMATCH: pass %zu (%s), buildable %zu (%s), %u own connectors, %zu candidates\n",
+                    passIndex,
+                    pass.Source.c_str(),
+                    buildableIndex,
+                    recording.LookupClassName(buildable.ClassId),
+                    buildable.NumOwnConnectors,
+                    buildable.Connectors.size() - buildable.NumOwnConnectors);
+                PrintLinks("Game", recording, buildable, recordedLinks);
+                PrintLinks("Replay", recording, buildable, replayedLinks);
+            }
+        }
+    }
+
+    std::printf("%zu passes, %zu buildables, %zu classes. Replayed with %s.\n", recording.Passes.size(), numBuildables, recording.ClassNames.size(), ToString(strategy));
+    std::printf("%-40s %8s %10s %14s %14s %10s\n", "Source", "Passes", "Buildables", "Game ms", "Replay ms", "Speedup");
+    for (const auto& entry : totalsBySource)
+    {
+        const auto& totals = entry.second;
+        std::printf("%-40s %8zu %10zu %14.3f %14.3f %9.1fx\n",
+            entry.first.c_str(),
+            totals.NumPasses,
+            totals.NumBuildables,
+            (double)totals.RecordedNs / 1e6,
+            (double)totals.ReplayedNs / 1e6,
+            totals.ReplayedNs > 0 ? (double)totals.RecordedNs / (double)totals.ReplayedNs : 0.0);
+    }
+
+    if (numMismatches > 0)
+    {
+        std::printf("ERROR: %zu of %zu buildables were linked differently than in game!\n", numMismatches, numBuildables);
+        return 1;
+    }
+
+    std::printf("Every decision matched the game.\n");
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    ReplayOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::printf("Usage: %s <snapshot.alsnap|recording.alrec> [--strategy BruteForce|SpatialGrid|all] [--iterations N] [--classes N] [--mismatches N]\n", argv[0]);
+        return 2;
+    }
+
+    MappedFile file;
+    if (!file.Open(options.SnapshotPath))
+    {
+        std::printf("ERROR: Could not map %s\n", options.SnapshotPath);
+        return 2;
+    }
+
+    if (file.GetSize() >= sizeof(RecordingMagic) && std::memcmp(file.GetData(), RecordingMagic, sizeof(RecordingMagic)) == 0)
+    {
+        return ReplayRecording(options, file.GetData(), file.GetSize());
+    }
+
+    return ReplaySnapshot(options, file.GetData(), file.GetSize());
+}
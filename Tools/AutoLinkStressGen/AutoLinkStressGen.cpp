@@ -0,0 +1,134 @@
+// Writes the procedural stress layouts (see AutoLinkCore/AutoLinkStressLayout.h) out as connector snapshots, so every
+// optimization can be measured with AutoLinkReplay against exactly the same inputs. Each layout is also matched once before it
+// is written, and the tool fails if that doesn't make the links the layout was designed to have.
+//
+// The same layouts can be spawned in game with AutoLink.RunStress.
+//
+// Usage: AutoLinkStressGen <BeltManifold|LiftStacks|PipeManifold|HyperSpaghetti|RailYard|all> [--size N] [--seed N] [--out Directory]
+
+#include "AutoLinkCore/AutoLinkMatcher.h"
+#include "AutoLinkCore/AutoLinkSnapshot.h"
+#include "AutoLinkCore/AutoLinkStressLayout.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace AutoLinkCore;
+
+struct StressGenOptions
+{
+    std::vector<StressLayoutType> Types;
+    uint32_t Size = 0; // 0 is each layout's default size
+    uint64_t Seed = 1;
+    std::string OutDirectory = ".";
+};
+
+static bool ParseOptions(int argc, char** argv, StressGenOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            options.Size = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            options.Seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            options.OutDirectory = argv[++i];
+        }
+        else if (argv[i][0] != '-' && options.Types.empty())
+        {
+            StressLayoutType type;
+            if (std::strcmp(argv[i], "all") == 0)
+            {
+                for (int t = 0; t < (int)StressLayoutType::Num; ++t)
+                {
+                    options.Types.push_back((StressLayoutType)t);
+                }
+            }
+            else if (ParseStressLayoutType(argv[i], type))
+            {
+                options.Types.push_back(type);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return !options.Types.empty();
+}
+
+static bool WriteFile(const std::string& path, const std::vector<uint8_t>& bytes)
+{
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+
+    const bool wroteAll = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return std::fclose(file) == 0 && wroteAll;
+}
+
+int main(int argc, char** argv)
+{
+    StressGenOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::printf("Usage: %s <BeltManifold|LiftStacks|PipeManifold|HyperSpaghetti|RailYard|all> [--size N] [--seed N] [--out Directory]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<std::string> classNames;
+    for (int type = 0; type < (int)StressPieceType::Num; ++type)
+    {
+        classNames.push_back(ToString((StressPieceType)type));
+    }
+
+    std::printf("%-16s %8s %10s %12s %10s %10s  %s\n", "Layout", "Size", "Pieces", "Connectors", "Expected", "Links", "File");
+
+    bool allMatched = true;
+    const StressGeometry geometry;
+    for (auto type : options.Types)
+    {
+        const uint32_t size = options.Size > 0 ? options.Size : GetDefaultStressSize(type);
+        StressLayout layout;
+        GenerateStressLayout(type, size, options.Seed, geometry, layout);
+
+        std::vector<Connector> connectors;
+        AppendStressConnectors(layout, geometry, connectors);
+
+        std::vector<LinkDecision> decisions;
+        FindLinks(connectors, MatchStrategy::SpatialGrid, decisions);
+
+        const std::string path = options.OutDirectory + "/" + ToString(type) + "_" + std::to_string(size) + "_" + std::to_string(options.Seed) + ".alsnap";
+        std::vector<uint8_t> bytes;
+        WriteSnapshot(connectors.data(), connectors.size(), classNames, bytes);
+        if (!WriteFile(path, bytes))
+        {
+            std::printf("ERROR: Could not write %s\n", path.c_str());
+            return 2;
+        }
+
+        std::printf("%-16s %8u %10zu %12zu %10u %10zu  %s\n", ToString(type), size, layout.Pieces.size(), connectors.size(), layout.ExpectedLinks, decisions.size(), path.c_str());
+        if (decisions.size() != layout.ExpectedLinks)
+        {
+            std::printf("ERROR: %s made %zu links but was designed to make %u!\n", ToString(type), decisions.size(), layout.ExpectedLinks);
+            allMatched = false;
+        }
+    }
+
+    return allMatched ? 0 : 1;
+}